@@ -0,0 +1,24 @@
+# @author Alex Smith (SmithAlexLee30@gmail.com)
+# @date 10/21/22
+#
+# Usage: gnuplot -c ./HR_raster.p [# of Neurons] [raster file (default Out/raster)]
+
+# Verify the number of command-line arguments.
+if (ARGC == 1 || ARGC == 2) {
+    raster = (ARGC == 2) ? ARG2 : "Out/raster"
+
+    # Image setup.
+    unset key
+    set title "Hindmarsh-Rose (HR) Neuronal Model"
+    set xlabel "Spike Time"
+    set ylabel "Neuron ID"
+    set yrange [-0.5:ARG1-0.5]
+    set terminal png size 1000,500
+    set output sprintf("Plot/HR_raster(N=%s).png", ARG1)
+
+    # Plot the spike timings of every neuron, exported from the raster.
+    plot sprintf("< ./Bin/raster -o - %s", raster) using 1:2 \
+        with points pointsize 2
+} else {
+    print sprintf("\n\tUsage: gnuplot -c %s [# of Neurons] [raster file (default Out/raster)]\n", ARG0)
+}
@@ -0,0 +1,322 @@
+/**
+ * @file analysis_driver.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Driver for re-running the spike analysis over stored trajectories.
+ * @version 0.1
+ * @date 2022-10-07
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "analysis_driver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define SPIKE_THRESHOLD 0.0
+
+int main(int argc, char *argv[]) {
+    myArgs args = getArgs(argc, argv);
+
+    // Find the stored trajectories.
+    int count;
+    Trajectory *trajectories = findTrajectories(args.directory, &count);
+    if (count == 0) {
+        fprintf(stderr, "No stored trajectories (approx<neuron>) in %s, exiting ...\n", args.directory);
+        exit(EXIT_FAILURE);
+    }
+
+    // Analyze the trajectories across the workers.
+    int workerCount = args.workerCount < count ? args.workerCount : count;
+    pthread_t threads[workerCount];
+    Worker workers[workerCount];
+    double start = getTime();
+    for (int w = 0; w < workerCount; ++w) {
+        workers[w] = (Worker) {
+            .trajectories = trajectories,
+            .trajectoryCount = count,
+            .args = &args,
+            .id = w
+        };
+        if (pthread_create(&threads[w], NULL, analyzeTrajectories, &workers[w]) != 0) {
+            perror("pthread_create() failure");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double readSeconds = 0.0, scanSeconds = 0.0;
+    for (int w = 0; w < workerCount; ++w) {
+        pthread_join(threads[w], NULL);
+        readSeconds += workers[w].readSeconds;
+        scanSeconds += workers[w].scanSeconds;
+    }
+    double elapsed = getTime() - start;
+
+    // Write the average frequencies.
+    char filename[strlen(args.outDir) + 32];
+    sprintf(filename, "%s/avg_freqs", args.outDir);
+    writeFrequencies(filename, trajectories, count);
+
+    // Print results.
+    long spikeCount = 0;
+    for (int i = 0; i < count; ++i) {
+        spikeCount += trajectories[i].spikes.size;
+        freePoints(&trajectories[i].spikes);
+    }
+    printf("Spike analysis of %d stored neurons:\n", count);
+    printf("\t%ld spikes at threshold %g (%s rule)\n", spikeCount, args.threshold, args.rule == SPIKE_PEAK ? "peak" : "crossing");
+    printf("\t%f seconds elapsed on %d workers\n", elapsed, workerCount);
+    printf("\t%f seconds reading and %f seconds scanning (summed over workers)\n", readSeconds, scanSeconds);
+
+    free(trajectories);
+    exit(EXIT_SUCCESS);
+}
+
+myArgs getArgs(int argc, char *argv[]) {
+    myArgs args = {
+        .directory = "Out",
+        .outDir = NULL,
+        .threshold = SPIKE_THRESHOLD,
+        .rule = SPIKE_PEAK,
+        .transient = 0.0,
+        .workerCount = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1
+    };
+
+    // Get the options.
+    int opt;
+    while ((opt = getopt(argc, argv, "t:r:T:o:j:")) != -1) {
+        switch (opt) {
+            case 't':
+                args.threshold = strtod(optarg, NULL);
+                break;
+            case 'r':
+                if (strcmp(optarg, "peak") == 0) {
+                    args.rule = SPIKE_PEAK;
+                }
+                else if (strcmp(optarg, "crossing") == 0) {
+                    args.rule = SPIKE_CROSSING;
+                }
+                else {
+                    usage(argv[0]);
+                }
+                break;
+            case 'T':
+                if ((args.transient = strtod(optarg, NULL)) < 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'o':
+                args.outDir = optarg;
+                break;
+            case 'j':
+                if ((args.workerCount = strtol(optarg, NULL, 10)) < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    // Get the directory (the analysis replaces the stored one unless another is given).
+    if (argc - optind > 1) {
+        usage(argv[0]);
+    }
+    if (argc - optind == 1) {
+        args.directory = argv[optind];
+    }
+    if (args.outDir == NULL) {
+        args.outDir = args.directory;
+    }
+    if (access(args.outDir, W_OK) != 0) {
+        perror("Output Directory");
+        exit(EXIT_FAILURE);
+    }
+
+    return args;
+}
+
+/**
+ * @brief Compares two trajectories for qsort() by neuron.
+ *
+ * @param a the first trajectory.
+ * @param b the second trajectory.
+ * @return int - negative, zero, or positive as a is before, the same as, or after b.
+ */
+static int compareTrajectories(const void *a, const void *b) {
+    return ((const Trajectory *) a)->neuron - ((const Trajectory *) b)->neuron;
+}
+
+Trajectory *findTrajectories(char *directory, int *count) {
+    DIR *dir;
+    if ((dir = opendir(directory)) == NULL) {
+        perror("Open Trajectory Directory");
+        exit(EXIT_FAILURE);
+    }
+
+    // Collect every approx<neuron> file (approx<neuron>_<function> holds y or z).
+    Trajectory *trajectories = NULL;
+    int capacity = 0;
+    *count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int neuron, length;
+        if (sscanf(entry->d_name, "approx%d%n", &neuron, &length) != 1 || entry->d_name[length] != '\0' || neuron < 0) {
+            continue;
+        }
+        if (*count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            if ((trajectories = (Trajectory *) realloc(trajectories, capacity * sizeof(Trajectory))) == NULL) {
+                perror("realloc() failure");
+                exit(EXIT_FAILURE);
+            }
+        }
+        trajectories[(*count)++] = (Trajectory) {.neuron = neuron};
+    }
+    closedir(dir);
+
+    qsort(trajectories, *count, sizeof(Trajectory), compareTrajectories);
+    return trajectories;
+}
+
+int readTrajectory(char *filename, float **x, float **y) {
+    // Map the file.
+    int fd;
+    struct stat info;
+    if ((fd = open(filename, O_RDONLY)) < 0 || fstat(fd, &info) != 0) {
+        perror("Read Trajectory");
+        exit(EXIT_FAILURE);
+    }
+    size_t length = info.st_size;
+    char *text = length ? mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    if (length && text == MAP_FAILED) {
+        perror("mmap() failure");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+
+    // Every line ends with a newline, which also keeps strtof() inside the mapping.
+    if (length && text[length - 1] != '\n') {
+        fprintf(stderr, "%s is not a stored trajectory, exiting ...\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    // Count the lines, then read the x and y value of each.
+    int size = 0;
+    for (char *newline = text; length && (newline = memchr(newline, '\n', text + length - newline)) != NULL; ++newline) {
+        ++size;
+    }
+    if ((*x = (float *) malloc((size ? size : 1) * sizeof(float))) == NULL ||
+        (*y = (float *) malloc((size ? size : 1) * sizeof(float))) == NULL) {
+        perror("malloc() failure");
+        exit(EXIT_FAILURE);
+    }
+    char *cursor = text, *end;
+    for (int i = 0; i < size; ++i) {
+        (*x)[i] = strtof(cursor, &end);
+        (*y)[i] = strtof(end, &cursor);
+        if (cursor == end || *cursor != '\n') {
+            fprintf(stderr, "%s is not a stored trajectory, exiting ...\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        ++cursor;
+    }
+
+    if (length) {
+        munmap(text, length);
+    }
+    return size;
+}
+
+void *analyzeTrajectories(void *arg) {
+    Worker *worker = (Worker *) arg;
+    myArgs *args = worker->args;
+    char filename[(strlen(args->directory) > strlen(args->outDir) ? strlen(args->directory) : strlen(args->outDir)) + 32];
+
+    for (int i = worker->id; i < worker->trajectoryCount; i += args->workerCount) {
+        Trajectory *trajectory = &worker->trajectories[i];
+        float *x, *y;
+
+        // Read the trajectory.
+        double start = getTime();
+        sprintf(filename, "%s/approx%d", args->directory, trajectory->neuron);
+        trajectory->size = readTrajectory(filename, &x, &y);
+        worker->readSeconds += getTime() - start;
+
+        // Find the spikes after the transient, computing its index from the spacing of the points.
+        start = getTime();
+        float spacing = trajectory->size >= 2 ? x[1] - x[0] : 1.0;
+        int first = trajectory->size ? calcTransientIndex(x[0], spacing, x[0] + args->transient) : 0;
+        if ((trajectory->spikes = scanSpikes(x, y, trajectory->size, first, args->threshold, args->rule)).size < 0) {
+            perror("malloc() failure");
+            exit(EXIT_FAILURE);
+        }
+        trajectory->avgFreq = first < trajectory->size ? calcAvgFrequency(trajectory->spikes.size, 0, lroundf(x[trajectory->size - 1] - x[first]), 1000.0) : 0.0;
+        worker->scanSeconds += getTime() - start;
+
+        // Write the spikes and inter-spike intervals.
+        sprintf(filename, "%s/spikes%d", args->outDir, trajectory->neuron);
+        if (!writePoints(filename, &trajectory->spikes)) {
+            perror("Write Points");
+            exit(EXIT_FAILURE);
+        }
+        ISI isi = calcISI(&trajectory->spikes);
+        if (isi.size < 0) {
+            perror("malloc() failure");
+            exit(EXIT_FAILURE);
+        }
+        sprintf(filename, "%s/ISI%d", args->outDir, trajectory->neuron);
+        if (!writeISI(filename, &isi)) {
+            perror("Write Inter-Spike Intervals");
+            exit(EXIT_FAILURE);
+        }
+        freeISI(&isi);
+
+        free(x);
+        free(y);
+    }
+
+    return NULL;
+}
+
+void writeFrequencies(char *filename, Trajectory trajectories[], int count) {
+    // Open output file for writing.
+    FILE *outfile;
+    if ((outfile = fopen(filename, "w")) == NULL) {
+        perror("Write Average Frequencies");
+        exit(EXIT_FAILURE);
+    }
+
+    // Begin writing (neuron ID - avg freq).
+    for (int i = 0; i < count; ++i) {
+        fprintf(outfile, "%d\t%f\n", trajectories[i].neuron, trajectories[i].avgFreq);
+    }
+
+    // Close ouput file.
+    fclose(outfile);
+}
+
+void usage(const char *prog_name) {
+    fprintf(stderr, "\nUsage: %s [options] [directory of stored trajectories (default Out)]\n", prog_name);
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "\t-t [threshold]\tthe minimum value a spike must reach (default %g)\n", SPIKE_THRESHOLD);
+    fprintf(stderr, "\t-r [rule]\tthe spike rule: peak (default) or crossing\n");
+    fprintf(stderr, "\t-T [x]\t\thow far into the stored trajectories the analysis starts (default 0)\n");
+    fprintf(stderr, "\t-o [directory]\tthe directory the analysis is written into (default the stored directory)\n");
+    fprintf(stderr, "\t-j [threads]\tthe number of worker threads (default the number of cores)\n\n");
+    exit(EXIT_FAILURE);
+}
+
+double getTime(){
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + t.tv_usec/1000000.0;
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**
+ * @file analysis_driver.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that re-runs the spike, ISI, and frequency analysis over stored trajectories
+ * without re-running the simulation.
+ * @version 0.1
+ * @date 2022-10-07
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef ANALYSIS_DRIVER
+#define ANALYSIS_DRIVER
+
+#include "spike_calculations.h"
+
+#define MAX_PATH_CHARS 256  // The maximum amount of characters in a file path.
+
+/**
+ * @brief A structure to capture all necessary command-line arguments.
+ */
+typedef struct {
+    /**
+     * @brief The directory holding the stored trajectories (approx<neuron> files).
+     */
+    char *directory;
+
+    /**
+     * @brief The directory the analysis is written into.
+     */
+    char *outDir;
+
+    /**
+     * @brief The minimum value a spike must reach.
+     */
+    float threshold;
+
+    /**
+     * @brief The rule for deciding which points are spikes.
+     */
+    SpikeRule rule;
+
+    /**
+     * @brief How far into the stored trajectories (in x) the analysis starts.
+     */
+    float transient;
+
+    /**
+     * @brief The number of worker threads.
+     */
+    int workerCount;
+} myArgs;
+
+/**
+ * @brief A trajectory structure which holds the analysis of one stored neuron.
+ */
+typedef struct {
+    /**
+     * @brief The number of the neuron.
+     */
+    int neuron;
+
+    /**
+     * @brief The number of stored points.
+     */
+    int size;
+
+    /**
+     * @brief The spikes found.
+     */
+    Points spikes;
+
+    /**
+     * @brief The average frequency of the spikes.
+     */
+    float avgFreq;
+} Trajectory;
+
+/**
+ * @brief A worker structure which is passed to each worker thread.
+ */
+typedef struct {
+    /**
+     * @brief The trajectories being analyzed.
+     */
+    Trajectory *trajectories;
+    int trajectoryCount;
+
+    /**
+     * @brief The settings of the analysis.
+     */
+    myArgs *args;
+
+    /**
+     * @brief The number of the worker (it analyzes every workerCount-th trajectory from here).
+     */
+    int id;
+
+    /**
+     * @brief The seconds the worker spent reading and scanning its trajectories.
+     */
+    double readSeconds, scanSeconds;
+} Worker;
+
+/**
+ * @brief Re-runs the analysis over stored trajectories.
+ *
+ * @param argc the command-line argument count.
+ * @param argv the command-line argument values.
+ * @return int - the exit status of the analysis.
+ */
+int main(int argc, char *argv[]);
+
+/**
+ * @brief Get the command-line arguments.
+ *
+ * @param argc the number of arguments.
+ * @param argv the array of arguments.
+ * @return myArgs - the command line arguments in their correct data types.
+ */
+myArgs getArgs(int, char *[]);
+
+/**
+ * @brief Finds the stored trajectories of x (approx<neuron>) in a directory, ordered by neuron.
+ *
+ * @param directory the directory to search.
+ * @param count where to store the number of trajectories found.
+ * @return Trajectory* - the trajectories found (free with free()).
+ */
+Trajectory *findTrajectories(char *directory, int *count);
+
+/**
+ * @brief Maps a stored trajectory file and reads its x and y values.
+ *
+ * @param filename the name of the file to be read.
+ * @param x where to store the x values (free with free()).
+ * @param y where to store the y values (free with free()).
+ * @return int - the number of points read.
+ */
+int readTrajectory(char *filename, float **x, float **y);
+
+/**
+ * @brief The entry point of each worker thread. Reads, scans, and writes the analysis of its share of the trajectories.
+ *
+ * @param arg the Worker structure of the thread.
+ * @return void* - NULL.
+ */
+void *analyzeTrajectories(void *arg);
+
+/**
+ * @brief Writes the average frequency of each analyzed neuron to a file.
+ *
+ * @param filename the name of the file to write to.
+ * @param trajectories the analyzed trajectories.
+ * @param count the number of trajectories.
+ */
+void writeFrequencies(char *filename, Trajectory trajectories[], int count);
+
+/**
+ * @brief Prints a message to stderr explaining how to run the program.
+ *
+ * @param prog_name the name of the executable file.
+ */
+void usage(const char *);
+
+/**
+ * @brief Gets the current time in seconds.
+ *
+ * @return double - the current time in seconds.
+ */
+double getTime();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,347 @@
+/**
+ * @file autotune.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the autotune header file.
+ * @version 0.1
+ * @date 2022-10-17
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "autotune.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_PROBE_LENGTH 100.0  // The default x length of each probe run.
+#define DEFAULT_TIME_TOLERANCE 1.0  // The default largest x distance between matching spikes.
+#define DEFAULT_FREQ_TOLERANCE 0.05 // The default largest relative difference between average frequencies.
+#define REFERENCE_DIVISOR 4.0       // The reference runs at the given step divided by this.
+#define SMALLEST_FACTOR 0.5         // The smallest step tried, as a multiple of the given step.
+#define LARGEST_FACTOR 16.0         // The largest step tried, as a multiple of the given step.
+#define TIMING_REPEATS 2            // The number of times each probe is timed (the fastest counts).
+#define MAX_LINE_CHARS 256          // The maximum amount of characters in a line of a configuration file.
+
+/**
+ * @brief Gets the wall time of a monotonic clock.
+ *
+ * @return double - the time in seconds.
+ */
+static double getMonotonicTime(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1000000000.0;
+}
+
+/**
+ * @brief Checks if the spikes of a probe stay within tolerance of the reference. The average frequencies must be close,
+ * and the spikes both runs found are paired in order and must be close in x.
+ *
+ * @param spikes the spikes of the probe.
+ * @param reference the spikes of the reference.
+ * @param neuronCount the number of neurons.
+ * @param criteria the tuning criteria.
+ * @return int - 1 if the probe is accurate, otherwise 0.
+ */
+static int isAccurate(const Points *spikes, const Points *reference, int neuronCount, const TuneCriteria *criteria) {
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        // Both frequencies are over the same span, so their ratio is the ratio of the spike counts (a spike may fall
+        // either side of the end).
+        int count = spikes[neuron].size, referenceCount = reference[neuron].size;
+        if (fabsf((float) (count - referenceCount)) > criteria->freqTolerance * referenceCount + 1.0) {
+            return 0;
+        }
+        for (int spike = 0; spike < count && spike < referenceCount; ++spike) {
+            if (fabsf(spikes[neuron].x[spike] - reference[neuron].x[spike]) > criteria->timeTolerance) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Runs a probe, timing it and comparing its spikes with the reference.
+ *
+ * @param weights the row-major adjacency matrix.
+ * @param neuronCount the number of neurons.
+ * @param probe the parameters of the probe.
+ * @param reference the spikes of the reference (NULL to store the spikes of the probe as the reference instead).
+ * @param criteria the tuning criteria.
+ * @param trial where to store the result of the probe.
+ * @param copy where to copy the spikes of the probe when reference is NULL.
+ * @return NsStatus - NS_OK, or the reason the probe could not be run.
+ */
+static NsStatus runProbe(float *weights, int neuronCount, const NsParams *probe, const Points *reference, const TuneCriteria *criteria, TuneTrial *trial, Points copy[]) {
+    *trial = (TuneTrial) {
+        .method = probe->method,
+        .step = probe->step,
+        .threads = probe->threads,
+        .seconds = INFINITY,
+        .accurate = 1
+    };
+
+    for (int repeat = 0; repeat < (reference != NULL ? TIMING_REPEATS : 1); ++repeat) {
+        NsSimulation *sim = NULL;
+        double start = getMonotonicTime();
+        NsStatus status = nsCreate(weights, neuronCount, probe, &sim);
+        if (status == NS_OK) {
+            status = nsRun(sim);
+        }
+        if (status != NS_OK) {
+            nsDestroy(sim);
+            return status;
+        }
+        double seconds = getMonotonicTime() - start;
+        trial->seconds = seconds < trial->seconds ? seconds : trial->seconds;
+
+        // Compare (or keep) the spikes of the first run.
+        const Points *spikes = nsSpikes(sim);
+        if (repeat == 0 && reference != NULL) {
+            trial->accurate = isAccurate(spikes, reference, neuronCount, criteria);
+        }
+        for (int neuron = 0; reference == NULL && neuron < neuronCount; ++neuron) {
+            copy[neuron] = initPoints(spikes[neuron].size);
+            if (copy[neuron].x == NULL && spikes[neuron].size > 0) {
+                for (int copied = 0; copied < neuron; ++copied) {
+                    freePoints(&copy[copied]);
+                }
+                nsDestroy(sim);
+                return NS_ERROR_MEMORY;
+            }
+            memcpy(copy[neuron].x, spikes[neuron].x, spikes[neuron].size * sizeof(float));
+            memcpy(copy[neuron].y, spikes[neuron].y, spikes[neuron].size * sizeof(float));
+        }
+        nsDestroy(sim);
+    }
+
+    return NS_OK;
+}
+
+/**
+ * @brief Adds a probe run to a tuning, growing its trials array if needed.
+ *
+ * @param tuning the tuning.
+ * @param trial the probe run.
+ * @return int - 1 if the trial was added, otherwise 0 (memory could not be allocated).
+ */
+static int addTrial(Tuning *tuning, const TuneTrial *trial) {
+    TuneTrial *trials;
+    if ((trials = (TuneTrial *) realloc(tuning->trials, (tuning->trialCount + 1) * sizeof(TuneTrial))) == NULL) {
+        return 0;
+    }
+    tuning->trials = trials;
+    tuning->trials[tuning->trialCount++] = *trial;
+    return 1;
+}
+
+void defaultTuneCriteria(TuneCriteria *criteria) {
+    *criteria = (TuneCriteria) {
+        .probeLength = DEFAULT_PROBE_LENGTH,
+        .timeTolerance = DEFAULT_TIME_TOLERANCE,
+        .freqTolerance = DEFAULT_FREQ_TOLERANCE,
+        .maxThreads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1
+    };
+}
+
+NsStatus tuneSimulation(float *weights, int neuronCount, const NsParams *params, const TuneCriteria *criteria, Tuning *tuning) {
+    *tuning = (Tuning) {
+        .method = METHOD_RK4,
+        .step = params->step / REFERENCE_DIVISOR,
+        .threads = 1,
+        .referenceStep = params->step / REFERENCE_DIVISOR,
+        .trials = NULL,
+        .trialCount = 0
+    };
+    if (!(criteria->probeLength > 0.0) || !(criteria->timeTolerance >= 0.0) || !(criteria->freqTolerance >= 0.0) || criteria->maxThreads < 1) {
+        return NS_ERROR_ARGUMENT;
+    }
+
+    // Shorten the run and only find spikes, without stopping early, noise, snapshots, or a monitor. The spikes are
+    // found from the start, since the chaotic trajectories of different steps part ways well before a usual transient.
+    NsParams probe = *params;
+    probe.xEnd = params->x0 + criteria->probeLength < params->xEnd ? params->x0 + criteria->probeLength : params->xEnd;
+    probe.transient = probe.x0;
+    probe.threads = 1;
+    probe.convergence = NULL;
+    probe.monitor = NULL;
+    NoiseParams noise;
+    if (params->noise != NULL) {
+        noise = *params->noise;
+        noise.strength = 0.0;
+        probe.noise = &noise;
+    }
+    PlasticityParams plasticity;
+    if (params->plasticity != NULL) {
+        plasticity = *params->plasticity;
+        plasticity.snapshotInterval = 0.0;
+        probe.plasticity = &plasticity;
+    }
+    int none = 0;
+    RecordSpec record = {
+        .funcMask = 0,
+        .neurons = &none,
+        .neuronCount = 0,
+        .start = probe.x0,
+        .end = probe.x0,
+        .stride = 1,
+        .spikes = 1,
+        .spikeThreshold = params->record != NULL ? params->record->spikeThreshold : 0.0
+    };
+    probe.record = &record;
+
+    // Run the reference with rk4 at a fine step. Every probe reuses one workspace (the caller's if it gave one).
+    Points *reference;
+    if ((reference = (Points *) malloc(neuronCount * sizeof(Points))) == NULL) {
+        return NS_ERROR_MEMORY;
+    }
+    Workspace workspace = initWorkspace();
+    if (probe.workspace == NULL) {
+        probe.workspace = &workspace;
+    }
+    TuneTrial trial, chosen;
+    probe.method = METHOD_RK4;
+    probe.step = tuning->referenceStep;
+    NsStatus status = runProbe(weights, neuronCount, &probe, NULL, criteria, &chosen, reference);
+    if (status != NS_OK) {
+        freeWorkspace(&workspace);
+        free(reference);
+        return status;
+    }
+
+    // Find the largest accurate step of each method, keeping the fastest method.
+    Method methods[] = {METHOD_RK4, METHOD_ETD, METHOD_MULTIRATE};
+    int found = 0;
+    for (size_t m = 0; m < sizeof(methods) / sizeof(Method) && status == NS_OK; ++m) {
+        TuneTrial best = {
+            .accurate = 0
+        };
+        probe.method = methods[m];
+        for (float factor = SMALLEST_FACTOR; factor <= LARGEST_FACTOR; factor *= 2.0) {
+            probe.step = params->step * factor;
+            if (runProbe(weights, neuronCount, &probe, reference, criteria, &trial, NULL) != NS_OK) {
+                break;
+            }
+            if (!addTrial(tuning, &trial)) {
+                status = NS_ERROR_MEMORY;
+                break;
+            }
+            if (!trial.accurate) {
+                break;
+            }
+            best = trial;
+        }
+        if (best.accurate && (!found || best.seconds < chosen.seconds)) {
+            chosen = best;
+            found = 1;
+        }
+    }
+
+    // Try more threads for the chosen step if the method supports them.
+    probe.method = chosen.method;
+    probe.step = chosen.step;
+    for (int threads = 2; found && status == NS_OK && threads <= criteria->maxThreads; threads *= 2) {
+        probe.threads = threads;
+        if (runProbe(weights, neuronCount, &probe, reference, criteria, &trial, NULL) != NS_OK) {
+            break;
+        }
+        if (!addTrial(tuning, &trial)) {
+            status = NS_ERROR_MEMORY;
+            break;
+        }
+        if (trial.accurate && trial.seconds < chosen.seconds) {
+            chosen = trial;
+        }
+    }
+
+    tuning->method = chosen.method;
+    tuning->step = chosen.step;
+    tuning->threads = chosen.threads;
+
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        freePoints(&reference[neuron]);
+    }
+    free(reference);
+    freeWorkspace(&workspace);
+    return status;
+}
+
+int writeTuning(const char *filename, const Tuning *tuning, int neuronCount) {
+    // Open output file for writing.
+    FILE *outfile;
+    if ((outfile = fopen(filename, "w")) == NULL) {
+        return 0;
+    }
+
+    // Begin writing.
+    fprintf(outfile, "# Autotuned against rk4 with a step of %g\n", tuning->referenceStep);
+    fprintf(outfile, "neurons %d\n", neuronCount);
+    fprintf(outfile, "method %s\n", methodName(tuning->method));
+    fprintf(outfile, "step %g\n", tuning->step);
+    fprintf(outfile, "threads %d\n", tuning->threads);
+
+    // Close ouput file.
+    return fclose(outfile) == 0;
+}
+
+int readTuning(const char *filename, NsParams *params, int *neuronCount) {
+    // Open input file for reading.
+    FILE *infile;
+    if ((infile = fopen(filename, "r")) == NULL) {
+        return 0;
+    }
+
+    // Read each setting, skipping comments.
+    char line[MAX_LINE_CHARS], key[MAX_LINE_CHARS], value[MAX_LINE_CHARS];
+    NsParams tuned = *params;
+    int valid = 1, settings = 0;
+    *neuronCount = 0;
+    while (valid && fgets(line, MAX_LINE_CHARS, infile) != NULL) {
+        if (line[0] == '#' || sscanf(line, "%s %s", key, value) != 2) {
+            continue;
+        }
+        if (strcmp(key, "neurons") == 0) {
+            *neuronCount = strtol(value, NULL, 10);
+        }
+        else if (strcmp(key, "method") == 0) {
+            valid = strcmp(value, "rk4") == 0 || strcmp(value, "multirate") == 0 || strcmp(value, "etd") == 0;
+            tuned.method = strcmp(value, "multirate") == 0 ? METHOD_MULTIRATE : strcmp(value, "etd") == 0 ? METHOD_ETD : METHOD_RK4;
+            ++settings;
+        }
+        else if (strcmp(key, "step") == 0) {
+            valid = (tuned.step = strtod(value, NULL)) > 0.0;
+            ++settings;
+        }
+        else if (strcmp(key, "threads") == 0) {
+            valid = (tuned.threads = strtol(value, NULL, 10)) >= 1;
+        }
+    }
+    fclose(infile);
+
+    // Only apply a whole configuration.
+    if (!valid || settings < 2) {
+        return 0;
+    }
+    *params = tuned;
+    return 1;
+}
+
+const char *methodName(Method method) {
+    switch (method) {
+        case METHOD_MULTIRATE:
+            return "multirate";
+        case METHOD_ETD:
+            return "etd";
+        default:
+            return "rk4";
+    }
+}
+
+void freeTuning(Tuning *tuning) {
+    free(tuning->trials);
+}
@@ -0,0 +1,144 @@
+/**
+ * @file autotune.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that picks the step size, numerical method, and thread count of a simulation from
+ * short probe runs of its graph, and saves the choice for later runs.
+ * @version 0.1
+ * @date 2022-10-17
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef AUTOTUNE
+#define AUTOTUNE
+
+#include "neurosync.h"
+
+/**
+ * @brief A criteria structure which describes the probes and how close they must stay to the reference.
+ */
+typedef struct {
+    /**
+     * @brief The x length of each probe run (its spikes are compared from x0, skipping no transient).
+     */
+    float probeLength;
+
+    /**
+     * @brief The largest x distance between a spike and the matching spike of the reference.
+     */
+    float timeTolerance;
+
+    /**
+     * @brief The largest relative difference between the average frequency of a neuron and that of the reference.
+     */
+    float freqTolerance;
+
+    /**
+     * @brief The most threads tried.
+     */
+    int maxThreads;
+} TuneCriteria;
+
+/**
+ * @brief A trial structure which holds the result of one probe run.
+ */
+typedef struct {
+    /**
+     * @brief The numerical method, step, and threads of the probe.
+     */
+    Method method;
+    float step;
+    int threads;
+
+    /**
+     * @brief The fastest wall time of the probe in seconds.
+     */
+    double seconds;
+
+    /**
+     * @brief Whether the spikes of the probe stayed within tolerance of the reference.
+     */
+    int accurate;
+} TuneTrial;
+
+/**
+ * @brief A tuning structure which holds the chosen configuration and every probe run to reach it.
+ */
+typedef struct {
+    /**
+     * @brief The chosen numerical method, step, and threads.
+     */
+    Method method;
+    float step;
+    int threads;
+
+    /**
+     * @brief The step of the reference run the probes are compared against.
+     */
+    float referenceStep;
+
+    /**
+     * @brief The probe runs in the order they were taken.
+     */
+    TuneTrial *trials;
+    int trialCount;
+} Tuning;
+
+/**
+ * @brief Sets the default criteria (probes of 100 with spikes within 1 and frequencies within 5%, on up to every core).
+ *
+ * @param criteria the criteria to set.
+ */
+void defaultTuneCriteria(TuneCriteria *criteria);
+
+/**
+ * @brief Tunes a simulation. The reference runs rk4 at a quarter of the given step; each method then tries steps from
+ * half to 16 times the given step and keeps the largest whose spikes stay within tolerance, and the fastest accurate
+ * method is timed at more threads if it supports them. Probes store nothing, never stop early, and add no noise.
+ *
+ * @param weights the row-major adjacency matrix. Access using weights[row * neuronCount + column].
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the simulation to be tuned.
+ * @param criteria the tuning criteria.
+ * @param tuning where to store the chosen configuration (free with freeTuning()).
+ * @return NsStatus - NS_OK, or the reason the reference could not be run (NS_ERROR_MEMORY if the trials could not be
+ * stored).
+ */
+NsStatus tuneSimulation(float *weights, int neuronCount, const NsParams *params, const TuneCriteria *criteria, Tuning *tuning);
+
+/**
+ * @brief Writes a chosen configuration to a file.
+ *
+ * @param filename the name of the file to write to.
+ * @param tuning the tuning.
+ * @param neuronCount the number of neurons of the tuned graph.
+ * @return int - 1 if the file was written, otherwise 0.
+ */
+int writeTuning(const char *filename, const Tuning *tuning, int neuronCount);
+
+/**
+ * @brief Reads a configuration written by writeTuning() into the parameters of a simulation.
+ *
+ * @param filename the name of the file to be read.
+ * @param params the parameters to set the method, step, and threads of.
+ * @param neuronCount where to store the number of neurons of the tuned graph.
+ * @return int - 1 if the file was read, otherwise 0.
+ */
+int readTuning(const char *filename, NsParams *params, int *neuronCount);
+
+/**
+ * @brief Gets the name of a numerical method.
+ *
+ * @param method the method.
+ * @return const char* - the name used on the command line.
+ */
+const char *methodName(Method method);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a tuning structure.
+ *
+ * @param tuning the tuning to be freed.
+ */
+void freeTuning(Tuning *tuning);
+
+#endif
@@ -0,0 +1,701 @@
+/**
+ * @file batch_runner.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Batch runner for running a manifest of neuron synchronization simulations.
+ * @version 0.1
+ * @date 2022-10-03
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "batch_runner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SPIKE_THRESHOLD 0.0
+#define DEFAULT_WINDOW 200.0    // The default convergence window (in x).
+#define DEFAULT_HOLD 200.0      // The default convergence hold duration (in x).
+#define DEFAULT_RATIO 4         // The default number of micro-steps per multirate macro-step.
+#define DEFAULT_ACTIVITY -1.0   // The default voltage a neuron must reach to take multirate micro-steps.
+#define DEFAULT_REVERSAL 2.0    // The default reversal potential of the chemical synapses.
+#define DEFAULT_DECAY 10.0      // The default decay time constant of the chemical synapses.
+#define DEFAULT_DELAY 1.0       // The default delay of the chemical synapses.
+#define DEFAULT_POTENTIATION 0.01  // The default weight added per unit of presynaptic trace by STDP.
+#define DEFAULT_DEPRESSION 0.012    // The default weight removed per unit of postsynaptic trace by STDP.
+#define DEFAULT_TAU 20.0        // The default time constant of the STDP traces.
+#define DEFAULT_MAX_WEIGHT 1.0  // The default largest weight STDP may reach.
+#define DEFAULT_MONITOR_INTERVAL 100    // The default number of steps between published progress samples.
+#define DEFAULT_MONITOR_CAPACITY 1024   // The number of progress samples kept for a viewer.
+#define DELIMITER " \t\r\n"     // The characters separating the fields of a manifest line.
+
+int main(int argc, char *argv[]) {
+    int workerCount = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    char *summary = DEFAULT_SUMMARY, *cache = NULL;
+    long long cacheBytes = (long long) DEFAULT_CACHE_MB << 20;
+
+    // Get the options.
+    int opt;
+    while ((opt = getopt(argc, argv, "j:s:Z:")) != -1) {
+        switch (opt) {
+            case 'j':
+                if ((workerCount = strtol(optarg, NULL, 10)) < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 's':
+                summary = optarg;
+                break;
+            case 'Z': {
+                // The directory, then optionally the most megabytes it may take.
+                char *size = strrchr(optarg, ':'), *end;
+                if (size != NULL) {
+                    double megabytes = strtod(size + 1, &end);
+                    if (*end != '\0' || !(megabytes >= 0.0)) {
+                        usage(argv[0]);
+                    }
+                    cacheBytes = megabytes * (1 << 20);
+                    *size = '\0';
+                }
+                cache = optarg;
+                break;
+            }
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (argc - optind != 1) {
+        usage(argv[0]);
+    }
+
+    // Read the manifest and load each distinct graph once.
+    Batch batch = readManifest(argv[optind]);
+    batch.cache = cache;
+    batch.cacheBytes = cacheBytes;
+    loadGraphs(&batch);
+
+    // Run the simulations.
+    double start = getTime();
+    runBatch(&batch, workerCount);
+    double elapsed = getTime() - start;
+
+    // Print and write the summary.
+    int failed = 0, hits = 0;
+    double busy = 0.0;
+    for (int i = 0; i < batch.runCount; ++i) {
+        failed += batch.runs[i].status != NS_OK;
+        hits += batch.runs[i].cacheHit;
+        busy += batch.runs[i].seconds;
+    }
+    printf("Batch of %d runs over %d graphs:\n", batch.runCount, batch.graphCount);
+    printf("\t%d succeeded and %d failed\n", batch.runCount - failed, failed);
+    printf("\t%f seconds elapsed on %d workers (%f seconds of runs)\n", elapsed, batch.workerCount, busy);
+    if (batch.cache != NULL) {
+        printf("\t%d results copied from %s\n", hits, batch.cache);
+    }
+    writeSummary(&batch, summary);
+
+    freeBatch(&batch);
+    exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/**
+ * @brief Applies one key=value option of a manifest line to a run.
+ *
+ * @param run the run.
+ * @param option the option.
+ * @return int - 1 if the option was recognized and valid, otherwise 0.
+ */
+static int parseOption(BatchRun *run, char *option) {
+    char *value = strchr(option, '=');
+    if (value == NULL) {
+        return 0;
+    }
+    *value++ = '\0';
+
+    if (strcmp(option, "method") == 0) {
+        if (strcmp(value, "rk4") == 0) {
+            run->params.method = METHOD_RK4;
+        }
+        else if (strcmp(value, "multirate") == 0) {
+            run->params.method = METHOD_MULTIRATE;
+        }
+        else if (strcmp(value, "etd") == 0) {
+            run->params.method = METHOD_ETD;
+        }
+        else {
+            return 0;
+        }
+    }
+    else if (strcmp(option, "ratio") == 0) {
+        run->params.ratio = strtol(value, NULL, 10);
+    }
+    else if (strcmp(option, "activity") == 0) {
+        run->params.activityThreshold = strtod(value, NULL);
+    }
+    else if (strcmp(option, "threads") == 0) {
+        return (run->params.threads = strtol(value, NULL, 10)) >= 1;
+    }
+    else if (strcmp(option, "coupling") == 0) {
+        if (strcmp(value, "electrical") != 0 && strcmp(value, "chemical") != 0) {
+            return 0;
+        }
+        run->chemical = strcmp(value, "chemical") == 0;
+    }
+    else if (strcmp(option, "reversal") == 0) {
+        run->synapses.reversal = strtod(value, NULL);
+    }
+    else if (strcmp(option, "decay") == 0) {
+        run->synapses.decay = strtod(value, NULL);
+    }
+    else if (strcmp(option, "delay") == 0) {
+        run->synapses.delay = strtod(value, NULL);
+    }
+    else if (strcmp(option, "noise") == 0) {
+        return (run->noise.strength = strtod(value, NULL)) >= 0.0;
+    }
+    else if (strcmp(option, "spread") == 0) {
+        return (run->noise.spread = strtod(value, NULL)) >= 0.0;
+    }
+    else if (strcmp(option, "seed") == 0) {
+        run->noise.seed = strtoull(value, NULL, 10);
+    }
+    else if (strcmp(option, "sync") == 0) {
+        run->convergence.checks |= CHECK_SYNCHRONY;
+        run->convergence.syncTolerance = strtod(value, NULL);
+    }
+    else if (strcmp(option, "periodic") == 0) {
+        run->convergence.checks |= CHECK_PERIODIC;
+        run->convergence.isiTolerance = strtod(value, NULL);
+    }
+    else if (strcmp(option, "window") == 0) {
+        run->convergence.window = strtod(value, NULL);
+    }
+    else if (strcmp(option, "hold") == 0) {
+        run->convergence.hold = strtod(value, NULL);
+    }
+    else if (strcmp(option, "funcs") == 0) {
+        run->record.funcMask = 0;
+        char *save;
+        for (char *func = strtok_r(value, ",", &save); func != NULL; func = strtok_r(NULL, ",", &save)) {
+            int num = strtol(func, NULL, 10);
+            if (num < 0 || num >= NS_FUNC_COUNT) {
+                return 0;
+            }
+            run->record.funcMask |= 1 << num;
+        }
+    }
+    else if (strcmp(option, "neurons") == 0) {
+        if (!parseRecordNeurons(value, &run->record)) {
+            perror("malloc() failure");
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (strcmp(option, "sample") == 0) {
+        return (run->sampleCount = strtol(value, NULL, 10)) > 0;
+    }
+    else if (strcmp(option, "record") == 0) {
+        run->windowed = 1;
+        return sscanf(value, "%f:%f", &run->record.start, &run->record.end) == 2;
+    }
+    else if (strcmp(option, "stdp") == 0) {
+        run->plastic = 1;
+        return strcmp(value, "default") == 0 || sscanf(value, "%f:%f:%f:%f:%f", &run->plasticity.potentiation, &run->plasticity.depression,
+                                                       &run->plasticity.tauPlus, &run->plasticity.tauMinus, &run->plasticity.maxWeight) >= 1;
+    }
+    else if (strcmp(option, "snapshots") == 0) {
+        return (run->plasticity.snapshotInterval = strtod(value, NULL)) > 0.0;
+    }
+    else if (strcmp(option, "monitor") == 0) {
+        char *interval = strchr(value, ':');
+        if (interval != NULL) {
+            *interval++ = '\0';
+            if ((run->monitor.interval = strtol(interval, NULL, 10)) < 1) {
+                return 0;
+            }
+        }
+        return value[0] != '\0' && snprintf(run->monitorName, MAX_NAME_CHARS, "%s", value) < MAX_NAME_CHARS;
+    }
+    else if (strcmp(option, "tuned") == 0) {
+        int neuronCount;
+        return readTuning(value, &run->params, &neuronCount);
+    }
+    else if (strcmp(option, "components") == 0) {
+        run->components = strtol(value, NULL, 10);
+    }
+    else if (strcmp(option, "quantum") == 0) {
+        return (run->record.quantum = strtod(value, NULL)) > 0.0;
+    }
+    else if (strcmp(option, "keyframes") == 0) {
+        return (run->record.keyframeInterval = strtol(value, NULL, 10)) > 0;
+    }
+    else if (strcmp(option, "stride") == 0) {
+        return (run->record.stride = strtol(value, NULL, 10)) > 0;
+    }
+    else if (strcmp(option, "outputs") == 0) {
+        run->outputs = 0;
+        char *save;
+        for (char *output = strtok_r(value, ",", &save); output != NULL; output = strtok_r(NULL, ",", &save)) {
+            if (strcmp(output, "approx") == 0) {
+                run->outputs |= NS_WRITE_APPROX;
+            }
+            else if (strcmp(output, "spikes") == 0) {
+                run->outputs |= NS_WRITE_SPIKES;
+            }
+            else if (strcmp(output, "isi") == 0) {
+                run->outputs |= NS_WRITE_ISI;
+            }
+            else if (strcmp(output, "freqs") == 0) {
+                run->outputs |= NS_WRITE_FREQS;
+            }
+            else if (strcmp(output, "weights") == 0) {
+                run->outputs |= NS_WRITE_WEIGHTS;
+            }
+            else if (strcmp(output, "keyframes") == 0) {
+                run->outputs |= NS_WRITE_KEYFRAMES;
+            }
+            else if (strcmp(output, "raster") == 0) {
+                run->outputs |= NS_WRITE_RASTER;
+            }
+            else if (strcmp(output, "peaks") == 0) {
+                run->outputs |= NS_WRITE_RASTER | NS_WRITE_PEAKS;
+            }
+            else if (strcmp(output, "all") == 0) {
+                run->outputs |= NS_WRITE_ALL;
+            }
+            else if (strcmp(output, "none") != 0) {
+                return 0;
+            }
+        }
+    }
+    else if (strcmp(option, "out") == 0) {
+        return snprintf(run->outDir, MAX_PATH_CHARS, "%s", value) < MAX_PATH_CHARS;
+    }
+    else {
+        return 0;
+    }
+
+    return 1;
+}
+
+Batch readManifest(char *filename) {
+    Batch batch = {
+        .runs = NULL,
+        .runCount = 0,
+        .graphs = NULL,
+        .graphCount = 0,
+        .deques = NULL,
+        .workerCount = 0,
+        .cache = NULL,
+        .cacheBytes = 0
+    };
+    int runCapacity = 0, graphCapacity = 0;
+
+    // Open manifest file for reading.
+    FILE *manifest;
+    if ((manifest = fopen(filename, "r")) == NULL) {
+        perror("Open Manifest File");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[MAX_MANIFEST_LINE];
+    for (int lineNum = 1; fgets(line, MAX_MANIFEST_LINE, manifest) != NULL; ++lineNum) {
+        // Skip blank lines and comments.
+        char *save;
+        char *fields[6];
+        if ((fields[0] = strtok_r(line, DELIMITER, &save)) == NULL || fields[0][0] == '#') {
+            continue;
+        }
+        for (int i = 1; i < 6; ++i) {
+            if ((fields[i] = strtok_r(NULL, DELIMITER, &save)) == NULL) {
+                fprintf(stderr, "%s:%d: expected name graph x0 xEnd step transient, exiting ...\n", filename, lineNum);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        // Grow the runs array.
+        if (batch.runCount == runCapacity) {
+            runCapacity = runCapacity ? 2 * runCapacity : 16;
+            if ((batch.runs = (BatchRun *) realloc(batch.runs, runCapacity * sizeof(BatchRun))) == NULL) {
+                perror("realloc() failure");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        // Set the defaults of the run (the same as the driver).
+        BatchRun *run = &batch.runs[batch.runCount++];
+        *run = (BatchRun) {
+            .convergence = {
+                .checks = 0,
+                .window = DEFAULT_WINDOW,
+                .hold = DEFAULT_HOLD,
+                .spikeThreshold = SPIKE_THRESHOLD
+            },
+            .chemical = 0,
+            .synapses = {
+                .reversal = DEFAULT_REVERSAL,
+                .decay = DEFAULT_DECAY,
+                .delay = DEFAULT_DELAY,
+                .threshold = SPIKE_THRESHOLD
+            },
+            .noise = {
+                .seed = 0,
+                .strength = 0.0,
+                .spread = 0.0
+            },
+            .plastic = 0,
+            .plasticity = {
+                .potentiation = DEFAULT_POTENTIATION,
+                .depression = DEFAULT_DEPRESSION,
+                .tauPlus = DEFAULT_TAU,
+                .tauMinus = DEFAULT_TAU,
+                .maxWeight = DEFAULT_MAX_WEIGHT,
+                .threshold = SPIKE_THRESHOLD,
+                .snapshotInterval = 0.0
+            },
+            .monitorName = "",
+            .monitor = {
+                .name = NULL,
+                .interval = DEFAULT_MONITOR_INTERVAL,
+                .capacity = DEFAULT_MONITOR_CAPACITY
+            },
+            .components = 0,
+            .record = {
+                .funcMask = 0x1,
+                .neurons = NULL,
+                .neuronCount = 0,
+                .stride = 1,
+                .spikes = 1,
+                .spikeThreshold = SPIKE_THRESHOLD
+            },
+            .outputs = NS_WRITE_ALL,
+            .status = NS_OK,
+            .cacheHit = 0
+        };
+        nsDefaultParams(&run->params);
+        run->params.ratio = DEFAULT_RATIO;
+        run->params.activityThreshold = DEFAULT_ACTIVITY;
+        snprintf(run->name, MAX_NAME_CHARS, "%s", fields[0]);
+        snprintf(run->outDir, MAX_PATH_CHARS, "Out/%s", run->name);
+        run->params.x0 = strtod(fields[2], NULL);
+        run->params.xEnd = strtod(fields[3], NULL);
+        run->params.step = strtod(fields[4], NULL);
+        run->params.transient = strtod(fields[5], NULL);
+
+        // Apply the options.
+        for (char *option = strtok_r(NULL, DELIMITER, &save); option != NULL; option = strtok_r(NULL, DELIMITER, &save)) {
+            if (!parseOption(run, option)) {
+                fprintf(stderr, "%s:%d: invalid option %s, exiting ...\n", filename, lineNum, option);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        // Find the graph in the cache, adding it if it is new.
+        for (run->graph = 0; run->graph < batch.graphCount && strcmp(batch.graphs[run->graph].filename, fields[1]) != 0; ++run->graph);
+        if (run->graph == batch.graphCount) {
+            if (batch.graphCount == graphCapacity) {
+                graphCapacity = graphCapacity ? 2 * graphCapacity : 4;
+                if ((batch.graphs = (CachedGraph *) realloc(batch.graphs, graphCapacity * sizeof(CachedGraph))) == NULL) {
+                    perror("realloc() failure");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            CachedGraph *graph = &batch.graphs[batch.graphCount++];
+            snprintf(graph->filename, MAX_PATH_CHARS, "%s", fields[1]);
+            graph->weights = NULL;
+            graph->neuronCount = 0;
+        }
+    }
+    fclose(manifest);
+
+    // Point the parameters of each run at its options (now that the runs array has stopped moving).
+    for (int i = 0; i < batch.runCount; ++i) {
+        BatchRun *run = &batch.runs[i];
+        if (run->convergence.checks) {
+            run->params.convergence = &run->convergence;
+        }
+        if (run->chemical) {
+            run->params.synapses = &run->synapses;
+        }
+        if (run->noise.strength > 0.0 || run->noise.spread > 0.0) {
+            run->params.noise = &run->noise;
+        }
+        if (run->plastic) {
+            run->params.plasticity = &run->plasticity;
+        }
+        if (run->monitorName[0] != '\0') {
+            run->monitor.name = run->monitorName;
+            run->params.monitor = &run->monitor;
+        }
+        if (!run->windowed) {
+            run->record.start = run->params.x0;
+            run->record.end = run->params.xEnd;
+        }
+        run->params.record = &run->record;
+    }
+
+    return batch;
+}
+
+void loadGraphs(Batch *batch) {
+    for (int i = 0; i < batch->graphCount; ++i) {
+        CachedGraph *graph = &batch->graphs[i];
+        if ((graph->status = nsReadGraph(graph->filename, &graph->weights, &graph->neuronCount)) != NS_OK) {
+            fprintf(stderr, "Could not read %s (%s)\n", graph->filename, nsStatusName(graph->status));
+        }
+    }
+
+    // Select the evenly spaced neurons of each run now that its neuron count is known.
+    for (int i = 0; i < batch->runCount; ++i) {
+        BatchRun *run = &batch->runs[i];
+        int neuronCount = batch->graphs[run->graph].neuronCount;
+        if (run->sampleCount > 0 && neuronCount > 0) {
+            free(run->record.neurons);
+            run->record.neuronCount = run->sampleCount < neuronCount ? run->sampleCount : neuronCount;
+            if ((run->record.neurons = (int *) malloc(run->record.neuronCount * sizeof(int))) == NULL) {
+                perror("malloc() failure");
+                exit(EXIT_FAILURE);
+            }
+            for (int j = 0; j < run->record.neuronCount; ++j) {
+                run->record.neurons[j] = (long) j * neuronCount / run->record.neuronCount;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Estimates the work of a run (the coupling of every neuron pair at every step).
+ *
+ * @param batch the batch.
+ * @param run the index of the run.
+ * @return double - the estimated work.
+ */
+static double estimateWork(Batch *batch, int run) {
+    double neurons = batch->graphs[batch->runs[run].graph].neuronCount;
+    NsParams *params = &batch->runs[run].params;
+    return neurons * neurons * (params->xEnd - params->x0) / params->step;
+}
+
+/**
+ * @brief The batch being sorted by estimateWork() (qsort() takes no context).
+ */
+static Batch *sortBatch;
+
+/**
+ * @brief Compares two runs for qsort(), placing the most work first.
+ *
+ * @param a the index of the first run.
+ * @param b the index of the second run.
+ * @return int - negative, zero, or positive as a has more, equal, or less work than b.
+ */
+static int compareWork(const void *a, const void *b) {
+    double workA = estimateWork(sortBatch, *(const int *) a), workB = estimateWork(sortBatch, *(const int *) b);
+    return (workA < workB) - (workA > workB);
+}
+
+void runBatch(Batch *batch, int workerCount) {
+    batch->workerCount = workerCount < batch->runCount ? workerCount : (batch->runCount ? batch->runCount : 1);
+
+    // Deal the runs out from the most to the least work, so each queue starts with its longest runs.
+    int *order;
+    if ((order = (int *) malloc((batch->runCount ? batch->runCount : 1) * sizeof(int))) == NULL ||
+        (batch->deques = (RunDeque *) malloc(batch->workerCount * sizeof(RunDeque))) == NULL) {
+        perror("malloc() failure");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < batch->runCount; ++i) {
+        order[i] = i;
+    }
+    sortBatch = batch;
+    qsort(order, batch->runCount, sizeof(int), compareWork);
+    for (int w = 0; w < batch->workerCount; ++w) {
+        RunDeque *deque = &batch->deques[w];
+        if ((deque->runs = (int *) malloc((batch->runCount / batch->workerCount + 1) * sizeof(int))) == NULL) {
+            perror("malloc() failure");
+            exit(EXIT_FAILURE);
+        }
+        deque->front = deque->back = 0;
+        pthread_mutex_init(&deque->lock, NULL);
+    }
+    for (int i = 0; i < batch->runCount; ++i) {
+        RunDeque *deque = &batch->deques[i % batch->workerCount];
+        deque->runs[deque->back++] = order[i];
+    }
+    free(order);
+
+    // Start the workers and wait for them to drain every queue.
+    pthread_t threads[batch->workerCount];
+    Worker workers[batch->workerCount];
+    for (int w = 0; w < batch->workerCount; ++w) {
+        workers[w] = (Worker) {.batch = batch, .id = w};
+        if (pthread_create(&threads[w], NULL, runWorker, &workers[w]) != 0) {
+            perror("pthread_create() failure");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int w = 0; w < batch->workerCount; ++w) {
+        pthread_join(threads[w], NULL);
+    }
+}
+
+/**
+ * @brief Takes the next run for a worker, first from the front of its own queue, then from the back of another's.
+ *
+ * @param batch the batch.
+ * @param id the number of the worker.
+ * @return int - the index of the run, or -1 if every queue is empty.
+ */
+static int takeRun(Batch *batch, int id) {
+    for (int offset = 0; offset < batch->workerCount; ++offset) {
+        RunDeque *deque = &batch->deques[(id + offset) % batch->workerCount];
+        int run = -1;
+
+        pthread_mutex_lock(&deque->lock);
+        if (deque->front < deque->back) {
+            run = offset == 0 ? deque->runs[deque->front++] : deque->runs[--deque->back];
+        }
+        pthread_mutex_unlock(&deque->lock);
+
+        if (run >= 0) {
+            return run;
+        }
+    }
+
+    // No runs are ever added, so empty queues mean the batch is done.
+    return -1;
+}
+
+void *runWorker(void *arg) {
+    Worker *worker = (Worker *) arg;
+    Batch *batch = worker->batch;
+
+    // Every run of the worker reuses one workspace.
+    Workspace workspace = initWorkspace();
+    for (int index = takeRun(batch, worker->id); index >= 0; index = takeRun(batch, worker->id)) {
+        BatchRun *run = &batch->runs[index];
+        CachedGraph *graph = &batch->graphs[run->graph];
+        NsSimulation *sim = NULL;
+        NsParams params = run->params;
+        params.workspace = &workspace;
+        double start = getTime();
+        run->worker = worker->id;
+
+        // Run the connected components of the shared graph on this worker, writing their outputs as they finish.
+        if (run->components) {
+            NsComponentStats stats;
+            if ((run->status = graph->status) == NS_OK && run->outputs && mkdir(run->outDir, 0755) != 0 && errno != EEXIST) {
+                run->status = NS_ERROR_IO;
+            }
+            if (run->status == NS_OK &&
+                (run->status = nsRunComponents(graph->weights, graph->neuronCount, &params, 1, run->outDir, run->outputs, &stats)) == NS_OK) {
+                run->steps = stats.steps;
+                run->evalCount = stats.evalCount;
+                run->stopReason = STOP_END;
+            }
+            run->seconds = getTime() - start;
+            continue;
+        }
+
+        // Run the simulation through the result cache, copying the outputs of an identical earlier run if there was one.
+        if (batch->cache != NULL) {
+            NsCacheStats stats;
+            if ((run->status = graph->status) == NS_OK && run->outputs && mkdir(run->outDir, 0755) != 0 && errno != EEXIST) {
+                run->status = NS_ERROR_IO;
+            }
+            if (run->status == NS_OK &&
+                (run->status = nsRunCached(graph->weights, graph->neuronCount, &params, batch->cache, batch->cacheBytes, run->outDir, run->outputs, &stats)) == NS_OK) {
+                run->steps = stats.steps;
+                run->evalCount = stats.evalCount;
+                run->stopReason = stats.stopReason;
+                run->cacheHit = stats.hit;
+            }
+            run->seconds = getTime() - start;
+            continue;
+        }
+
+        // Run the simulation on the shared graph and write its outputs.
+        if ((run->status = graph->status) == NS_OK &&
+            (run->status = nsCreate(graph->weights, graph->neuronCount, &params, &sim)) == NS_OK &&
+            (run->status = nsRun(sim)) == NS_OK) {
+            const EqSolution *sol = nsSolution(sim);
+            run->steps = nsStepsTaken(sim);
+            run->evalCount = sol->evalCount;
+            run->stopReason = sol->stopReason;
+            if (run->outputs) {
+                if (mkdir(run->outDir, 0755) != 0 && errno != EEXIST) {
+                    run->status = NS_ERROR_IO;
+                }
+                else {
+                    run->status = nsWriteResults(sim, run->outDir, run->outputs);
+                }
+            }
+        }
+        nsDestroy(sim);
+        run->seconds = getTime() - start;
+    }
+
+    freeWorkspace(&workspace);
+    return NULL;
+}
+
+void writeSummary(Batch *batch, char *filename) {
+    // Open output file for writing.
+    FILE *outfile;
+    if ((outfile = fopen(filename, "w")) == NULL) {
+        perror("Write Summary");
+        exit(EXIT_FAILURE);
+    }
+
+    // Begin writing.
+    fprintf(outfile, "# name\tstatus\tworker\tseconds\tsteps\tevaluations\tstop\tcached\n");
+    for (int i = 0; i < batch->runCount; ++i) {
+        BatchRun *run = &batch->runs[i];
+        fprintf(outfile, "%s\t%s\t%d\t%f\t%d\t%ld\t%s\t%d\n", run->name, nsStatusName(run->status), run->worker, run->seconds,
+                run->steps, run->evalCount, run->status == NS_OK ? stopReasonName(run->stopReason) : "-", run->cacheHit);
+    }
+
+    // Close ouput file.
+    fclose(outfile);
+}
+
+void freeBatch(Batch *batch) {
+    for (int i = 0; i < batch->runCount; ++i) {
+        free(batch->runs[i].record.neurons);
+    }
+    for (int i = 0; i < batch->graphCount; ++i) {
+        nsFreeWeights(batch->graphs[i].weights);
+    }
+    for (int w = 0; batch->deques != NULL && w < batch->workerCount; ++w) {
+        free(batch->deques[w].runs);
+        pthread_mutex_destroy(&batch->deques[w].lock);
+    }
+    free(batch->deques);
+    free(batch->graphs);
+    free(batch->runs);
+}
+
+void usage(const char *prog_name) {
+    fprintf(stderr, "\nUsage: %s [options] [manifest file path]\n", prog_name);
+    fprintf(stderr, "\nEach manifest line: [name] [graph file path] [x0] [xEnd] [step] [transient] [key=value ...]\n");
+    fprintf(stderr, "\tmethod=rk4|multirate|etd ratio=4 activity=-1 threads=1 coupling=electrical|chemical reversal=2 decay=10 delay=1\n");
+    fprintf(stderr, "\tnoise=0 spread=0 seed=0 stdp=default|a+:a-:tau+:tau-:max snapshots=interval monitor=name:interval tuned=file components=0\n");
+    fprintf(stderr, "\tsync=tolerance periodic=tolerance window=200 hold=200\n");
+    fprintf(stderr, "\tfuncs=0,2 neurons=0-49,100 sample=50 record=start:end stride=1 quantum=0.0001 keyframes=1000\n");
+    fprintf(stderr, "\toutputs=approx,spikes,isi,freqs,weights,keyframes,raster,peaks|all|none out=Out/[name]\n");
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "\t-j [threads]\tthe number of worker threads (default the number of cores)\n");
+    fprintf(stderr, "\t-s [file]\tthe file the per-run summary is written to (default %s)\n", DEFAULT_SUMMARY);
+    fprintf(stderr, "\t-Z [dir[:megabytes]]\tcopy the outputs of identical earlier runs from the cache dir (not components=1; default %d MB)\n\n", DEFAULT_CACHE_MB);
+    exit(EXIT_FAILURE);
+}
+
+double getTime(){
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + t.tv_usec/1000000.0;
+}
\ No newline at end of file
@@ -0,0 +1,303 @@
+/**
+ * @file batch_runner.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that runs a manifest of simulations across threads, sharing each graph between runs.
+ * @version 0.1
+ * @date 2022-10-03
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef BATCH_RUNNER
+#define BATCH_RUNNER
+
+#include "neurosync.h"
+#include "autotune.h"
+
+#include <pthread.h>
+
+#define MAX_MANIFEST_LINE 4096                  // The maximum amount of characters in a line of the manifest.
+#define MAX_NAME_CHARS 64                       // The maximum amount of characters in the name of a run.
+#define MAX_PATH_CHARS 256                      // The maximum amount of characters in a file path.
+#define DEFAULT_SUMMARY "Out/batch_summary"     // The default file the summary is written to.
+#define DEFAULT_CACHE_MB 1024                   // The default most megabytes the result cache may take.
+
+/**
+ * @brief A run structure which holds the specification and result of one simulation in the manifest.
+ */
+typedef struct {
+    /**
+     * @brief The name of the run.
+     */
+    char name[MAX_NAME_CHARS];
+
+    /**
+     * @brief The index of the graph in the graph cache.
+     */
+    int graph;
+
+    /**
+     * @brief The parameters of the simulation (pointing at the structures below).
+     */
+    NsParams params;
+
+    /**
+     * @brief The convergence criteria (checks is 0 when disabled).
+     */
+    ConvergenceCriteria convergence;
+
+    /**
+     * @brief Whether the neurons are coupled through chemical synapses.
+     */
+    int chemical;
+
+    /**
+     * @brief The parameters of the chemical synapses.
+     */
+    SynapseParams synapses;
+
+    /**
+     * @brief The noise added to x and the spread of the initial values (both 0 for a deterministic simulation).
+     */
+    NoiseParams noise;
+
+    /**
+     * @brief Whether the weights are plastic.
+     */
+    int plastic;
+
+    /**
+     * @brief The plasticity rule and weight snapshot interval.
+     */
+    PlasticityParams plasticity;
+
+    /**
+     * @brief The shared memory object the progress is published to (empty to publish nothing).
+     */
+    char monitorName[MAX_NAME_CHARS];
+
+    /**
+     * @brief The interval the progress is published with.
+     */
+    MonitorParams monitor;
+
+    /**
+     * @brief Whether the graph is run as its connected components.
+     */
+    int components;
+
+    /**
+     * @brief What the simulation stores.
+     */
+    RecordSpec record;
+
+    /**
+     * @brief The number of evenly spaced neurons to store (0 to use the neurons of record).
+     */
+    int sampleCount;
+
+    /**
+     * @brief Whether the window in record was given (otherwise it spans the whole run).
+     */
+    int windowed;
+
+    /**
+     * @brief The outputs to write (NS_WRITE_* flags).
+     */
+    int outputs;
+
+    /**
+     * @brief The directory the outputs are written into.
+     */
+    char outDir[MAX_PATH_CHARS];
+
+    /**
+     * @brief The result of the run.
+     */
+    NsStatus status;
+
+    /**
+     * @brief The worker thread that ran the simulation.
+     */
+    int worker;
+
+    /**
+     * @brief The seconds the run took (including writing its outputs).
+     */
+    double seconds;
+
+    /**
+     * @brief The steps taken, ODE evaluations, and stop reason of the simulation.
+     */
+    int steps;
+    long evalCount;
+    StopReason stopReason;
+
+    /**
+     * @brief Whether the results were copied from the result cache instead of running.
+     */
+    int cacheHit;
+} BatchRun;
+
+/**
+ * @brief A cached graph structure which holds a graph loaded once and shared read-only by every run using it.
+ */
+typedef struct {
+    /**
+     * @brief The name of the graph file.
+     */
+    char filename[MAX_PATH_CHARS];
+
+    /**
+     * @brief The row-major adjacency matrix (NULL if it could not be read).
+     */
+    float *weights;
+
+    /**
+     * @brief The number of neurons in the graph.
+     */
+    int neuronCount;
+
+    /**
+     * @brief The result of reading the graph.
+     */
+    NsStatus status;
+} CachedGraph;
+
+/**
+ * @brief A double-ended queue of runs owned by one worker. The owner takes runs from the front, and idle workers
+ * steal runs from the back.
+ */
+typedef struct {
+    /**
+     * @brief The indices of the queued runs.
+     */
+    int *runs;
+
+    /**
+     * @brief The position of the front and one past the back of the queued runs.
+     */
+    int front, back;
+
+    /**
+     * @brief The lock guarding front and back.
+     */
+    pthread_mutex_t lock;
+} RunDeque;
+
+/**
+ * @brief A batch structure which holds the runs, the graph cache, and the queue of each worker.
+ */
+typedef struct {
+    /**
+     * @brief The runs of the manifest.
+     */
+    BatchRun *runs;
+    int runCount;
+
+    /**
+     * @brief The distinct graphs of the manifest.
+     */
+    CachedGraph *graphs;
+    int graphCount;
+
+    /**
+     * @brief The queue of each worker.
+     */
+    RunDeque *deques;
+    int workerCount;
+
+    /**
+     * @brief The result cache directory shared by the runs (NULL to always run), and the most bytes it may take.
+     */
+    const char *cache;
+    long long cacheBytes;
+} Batch;
+
+/**
+ * @brief A worker structure which is passed to each worker thread.
+ */
+typedef struct {
+    /**
+     * @brief The batch being run.
+     */
+    Batch *batch;
+
+    /**
+     * @brief The number of the worker.
+     */
+    int id;
+} Worker;
+
+/**
+ * @brief Runs every simulation of a manifest and writes a summary.
+ *
+ * @param argc the command-line argument count.
+ * @param argv the command-line argument values.
+ * @return int - the exit status of the batch.
+ */
+int main(int argc, char *argv[]);
+
+/**
+ * @brief Reads the runs of a manifest. Each line holds "name graph x0 xEnd step transient" followed by any key=value
+ * options, and blank lines or lines starting with '#' are skipped.
+ *
+ * @param filename the name of the manifest.
+ * @return Batch - the batch of runs, with one cache entry for each distinct graph.
+ */
+Batch readManifest(char *filename);
+
+/**
+ * @brief Loads each distinct graph of a batch once and resolves the neuron selections that depend on it.
+ *
+ * @param batch the batch.
+ */
+void loadGraphs(Batch *batch);
+
+/**
+ * @brief Runs every simulation of a batch across worker threads with work-stealing queues.
+ *
+ * @param batch the batch.
+ * @param workerCount the number of worker threads.
+ */
+void runBatch(Batch *batch, int workerCount);
+
+/**
+ * @brief The entry point of each worker thread. Takes runs from its own queue, then steals from the others, reusing one
+ * workspace for all of them.
+ *
+ * @param arg the Worker structure of the thread.
+ * @return void* - NULL.
+ */
+void *runWorker(void *arg);
+
+/**
+ * @brief Writes the status and timing of each run to a file.
+ *
+ * @param batch the batch.
+ * @param filename the name of the file to write to.
+ */
+void writeSummary(Batch *batch, char *filename);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a batch structure.
+ *
+ * @param batch the batch to be freed.
+ */
+void freeBatch(Batch *batch);
+
+/**
+ * @brief Prints a message to stderr explaining how to run the program.
+ *
+ * @param prog_name the name of the executable file.
+ */
+void usage(const char *);
+
+/**
+ * @brief Gets the current time in seconds.
+ *
+ * @return double - the current time in seconds.
+ */
+double getTime();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,238 @@
+/**
+ * @file components.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the components header file.
+ * @version 0.1
+ * @date 2022-10-14
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "components.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define FNV_OFFSET 14695981039346656037ULL  // The starting value of the FNV-1a hash.
+#define FNV_PRIME 1099511628211ULL          // The multiplier of the FNV-1a hash.
+
+/**
+ * @brief A signature structure which orders components so copies end up next to each other.
+ */
+typedef struct {
+    /**
+     * @brief The number of neurons in the component.
+     */
+    int size;
+
+    /**
+     * @brief The hash of the labels and weights of the component.
+     */
+    uint64_t hash;
+
+    /**
+     * @brief The number of the component.
+     */
+    int component;
+} Signature;
+
+/**
+ * @brief Adds a float to an FNV-1a hash (0 and -0 hash alike since they compare equal).
+ *
+ * @param hash the hash so far.
+ * @param value the value to add.
+ * @return uint64_t - the new hash.
+ */
+static uint64_t hashFloat(uint64_t hash, float value) {
+    value += 0.0F;
+    unsigned char bytes[sizeof(float)];
+    memcpy(bytes, &value, sizeof(float));
+    for (size_t i = 0; i < sizeof(float); ++i) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Compares two signatures for qsort() by size, then hash, then component number.
+ *
+ * @param a the first signature.
+ * @param b the second signature.
+ * @return int - negative, zero, or positive as a is below, equal to, or above b.
+ */
+static int compareSignatures(const void *a, const void *b) {
+    const Signature *first = (const Signature *) a, *second = (const Signature *) b;
+    if (first->size != second->size) {
+        return first->size < second->size ? -1 : 1;
+    }
+    if (first->hash != second->hash) {
+        return first->hash < second->hash ? -1 : 1;
+    }
+    return first->component - second->component;
+}
+
+/**
+ * @brief Checks if a component is a copy of another, pairing their neurons in ascending order.
+ *
+ * @param components the components (both must have the same size).
+ * @param graph the graph.
+ * @param labels the parameters of each neuron.
+ * @param a the first component.
+ * @param b the second component.
+ * @return int - 1 if the components are copies, otherwise 0.
+ */
+static int isCopy(Components *components, Graph *graph, const float labels[], int a, int b) {
+    const int *neuronsA = &components->neurons[components->first[a]], *neuronsB = &components->neurons[components->first[b]];
+    int size = components->first[a + 1] - components->first[a];
+
+    for (int i = 0; i < size; ++i) {
+        if (labels[neuronsA[i]] != labels[neuronsB[i]]) {
+            return 0;
+        }
+        for (int j = 0; j < size; ++j) {
+            if (graph->adjMatrix[neuronsA[i]][neuronsA[j]] != graph->adjMatrix[neuronsB[i]][neuronsB[j]]) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Frees a partially found components structure.
+ *
+ * @param components the components.
+ * @return Components - the components with NULL neurons, marking that memory could not be allocated.
+ */
+static Components failComponents(Components *components) {
+    freeComponents(components);
+    components->first = components->neurons = components->component = components->representative = NULL;
+    return *components;
+}
+
+Components findComponents(Graph *graph, const float labels[]) {
+    int neuronCount = graph->vertexCount;
+    Components components = {
+        .count = 0,
+        .uniqueCount = 0,
+        .largest = 0,
+        .first = NULL,
+        .representative = NULL
+    };
+
+    // Allocate heap memory for the component of each neuron and the search queue.
+    components.component = (int *) malloc(neuronCount * sizeof(int));
+    components.neurons = (int *) malloc(neuronCount * sizeof(int));
+    int *queue = (int *) malloc(neuronCount * sizeof(int));
+    if (components.component == NULL || components.neurons == NULL || queue == NULL) {
+        free(queue);
+        return failComponents(&components);
+    }
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        components.component[neuron] = -1;
+    }
+
+    // Search outward from the lowest neuron not yet in a component.
+    for (int start = 0; start < neuronCount; ++start) {
+        if (components.component[start] >= 0) {
+            continue;
+        }
+        int head = 0, tail = 0;
+        components.component[start] = components.count;
+        queue[tail++] = start;
+        while (head < tail) {
+            int neuron = queue[head++];
+            for (int other = 0; other < neuronCount; ++other) {
+                if (components.component[other] < 0 && (graph->adjMatrix[neuron][other] != 0.0 || graph->adjMatrix[other][neuron] != 0.0)) {
+                    components.component[other] = components.count;
+                    queue[tail++] = other;
+                }
+            }
+        }
+        ++components.count;
+    }
+    free(queue);
+
+    // Group the neurons by component in ascending order.
+    components.first = (int *) calloc(components.count + 1, sizeof(int));
+    components.representative = (int *) malloc(components.count * sizeof(int));
+    int *filled = (int *) malloc(components.count * sizeof(int));
+    if (components.first == NULL || components.representative == NULL || filled == NULL) {
+        free(filled);
+        return failComponents(&components);
+    }
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        ++components.first[components.component[neuron] + 1];
+    }
+    for (int c = 0; c < components.count; ++c) {
+        int size = components.first[c + 1];
+        components.largest = size > components.largest ? size : components.largest;
+        components.first[c + 1] += components.first[c];
+        components.representative[c] = c;
+    }
+    memcpy(filled, components.first, components.count * sizeof(int));
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        components.neurons[filled[components.component[neuron]]++] = neuron;
+    }
+    free(filled);
+
+    if (labels == NULL) {
+        components.uniqueCount = components.count;
+        return components;
+    }
+
+    // Hash the labels and weights of each component.
+    Signature *signatures;
+    if ((signatures = (Signature *) malloc(components.count * sizeof(Signature))) == NULL) {
+        return failComponents(&components);
+    }
+    for (int c = 0; c < components.count; ++c) {
+        const int *neurons = &components.neurons[components.first[c]];
+        int size = components.first[c + 1] - components.first[c];
+        uint64_t hash = FNV_OFFSET;
+        for (int i = 0; i < size; ++i) {
+            hash = hashFloat(hash, labels[neurons[i]]);
+            for (int j = 0; j < size; ++j) {
+                hash = hashFloat(hash, graph->adjMatrix[neurons[i]][neurons[j]]);
+            }
+        }
+        signatures[c] = (Signature) {
+            .size = size,
+            .hash = hash,
+            .component = c
+        };
+    }
+
+    // Compare each component with the earlier representatives of its size and hash.
+    qsort(signatures, components.count, sizeof(Signature), compareSignatures);
+    for (int run = 0, end; run < components.count; run = end) {
+        for (end = run + 1; end < components.count && signatures[end].size == signatures[run].size && signatures[end].hash == signatures[run].hash; ++end);
+        for (int i = run; i < end; ++i) {
+            int c = signatures[i].component;
+            for (int j = run; j < i && components.representative[c] == c; ++j) {
+                int earlier = signatures[j].component;
+                if (components.representative[earlier] == earlier && isCopy(&components, graph, labels, earlier, c)) {
+                    components.representative[c] = earlier;
+                }
+            }
+        }
+    }
+    free(signatures);
+
+    for (int c = 0; c < components.count; ++c) {
+        components.uniqueCount += components.representative[c] == c;
+    }
+
+    return components;
+}
+
+void freeComponents(Components *components) {
+    // Free the offsets, neurons, and representatives.
+    free(components->first);
+    free(components->neurons);
+    free(components->component);
+    free(components->representative);
+}
\ No newline at end of file
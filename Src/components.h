@@ -0,0 +1,76 @@
+/**
+ * @file components.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that splits a graph into its connected components and finds the components that are
+ * copies of each other.
+ * @version 0.1
+ * @date 2022-10-14
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef COMPONENTS
+#define COMPONENTS
+
+#include "graph_manipulations.h"
+
+/**
+ * @brief A components structure which groups the neurons of a graph by connected component.
+ */
+typedef struct {
+    /**
+     * @brief The number of components.
+     */
+    int count;
+
+    /**
+     * @brief The offset of each component within neurons, followed by the number of neurons. Component c holds
+     * neurons[first[c]] to neurons[first[c + 1] - 1].
+     */
+    int *first;
+
+    /**
+     * @brief The neurons of each component in ascending order. Components are ordered by their lowest neuron.
+     */
+    int *neurons;
+
+    /**
+     * @brief The component each neuron belongs to. Access using component[neuronNum].
+     */
+    int *component;
+
+    /**
+     * @brief The component simulated in place of each component (itself unless it is a copy of an earlier one).
+     */
+    int *representative;
+
+    /**
+     * @brief The number of components that are their own representative.
+     */
+    int uniqueCount;
+
+    /**
+     * @brief The number of neurons in the largest component.
+     */
+    int largest;
+} Components;
+
+/**
+ * @brief Finds the connected components of a graph (an edge in either direction connects two neurons). With labels,
+ * a component is a copy of an earlier one when matching its neurons in ascending order pairs neurons with equal labels
+ * and every pair of edges with equal weights, so both evolve identically.
+ *
+ * @param graph the graph.
+ * @param labels the parameters of each neuron that must match between copies (NULL to treat every component as unique).
+ * @return Components - the initialized components structure (NULL neurons if memory could not be allocated).
+ */
+Components findComponents(Graph *graph, const float labels[]);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a components structure.
+ *
+ * @param components the components to be freed.
+ */
+void freeComponents(Components *components);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,204 @@
+/**
+ * @file convergence.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the convergence header file.
+ * @version 0.1
+ * @date 2022-09-12
+ * 
+ * @copyright Copyright (c) 2022
+ */
+
+#include "convergence.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+/**
+ * @brief Gets one of the most recent inter-spike intervals of a neuron.
+ * 
+ * @param monitor the convergence monitor.
+ * @param neuron the number of the neuron.
+ * @param age how many intervals ago (0 is the newest).
+ * @return float - the inter-spike interval.
+ */
+static float getRecentISI(ConvergenceMonitor *monitor, int neuron, int age) {
+    int index = (monitor->isiCount[neuron] - 1 - age) % ISI_HISTORY;
+    return monitor->isis[neuron * ISI_HISTORY + index];
+}
+
+/**
+ * @brief Checks if the latest inter-spike intervals of a neuron repeat with some period.
+ * 
+ * @param monitor the convergence monitor.
+ * @param neuron the number of the neuron.
+ * @return int - 1 if the last cycle of intervals matches the one before it, otherwise 0.
+ */
+static int isPeriodic(ConvergenceMonitor *monitor, int neuron) {
+    int known = monitor->isiCount[neuron] < ISI_HISTORY ? monitor->isiCount[neuron] : ISI_HISTORY;
+
+    // Try each period that fits twice within the history.
+    for (int period = 1; period <= known / 2; ++period) {
+        int matches = 1;
+        for (int age = 0; age < period && matches; ++age) {
+            float newer = getRecentISI(monitor, neuron, age);
+            float older = getRecentISI(monitor, neuron, age + period);
+            matches = fabsf(newer - older) <= monitor->criteria.isiTolerance * newer;
+        }
+
+        if (matches) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Updates how long a criterion has held for.
+ * 
+ * @param since the x position the criterion started holding at (NAN if it does not hold).
+ * @param holds whether the criterion holds at this step.
+ * @param curX the current x position.
+ * @param hold the length a criterion must hold for before stopping.
+ * @return int - 1 if the criterion has held for the hold duration, otherwise 0.
+ */
+static int updateHold(float *since, int holds, float curX, float hold) {
+    if (!holds) {
+        *since = NAN;
+        return 0;
+    }
+
+    if (isnan(*since)) {
+        *since = curX;
+    }
+
+    return curX - *since >= hold;
+}
+
+ConvergenceMonitor initConvergenceMonitor(ConvergenceCriteria *criteria, int neuronCount, float step) {
+    ConvergenceMonitor monitor = {
+        .criteria = *criteria,
+        .windowSize = ceil(criteria->window / step) > 1 ? ceil(criteria->window / step) : 1,
+        .head = 0,
+        .filled = 0,
+        .syncSum = 0.0,
+        .voltSum = 0.0,
+        .voltSumSq = 0.0,
+        .detector = initSpikeDetector(neuronCount, criteria->spikeThreshold),
+        .aperiodicCount = 0,
+        .syncSince = NAN,
+        .periodicSince = NAN,
+        .neuronCount = neuronCount
+    };
+
+    // Allocate heap memory for the synchronization error window and the spike history of each neuron.
+    monitor.syncErrors = (float *) malloc(monitor.windowSize * sizeof(float));
+    monitor.lastSpike = (float *) malloc(neuronCount * sizeof(float));
+    monitor.isis = (float *) malloc(neuronCount * ISI_HISTORY * sizeof(float));
+    monitor.isiCount = (int *) calloc(neuronCount, sizeof(int));
+    monitor.periodic = (char *) calloc(neuronCount, sizeof(char));
+    if (monitor.syncErrors == NULL || monitor.lastSpike == NULL || monitor.isis == NULL || monitor.isiCount == NULL ||
+        monitor.periodic == NULL || monitor.detector.prev == NULL) {
+        freeConvergenceMonitor(&monitor);
+        monitor.syncErrors = monitor.lastSpike = monitor.isis = NULL;
+        monitor.isiCount = NULL;
+        monitor.periodic = NULL;
+        monitor.detector.prev = monitor.detector.cur = NULL;
+        monitor.detector.found = monitor.detector.seen = NULL;
+        return monitor;
+    }
+
+    // No neuron has spiked yet.
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        monitor.lastSpike[neuron] = NAN;
+    }
+
+    return monitor;
+}
+
+void observeNeuron(ConvergenceMonitor *monitor, int neuron, float curX, float voltage) {
+    // Accumulate the voltage moments for the synchronization error.
+    monitor->voltSum += voltage;
+    monitor->voltSumSq += (double) voltage * voltage;
+
+    if (monitor->criteria.checks & CHECK_PERIODIC) {
+        // Record the interval to any new spike and re-check this neuron's periodicity.
+        if (detectSpike(&monitor->detector, neuron, voltage)) {
+            if (!isnan(monitor->lastSpike[neuron])) {
+                monitor->isis[neuron * ISI_HISTORY + monitor->isiCount[neuron] % ISI_HISTORY] = curX - monitor->lastSpike[neuron];
+                ++monitor->isiCount[neuron];
+                monitor->periodic[neuron] = isPeriodic(monitor, neuron);
+            }
+            monitor->lastSpike[neuron] = curX;
+        }
+
+        // A neuron that has not spiked within the window is silent, which is also stationary.
+        int silent = isnan(monitor->lastSpike[neuron]) || curX - monitor->lastSpike[neuron] > monitor->criteria.window;
+        if (!silent && !monitor->periodic[neuron]) {
+            ++monitor->aperiodicCount;
+        }
+    }
+}
+
+StopReason finishConvergenceStep(ConvergenceMonitor *monitor, float curX, float transient) {
+    StopReason reason = STOP_END;
+
+    // Slide the synchronization error (standard deviation of the voltages) into the window.
+    double mean = monitor->voltSum / monitor->neuronCount;
+    double variance = monitor->voltSumSq / monitor->neuronCount - mean * mean;
+    float syncError = variance > 0.0 ? sqrt(variance) : 0.0;
+    if (monitor->filled == monitor->windowSize) {
+        monitor->syncSum -= monitor->syncErrors[monitor->head];
+    }
+    else {
+        ++monitor->filled;
+    }
+    monitor->syncErrors[monitor->head] = syncError;
+    monitor->syncSum += syncError;
+    monitor->head = (monitor->head + 1) % monitor->windowSize;
+
+    // Only judge the criteria once the window is full and the transient has passed.
+    int judge = monitor->filled == monitor->windowSize && curX >= transient;
+
+    if (monitor->criteria.checks & CHECK_SYNCHRONY) {
+        int holds = judge && monitor->syncSum / monitor->windowSize <= monitor->criteria.syncTolerance;
+        if (updateHold(&monitor->syncSince, holds, curX, monitor->criteria.hold)) {
+            reason = STOP_SYNCHRONY;
+        }
+    }
+
+    if ((monitor->criteria.checks & CHECK_PERIODIC) && reason == STOP_END) {
+        int holds = judge && monitor->aperiodicCount == 0;
+        if (updateHold(&monitor->periodicSince, holds, curX, monitor->criteria.hold)) {
+            reason = STOP_PERIODIC;
+        }
+    }
+
+    // Reset the per-step accumulators.
+    monitor->voltSum = 0.0;
+    monitor->voltSumSq = 0.0;
+    monitor->aperiodicCount = 0;
+
+    return reason;
+}
+
+const char *stopReasonName(StopReason reason) {
+    switch (reason) {
+        case STOP_SYNCHRONY:
+            return "synchronized";
+        case STOP_PERIODIC:
+            return "periodic";
+        default:
+            return "reached xEnd";
+    }
+}
+
+void freeConvergenceMonitor(ConvergenceMonitor *monitor) {
+    // Free the window, spike history, and detector.
+    free(monitor->syncErrors);
+    free(monitor->lastSpike);
+    free(monitor->isis);
+    free(monitor->isiCount);
+    free(monitor->periodic);
+    freeSpikeDetector(&monitor->detector);
+}
\ No newline at end of file
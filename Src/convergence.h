@@ -0,0 +1,189 @@
+/**
+ * @file convergence.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that detects when a simulation has reached a steady state.
+ * @version 0.1
+ * @date 2022-09-12
+ * 
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef CONVERGENCE
+#define CONVERGENCE
+
+#include "spike_calculations.h"
+
+#define CHECK_SYNCHRONY 0x1     // Stop once the voltages of all neurons stay close together.
+#define CHECK_PERIODIC 0x2      // Stop once the inter-spike intervals of all neurons repeat.
+#define ISI_HISTORY 16          // The number of inter-spike intervals remembered for each neuron.
+
+/**
+ * @brief The reasons a simulation may stop.
+ */
+typedef enum {
+    STOP_END,           // The simulation reached xEnd.
+    STOP_SYNCHRONY,     // The network stayed synchronized for the hold duration.
+    STOP_PERIODIC       // The network stayed periodic for the hold duration.
+} StopReason;
+
+/**
+ * @brief A criteria structure which specifies when a simulation has converged.
+ */
+typedef struct {
+    /**
+     * @brief The criteria to check (CHECK_SYNCHRONY and/or CHECK_PERIODIC).
+     */
+    int checks;
+
+    /**
+     * @brief The largest windowed synchronization error (standard deviation of the voltages) considered synchronized.
+     */
+    float syncTolerance;
+
+    /**
+     * @brief The largest relative change between repeating inter-spike intervals considered periodic.
+     */
+    float isiTolerance;
+
+    /**
+     * @brief The length (in x) of the sliding window the criteria are measured over.
+     */
+    float window;
+
+    /**
+     * @brief The length (in x) a criterion must hold for before stopping.
+     */
+    float hold;
+
+    /**
+     * @brief The minimum value a spike must reach.
+     */
+    float spikeThreshold;
+} ConvergenceCriteria;
+
+/**
+ * @brief A monitor structure which tracks the convergence state of a running simulation.
+ */
+typedef struct {
+    /**
+     * @brief The criteria being checked.
+     */
+    ConvergenceCriteria criteria;
+
+    /**
+     * @brief The ring buffer of synchronization errors within the window.
+     */
+    float *syncErrors;
+
+    /**
+     * @brief The number of steps within the window.
+     */
+    int windowSize;
+
+    /**
+     * @brief The index of the oldest synchronization error.
+     */
+    int head;
+
+    /**
+     * @brief The number of synchronization errors currently in the window.
+     */
+    int filled;
+
+    /**
+     * @brief The sum of the synchronization errors in the window.
+     */
+    double syncSum;
+
+    /**
+     * @brief The running sum and sum of squares of the voltages for the current step.
+     */
+    double voltSum, voltSumSq;
+
+    /**
+     * @brief The online detector used to find spikes.
+     */
+    SpikeDetector detector;
+
+    /**
+     * @brief The time of the last spike of each neuron (NAN if none yet).
+     */
+    float *lastSpike;
+
+    /**
+     * @brief The most recent inter-spike intervals of each neuron. Access using isis[neuronNum * ISI_HISTORY + i].
+     */
+    float *isis;
+
+    /**
+     * @brief The total number of inter-spike intervals recorded for each neuron.
+     */
+    int *isiCount;
+
+    /**
+     * @brief Whether the latest inter-spike intervals of each neuron repeat.
+     */
+    char *periodic;
+
+    /**
+     * @brief The number of neurons observed this step that are neither periodic nor silent.
+     */
+    int aperiodicCount;
+
+    /**
+     * @brief The x position each criterion started holding at (NAN if it does not hold).
+     */
+    float syncSince, periodicSince;
+
+    /**
+     * @brief The number of neurons being observed.
+     */
+    int neuronCount;
+} ConvergenceMonitor;
+
+/**
+ * @brief Initializes and allocates memory for a convergence monitor structure.
+ * 
+ * @param criteria the criteria to check.
+ * @param neuronCount the number of neurons to observe.
+ * @param step the size of each step.
+ * @return ConvergenceMonitor - the initialized monitor structure (a NULL window if memory could not be allocated).
+ */
+ConvergenceMonitor initConvergenceMonitor(ConvergenceCriteria *criteria, int neuronCount, float step);
+
+/**
+ * @brief Records the voltage of a neuron for the current step. Call for every neuron before finishConvergenceStep().
+ * 
+ * @param monitor the convergence monitor.
+ * @param neuron the number of the neuron.
+ * @param curX the current x position.
+ * @param voltage the voltage of the neuron at curX.
+ */
+void observeNeuron(ConvergenceMonitor *monitor, int neuron, float curX, float voltage);
+
+/**
+ * @brief Completes the current step and checks the criteria.
+ * 
+ * @param monitor the convergence monitor.
+ * @param curX the current x position.
+ * @param transient the x position before which the simulation may not stop.
+ * @return StopReason - the reason to stop, or STOP_END to keep going.
+ */
+StopReason finishConvergenceStep(ConvergenceMonitor *monitor, float curX, float transient);
+
+/**
+ * @brief Gets a readable name for a stop reason.
+ * 
+ * @param reason the stop reason.
+ * @return const char* - the name of the reason.
+ */
+const char *stopReasonName(StopReason reason);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a convergence monitor structure.
+ * 
+ * @param monitor the monitor to be freed.
+ */
+void freeConvergenceMonitor(ConvergenceMonitor *monitor);
+
+#endif
\ No newline at end of file
@@ -8,6 +8,8 @@
  * @copyright Copyright (c) 2022
  */
 
+#include "differential_equations.h"
+
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -54,23 +56,47 @@ float getS(int myNeuron, int neuronCount, float lowerBound, float upperBound) {
     return fmodf(((float) myNeuron) + ((float) myNeuron / neuronCount), upperBound - lowerBound) + lowerBound;
 }
 
-void getHR(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, float result[]) {
+float getNeuronS(int myNeuron, int neuronCount) {
+    return getS(myNeuron, neuronCount, S_LOWER, S_UPPER);
+}
+
+void getHR(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]) {
     float x = inputs[0][myNeuron];    // Voltage
     float y = inputs[1][myNeuron];    // Spiking
     float z = inputs[2][myNeuron];    // Bursting
 
-    result[0] = y - (x*x*x) + (3*x*x) - z + I - calcSyncFactor(inputs[0], weights, neuronCount, myNeuron);
+    // Electrical coupling only applies when weights are given.
+    float coupling = weights != NULL ? calcSyncFactor(inputs[0], weights, neuronCount, myNeuron) : 0.0;
+
+    result[0] = y - (x*x*x) + (3*x*x) - z + I - coupling;
     result[1] = 1 - (5*x*x) - y;
-    result[2] = r * (getS(myNeuron, neuronCount, S_LOWER, S_UPPER) * (x - xR) - z);
+    // The s value follows the neuron's number within the whole graph.
+    float s = ids != NULL ? getS(ids->ids[myNeuron], ids->total, S_LOWER, S_UPPER) : getS(myNeuron, neuronCount, S_LOWER, S_UPPER);
+    result[2] = r * (s * (x - xR) - z);
 }
 
+void getHRLinear(int neuronCount, float inputs[][neuronCount], float weights[], int myNeuron, float result[]) {
+    float x = inputs[0][myNeuron];    // Voltage
+
+    // The coupling term -sum(weight * (x_mine - x_other)) contributes -sum(weight) to x (when weights are given).
+    float degree = 0.0;
+    for (int neuron = 0; neuron < neuronCount && weights != NULL; ++neuron) {
+        if (neuron != myNeuron) {
+            degree += weights[neuron];
+        }
+    }
+
+    // The cubic x terms are linearized about the current voltage.
+    result[0] = (-3*x*x) + (6*x) - degree;
+    result[1] = -1.0;
+    result[2] = -r;
+}
 
-void writeSs(char *filename, int neuronCount) {
+int writeSs(char *filename, int neuronCount) {
     // Open output file for writing.
     FILE *outfile;
     if ((outfile = fopen(filename, "w")) == NULL) {
-        perror("Write Solution");
-        exit(EXIT_FAILURE);
+        return 0;
     }
     
     // Begin writing.
@@ -79,5 +105,5 @@ void writeSs(char *filename, int neuronCount) {
     }
     
     // Close ouput file.
-    fclose(outfile);
+    return fclose(outfile) == 0;
 }
\ No newline at end of file
@@ -11,24 +11,49 @@
 #ifndef DIFFERENTIAL_EQUATIONS
 #define DIFFERENTIAL_EQUATIONS
 
+#include "graph_manipulations.h"
+
 /**
  * @brief The Hindmarsh-Rose (HR) neuronal model.
  * 
  * @param neuronCount the number of neurons in the graph.
  * @param inputs the inputs for each function for every neuron. Access using inputs[functionNum][neuronNum].
  * @param curX the current x position.
- * @param weights the weights/edges between myNeuron and all other neurons. Access using weights[neuronNum].
+ * @param weights the weights/edges between myNeuron and all other neurons (NULL for no electrical coupling). Access using weights[neuronNum].
  * @param myNeuron the number of the current neuron.
+ * @param ids the numbers of the neurons within the whole graph when simulating a subgraph (NULL when the graph is whole).
  * @param result the calculated values for each function with the given inputs. Access using result[functionNum].
  */
-void getHR(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, float result[]);
+void getHR(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]);
+
+/**
+ * @brief The diagonal linear terms of the Hindmarsh-Rose (HR) neuronal model at the given inputs: the decay of y and z, 
+ * and for x the self part of the diffusive coupling plus the cubic terms linearized about the current voltage.
+ * 
+ * @param neuronCount the number of neurons in the graph.
+ * @param inputs the inputs for each function for every neuron. Access using inputs[functionNum][neuronNum].
+ * @param weights the weights/edges between myNeuron and all other neurons (NULL for no electrical coupling). Access using weights[neuronNum].
+ * @param myNeuron the number of the current neuron.
+ * @param result the linear coefficient of each function. Access using result[functionNum].
+ */
+void getHRLinear(int neuronCount, float inputs[][neuronCount], float weights[], int myNeuron, float result[]);
+
+/**
+ * @brief Gets the s value (HR control variable) of a neuron.
+ * 
+ * @param myNeuron the number of the neuron.
+ * @param neuronCount the number of neurons in the graph.
+ * @return float - the s value of the neuron.
+ */
+float getNeuronS(int myNeuron, int neuronCount);
 
 /**
  * @brief Writes the s value (HR control variable) of each neuron to a file.
  * 
  * @param filename the name of the file to write to.
  * @param neuronCount the number of neurons in the graph.
+ * @return int - 1 if the file was written, otherwise 0.
  */
-void writeSs(char *filename, int neuronCount);
+int writeSs(char *filename, int neuronCount);
 
 #endif
\ No newline at end of file
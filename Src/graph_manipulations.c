@@ -17,70 +17,66 @@
 #define DELIMITER " \t\r\n\v\f" // The legal characters that may be used to separate the edges.
 #define MAX_EDGE_CHARS 10       // The maximum amount of characters that the weight of an edge may be.
 
-Graph readGraph(char *filename) {
-    Graph graph;
-
+GraphStatus loadGraph(char *filename, Graph *graph) {
     // Open graph file for reading.
     FILE *graphFile;
     if ((graphFile = fopen(filename, "r")) == NULL) {
-        perror("Open Graph File");
-        exit(EXIT_FAILURE);
+        return GRAPH_ERROR_OPEN;
     }
 
     // Get the vertex count.
-    if (fscanf(graphFile, "# %d\n", &graph.vertexCount) != 1) {
-        perror("Missing Vertex Count");
-        exit(EXIT_FAILURE);
+    if (fscanf(graphFile, "# %d\n", &graph->vertexCount) != 1 || graph->vertexCount < 1) {
+        fclose(graphFile);
+        return GRAPH_ERROR_FORMAT;
     }
     
-    // Allocate the adjacency matrix memory.
-    if ((graph.adjMatrix = (float **) malloc(graph.vertexCount * sizeof(float *))) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+    // Allocate the adjacency matrix memory and the buffer memory for reading in the edges.
+    long bufferSize = graph->vertexCount * MAX_EDGE_CHARS * sizeof(char);
+    char *buffer = (char *) malloc(bufferSize);
+    if ((graph->adjMatrix = (float **) calloc(graph->vertexCount, sizeof(float *))) == NULL || buffer == NULL) {
+        free(graph->adjMatrix);
+        free(buffer);
+        fclose(graphFile);
+        return GRAPH_ERROR_MEMORY;
     }
-    for (int i = 0; i < graph.vertexCount; ++i) {
-        if ((graph.adjMatrix[i] = (float *) malloc(graph.vertexCount * sizeof(float))) == NULL) {
-            perror("malloc() failure");
-            exit(EXIT_FAILURE);
+    GraphStatus status = GRAPH_OK;
+    for (int i = 0; i < graph->vertexCount && status == GRAPH_OK; ++i) {
+        if ((graph->adjMatrix[i] = (float *) malloc(graph->vertexCount * sizeof(float))) == NULL) {
+            status = GRAPH_ERROR_MEMORY;
         }        
     }
-
-    // Allocate the buffer memory for reading in the edges.
-    long bufferSize = graph.vertexCount * MAX_EDGE_CHARS * sizeof(char);
-    char *buffer = (char *) malloc(bufferSize);
-    if ((buffer) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
-    }
     
     // Read in the edges.
-    for (int row = 0; row < graph.vertexCount; ++row) {
+    for (int row = 0; row < graph->vertexCount && status == GRAPH_OK; ++row) {
         // Get a row from the file.
         if (fgets(buffer, bufferSize, graphFile) == NULL) {
-            fprintf(stderr, "Vertex count > # of rows, exiting ...\n");
-            exit(EXIT_FAILURE);
+            status = GRAPH_ERROR_FORMAT;
+            break;
         }
 
         // Tokenize and add each edge to the adjacency matrix.
         int col = 0;
-        for (char *token = strtok(buffer, DELIMITER); token != NULL; token = strtok(NULL, DELIMITER), ++col) {
-            graph.adjMatrix[row][col] = strtod(token, NULL);
-
-            if (col >= graph.vertexCount) {
-                fprintf(stderr, "Vertex count < # of columns, exiting ...\n");
-                exit(EXIT_FAILURE);
+        char *save;
+        for (char *token = strtok_r(buffer, DELIMITER, &save); token != NULL && status == GRAPH_OK; token = strtok_r(NULL, DELIMITER, &save), ++col) {
+            if (col >= graph->vertexCount) {
+                status = GRAPH_ERROR_FORMAT;
+            }
+            else {
+                graph->adjMatrix[row][col] = strtod(token, NULL);
             }
         }
-        if (col < graph.vertexCount) {
-            fprintf(stderr, "Vertex count > # of columns, exiting ...\n");
-            exit(EXIT_FAILURE);
+        if (col < graph->vertexCount) {
+            status = GRAPH_ERROR_FORMAT;
         }
     }
 
-    // Close graph file, free buffer, and return.
+    // Close graph file, free buffer, and return (freeing the graph on failure).
     fclose(graphFile);
     free(buffer);
-    return graph;
+    if (status != GRAPH_OK) {
+        freeGraph(graph);
+    }
+    return status;
 }
 
 void freeGraph(Graph *graph) {
@@ -27,12 +27,38 @@ typedef struct {
 } Graph;
 
 /**
- * @brief Reads a graph from a formatted file.
+ * @brief A numbering structure which maps the neurons of a subgraph back to the graph they were taken from.
+ */
+typedef struct {
+    /**
+     * @brief The number of each neuron of the subgraph within the whole graph. Access using ids[neuronNum].
+     */
+    const int *ids;
+
+    /**
+     * @brief The number of neurons in the whole graph.
+     */
+    int total;
+} NeuronIds;
+
+/**
+ * @brief The results of loading a graph.
+ */
+typedef enum {
+    GRAPH_OK,               // The graph was loaded.
+    GRAPH_ERROR_OPEN,       // The file could not be opened.
+    GRAPH_ERROR_FORMAT,     // The file is not a formatted graph.
+    GRAPH_ERROR_MEMORY      // The graph could not be allocated.
+} GraphStatus;
+
+/**
+ * @brief Loads a graph from a formatted file. Nothing is allocated when it fails.
  * 
  * @param filename the name of the file to be read.
- * @return Graph - the read in graph.
+ * @param graph the graph to load into.
+ * @return GraphStatus - GRAPH_OK, or the reason the graph could not be loaded.
  */
-Graph readGraph(char *filename);
+GraphStatus loadGraph(char *filename, Graph *graph);
 
 /**
  * @brief Frees the dynamic/heap memory allocated to a graph structure.
@@ -0,0 +1,155 @@
+/**
+ * @file keyframes.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the keyframes header file.
+ * @version 0.1
+ * @date 2022-10-18
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "keyframes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Makes room for at least a number of keyframes.
+ *
+ * @param keyframes the keyframes.
+ * @param capacity the number of keyframes.
+ * @return int - 1 if there is room, otherwise 0 (memory could not be allocated and the kept keyframes are unchanged).
+ */
+static int reserveKeyframes(Keyframes *keyframes, int capacity) {
+    capacity = capacity > 1 ? capacity : 1;
+    int32_t *steps;
+    float *x, *frames;
+    if ((steps = (int32_t *) realloc(keyframes->steps, capacity * sizeof(int32_t))) == NULL) {
+        return 0;
+    }
+    keyframes->steps = steps;
+    if ((x = (float *) realloc(keyframes->x, capacity * sizeof(float))) == NULL) {
+        return 0;
+    }
+    keyframes->x = x;
+    if ((frames = (float *) realloc(keyframes->frames, (size_t) capacity * keyframes->frameSize * sizeof(float))) == NULL) {
+        return 0;
+    }
+    keyframes->frames = frames;
+    keyframes->capacity = capacity;
+    return 1;
+}
+
+Keyframes initKeyframes(const KeyframeRun *run, int frameSize, int expected) {
+    Keyframes keyframes = {
+        .run = *run,
+        .frameSize = frameSize,
+        .count = 0,
+        .capacity = 0,
+        .steps = NULL,
+        .x = NULL,
+        .frames = NULL
+    };
+
+    if (!reserveKeyframes(&keyframes, expected)) {
+        freeKeyframes(&keyframes);
+        keyframes.steps = NULL;
+        keyframes.x = keyframes.frames = NULL;
+    }
+    return keyframes;
+}
+
+int takeKeyframe(Keyframes *keyframes, int step, float x, const float state[], int stateSize, const float extra[]) {
+    if (keyframes->count == keyframes->capacity && !reserveKeyframes(keyframes, 2 * keyframes->capacity)) {
+        return 0;
+    }
+
+    float *frame = &keyframes->frames[(size_t) keyframes->count * keyframes->frameSize];
+    memcpy(frame, state, stateSize * sizeof(float));
+    if (extra != NULL) {
+        memcpy(frame + stateSize, extra, (keyframes->frameSize - stateSize) * sizeof(float));
+    }
+    keyframes->steps[keyframes->count] = step;
+    keyframes->x[keyframes->count++] = x;
+    return 1;
+}
+
+int findKeyframe(const Keyframes *keyframes, int step) {
+    // Binary search for the last keyframe at or before the step.
+    int low = 0, high = keyframes->count - 1, found = -1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (keyframes->steps[middle] <= step) {
+            found = middle;
+            low = middle + 1;
+        }
+        else {
+            high = middle - 1;
+        }
+    }
+
+    return found;
+}
+
+int writeKeyframes(const Keyframes *keyframes, const char *filename) {
+    // Open output file for writing.
+    FILE *outfile;
+    if ((outfile = fopen(filename, "wb")) == NULL) {
+        return 0;
+    }
+
+    // Write the header.
+    int32_t counts[2] = {keyframes->frameSize, keyframes->count};
+    int written = fwrite(KEYFRAME_MAGIC, 1, 4, outfile) == 4 && fwrite(&keyframes->run, sizeof(KeyframeRun), 1, outfile) == 1 &&
+                  fwrite(counts, sizeof(int32_t), 2, outfile) == 2;
+
+    // Write each keyframe.
+    for (int frame = 0; frame < keyframes->count && written; ++frame) {
+        written = fwrite(&keyframes->steps[frame], sizeof(int32_t), 1, outfile) == 1 && fwrite(&keyframes->x[frame], sizeof(float), 1, outfile) == 1 &&
+                  fwrite(&keyframes->frames[(size_t) frame * keyframes->frameSize], sizeof(float), keyframes->frameSize, outfile) == (size_t) keyframes->frameSize;
+    }
+
+    // Close ouput file.
+    return fclose(outfile) == 0 && written;
+}
+
+int readKeyframes(const char *filename, Keyframes *keyframes) {
+    // Open input file for reading.
+    FILE *infile;
+    if ((infile = fopen(filename, "rb")) == NULL) {
+        return 0;
+    }
+
+    // Read and check the header.
+    char magic[4];
+    KeyframeRun run;
+    int32_t counts[2];
+    if (fread(magic, 1, 4, infile) != 4 || memcmp(magic, KEYFRAME_MAGIC, 4) != 0 || fread(&run, sizeof(KeyframeRun), 1, infile) != 1 ||
+        fread(counts, sizeof(int32_t), 2, infile) != 2 || counts[0] < 1 || counts[1] < 0) {
+        fclose(infile);
+        return 0;
+    }
+
+    // Read each keyframe.
+    *keyframes = initKeyframes(&run, counts[0], counts[1]);
+    int read = keyframes->frames != NULL;
+    for (int frame = 0; frame < counts[1] && read; ++frame) {
+        read = fread(&keyframes->steps[frame], sizeof(int32_t), 1, infile) == 1 && fread(&keyframes->x[frame], sizeof(float), 1, infile) == 1 &&
+               fread(&keyframes->frames[(size_t) frame * keyframes->frameSize], sizeof(float), keyframes->frameSize, infile) == (size_t) keyframes->frameSize;
+        keyframes->count += read;
+    }
+    fclose(infile);
+
+    if (!read) {
+        freeKeyframes(keyframes);
+    }
+    return read;
+}
+
+void freeKeyframes(Keyframes *keyframes) {
+    // Free the step, x, and frame arrays.
+    free(keyframes->steps);
+    free(keyframes->x);
+    free(keyframes->frames);
+}
@@ -0,0 +1,158 @@
+/**
+ * @file keyframes.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that keeps the whole state of a run every few steps, so any window of the run can
+ * later be integrated again from the keyframe before it.
+ * @version 0.1
+ * @date 2022-10-18
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef KEYFRAMES
+#define KEYFRAMES
+
+#include <stdint.h>
+
+#define KEYFRAME_MAGIC "NSK2"   // The first bytes of a keyframe file.
+
+/**
+ * @brief A run structure which describes everything a replay must share with the run for its steps to match.
+ */
+typedef struct {
+    /**
+     * @brief The number of neurons and of functions of each neuron.
+     */
+    int32_t neuronCount, funcCount;
+
+    /**
+     * @brief The numerical method and its number of micro-steps per macro-step.
+     */
+    int32_t method, ratio;
+
+    /**
+     * @brief The number of steps planned.
+     */
+    int32_t stepCount;
+
+    /**
+     * @brief The number of steps between keyframes.
+     */
+    int32_t interval;
+
+    /**
+     * @brief The starting x position and the size of each step.
+     */
+    float x0, step;
+
+    /**
+     * @brief The voltage a neuron must reach to take multirate micro-steps.
+     */
+    float activityThreshold;
+
+    /**
+     * @brief The strength and seed of the noise (0 without noise).
+     */
+    float noiseStrength;
+    uint64_t noiseSeed;
+
+    /**
+     * @brief A hash of the weights (or lattice), the initial values and their spread, and the transient.
+     */
+    uint64_t conditions;
+} KeyframeRun;
+
+/**
+ * @brief A keyframes structure which holds the state of a run at every interval steps.
+ */
+typedef struct {
+    /**
+     * @brief The run the keyframes were taken from (interval is 0 when no keyframes are kept).
+     */
+    KeyframeRun run;
+
+    /**
+     * @brief The number of values in each frame (the state, followed by whatever else the method carries between steps).
+     */
+    int frameSize;
+
+    /**
+     * @brief The number of keyframes taken and the number there is room for.
+     */
+    int count, capacity;
+
+    /**
+     * @brief The step of each keyframe. Access using steps[frameNum].
+     */
+    int32_t *steps;
+
+    /**
+     * @brief The x position of each keyframe. Access using x[frameNum].
+     */
+    float *x;
+
+    /**
+     * @brief The values of each keyframe. Access using frames[frameNum * frameSize + valueNum].
+     */
+    float *frames;
+} Keyframes;
+
+/**
+ * @brief Initializes and allocates memory for a keyframes structure.
+ *
+ * @param run the run the keyframes are taken from.
+ * @param frameSize the number of values in each frame.
+ * @param expected the number of keyframes expected (more are made room for as needed).
+ * @return Keyframes - the initialized keyframes structure (NULL arrays if memory could not be allocated).
+ */
+Keyframes initKeyframes(const KeyframeRun *run, int frameSize, int expected);
+
+/**
+ * @brief Takes a keyframe.
+ *
+ * @param keyframes the keyframes.
+ * @param step the step of the keyframe.
+ * @param x the x position of the step.
+ * @param state the first values of the frame.
+ * @param stateSize the number of values in state.
+ * @param extra the remaining frameSize - stateSize values of the frame (NULL when there are none).
+ * @return int - 1 if the keyframe was taken, otherwise 0 (memory could not be allocated).
+ */
+int takeKeyframe(Keyframes *keyframes, int step, float x, const float state[], int stateSize, const float extra[]);
+
+/**
+ * @brief Finds the last keyframe at or before a step.
+ *
+ * @param keyframes the keyframes.
+ * @param step the step.
+ * @return int - the number of the keyframe (-1 if every keyframe is after the step).
+ */
+int findKeyframe(const Keyframes *keyframes, int step);
+
+/**
+ * @brief Writes keyframes to a binary file: the magic, the run, the frame size and count, then the step, x, and
+ * values of each keyframe.
+ *
+ * @param keyframes the keyframes.
+ * @param filename the name of the file to write to.
+ * @return int - 1 if the file was written, otherwise 0.
+ */
+int writeKeyframes(const Keyframes *keyframes, const char *filename);
+
+/**
+ * @brief Reads keyframes written by writeKeyframes().
+ *
+ * @param filename the name of the file to be read.
+ * @param keyframes where to store the keyframes (free with freeKeyframes()).
+ * @return int - 1 if the file was read, otherwise 0.
+ */
+int readKeyframes(const char *filename, Keyframes *keyframes);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a keyframes structure.
+ *
+ * @param keyframes the keyframes to be freed.
+ */
+void freeKeyframes(Keyframes *keyframes);
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * @file monitor.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the monitor header file.
+ * @version 0.1
+ * @date 2022-10-16
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "monitor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BLOWUP_VOLTAGE 100.0    // The voltage no neuron of the model reaches unless the approximation has diverged.
+
+/**
+ * @brief Gets the wall time of a monotonic clock.
+ *
+ * @return double - the time in seconds.
+ */
+static double getMonotonicTime(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1000000000.0;
+}
+
+/**
+ * @brief Gets the name of a shared memory object, adding the leading slash if it is missing.
+ *
+ * @param name the name.
+ * @return char* - the name with its slash (free with free()), or NULL if memory could not be allocated.
+ */
+static char *getObjectName(const char *name) {
+    char *objectName;
+    if ((objectName = (char *) malloc(strlen(name) + 2)) == NULL) {
+        return NULL;
+    }
+    sprintf(objectName, "%s%s", name[0] == '/' ? "" : "/", name);
+    return objectName;
+}
+
+/**
+ * @brief Measures the state and writes it as the next sample of the ring.
+ *
+ * @param monitor the monitor.
+ * @param step the number of the completed step.
+ * @param curX the x position of the step.
+ * @param neuronCount the number of neurons.
+ * @param state the value of each function for every neuron. Access using state[functionNum][neuronNum].
+ * @param funcCount the number of functions of each neuron.
+ * @param spikes the spikes found so far for each neuron (NULL when spikes are not being found).
+ */
+static void writeSample(Monitor *monitor, int step, float curX, int neuronCount, float state[][neuronCount], int funcCount, const Points *spikes) {
+    // Raise the flags of a diverged approximation and measure the spread of the voltages.
+    double sum = 0.0, squares = 0.0;
+    for (int func = 0; func < funcCount; ++func) {
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            if (!isfinite(state[func][neuron])) {
+                monitor->flags |= MONITOR_NAN;
+            }
+        }
+    }
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        float voltage = state[0][neuron];
+        if (fabsf(voltage) > BLOWUP_VOLTAGE) {
+            monitor->flags |= MONITOR_BLOWUP;
+        }
+        sum += voltage;
+        squares += (double) voltage * voltage;
+    }
+    double mean = sum / neuronCount, variance = squares / neuronCount - mean * mean;
+
+    // Count the spikes so far.
+    int64_t spikeCount = spikes != NULL ? 0 : -1;
+    for (int neuron = 0; spikes != NULL && neuron < neuronCount; ++neuron) {
+        spikeCount += spikes[neuron].size;
+    }
+
+    // Measure the speed since the previous sample.
+    double now = getMonotonicTime();
+    float stepsPerSecond = now > monitor->lastTime ? (step - monitor->lastStep) / (now - monitor->lastTime) : 0.0;
+    monitor->lastStep = step;
+    monitor->lastTime = now;
+
+    // Mark the slot as being written, fill it, then mark it written and count it.
+    MonitorRing *ring = monitor->ring;
+    uint64_t index = atomic_load_explicit(&ring->published, memory_order_relaxed);
+    MonitorSample *sample = &ring->samples[index % ring->capacity];
+    atomic_store_explicit(&sample->sequence, 2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    sample->step = step;
+    sample->x = curX;
+    sample->stepsPerSecond = stepsPerSecond;
+    sample->syncError = variance > 0.0 ? sqrt(variance) : 0.0;
+    sample->spikeCount = spikeCount;
+    sample->flags = monitor->flags;
+    atomic_store_explicit(&sample->sequence, 2 * index + 2, memory_order_release);
+    atomic_store_explicit(&ring->published, index + 1, memory_order_release);
+}
+
+Monitor initMonitor(MonitorParams *params, int neuronCount, int stepCount, float x0, float xEnd) {
+    Monitor monitor = {
+        .size = sizeof(MonitorRing) + (size_t) params->capacity * sizeof(MonitorSample),
+        .name = getObjectName(params->name),
+        .interval = params->interval,
+        .nextStep = params->interval,
+        .lastStep = 0,
+        .lastTime = getMonotonicTime(),
+        .flags = 0,
+        .ring = NULL
+    };
+
+    // Create the shared memory object and map it.
+    int fd;
+    if (monitor.name == NULL || (fd = shm_open(monitor.name, O_CREAT | O_RDWR | O_TRUNC, 0644)) < 0) {
+        free(monitor.name);
+        monitor.name = NULL;
+        return monitor;
+    }
+    void *memory;
+    if (ftruncate(fd, monitor.size) != 0 || (memory = mmap(NULL, monitor.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        close(fd);
+        shm_unlink(monitor.name);
+        free(monitor.name);
+        monitor.name = NULL;
+        return monitor;
+    }
+    monitor.ring = (MonitorRing *) memory;
+    close(fd);
+
+    // Fill in the header (the new object is zeroed, so no sample is published yet).
+    monitor.ring->capacity = params->capacity;
+    monitor.ring->neuronCount = neuronCount;
+    monitor.ring->stepCount = stepCount;
+    monitor.ring->x0 = x0;
+    monitor.ring->xEnd = xEnd;
+    monitor.ring->pid = getpid();
+    atomic_thread_fence(memory_order_release);
+    memcpy(monitor.ring->magic, MONITOR_MAGIC, 4);
+
+    return monitor;
+}
+
+void publishProgress(Monitor *monitor, int step, float curX, int neuronCount, float state[][neuronCount], int funcCount, const Points *spikes, int finished) {
+    if (finished) {
+        monitor->flags |= MONITOR_FINISHED;
+    }
+    writeSample(monitor, step, curX, neuronCount, state, funcCount, spikes);
+    while (monitor->nextStep <= step) {
+        monitor->nextStep += monitor->interval;
+    }
+}
+
+const MonitorRing *attachMonitor(const char *name, size_t *size) {
+    char *objectName = getObjectName(name);
+    if (objectName == NULL) {
+        return NULL;
+    }
+    int fd = shm_open(objectName, O_RDONLY, 0);
+    free(objectName);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    // Map the whole ring once its size is known.
+    struct stat info;
+    const MonitorRing *ring = NULL;
+    if (fstat(fd, &info) == 0 && (size_t) info.st_size >= sizeof(MonitorRing)) {
+        if ((ring = (const MonitorRing *) mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+            ring = NULL;
+        }
+        *size = info.st_size;
+    }
+    close(fd);
+
+    // Reject objects that are not rings or are still being set up.
+    if (ring != NULL && (memcmp(ring->magic, MONITOR_MAGIC, 4) != 0 ||
+        sizeof(MonitorRing) + (size_t) ring->capacity * sizeof(MonitorSample) > *size)) {
+        munmap((void *) ring, *size);
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return ring;
+}
+
+int readMonitorSample(const MonitorRing *ring, uint64_t index, MonitorSample *sample) {
+    const MonitorSample *slot = &ring->samples[index % ring->capacity];
+    uint64_t before = atomic_load_explicit((_Atomic uint64_t *) &slot->sequence, memory_order_acquire);
+    if (before != 2 * index + 2) {
+        return 0;
+    }
+
+    // Copy the sample, then check the writer did not start on the slot meanwhile.
+    sample->step = slot->step;
+    sample->x = slot->x;
+    sample->stepsPerSecond = slot->stepsPerSecond;
+    sample->syncError = slot->syncError;
+    sample->spikeCount = slot->spikeCount;
+    sample->flags = slot->flags;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit((_Atomic uint64_t *) &slot->sequence, memory_order_relaxed) == before;
+}
+
+void detachMonitor(const MonitorRing *ring, size_t size) {
+    munmap((void *) ring, size);
+}
+
+void freeMonitor(Monitor *monitor, int step, float curX, int neuronCount, float state[][neuronCount], int funcCount, const Points *spikes) {
+    // Publish the final sample unless it already was, then remove the name (attached viewers keep their mappings).
+    if (!(monitor->flags & MONITOR_FINISHED)) {
+        publishProgress(monitor, step, curX, neuronCount, state, funcCount, spikes, 1);
+    }
+    munmap(monitor->ring, monitor->size);
+    shm_unlink(monitor->name);
+    free(monitor->name);
+    monitor->ring = NULL;
+}
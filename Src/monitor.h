@@ -0,0 +1,230 @@
+/**
+ * @file monitor.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that publishes the progress of a running simulation through a ring buffer in shared
+ * memory, so another process can watch it without the simulation writing any logs.
+ * @version 0.1
+ * @date 2022-10-16
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef MONITOR
+#define MONITOR
+
+#include "spike_calculations.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define MONITOR_MAGIC "NSM1"        // The first bytes of a monitor ring.
+#define MONITOR_NAN 0x1             // A function of some neuron is not a number or infinite.
+#define MONITOR_BLOWUP 0x2          // The voltage of some neuron has left the range the model ever reaches.
+#define MONITOR_FINISHED 0x4        // The simulation has finished and publishes nothing more.
+
+/**
+ * @brief A parameters structure which describes how often and where the progress is published.
+ */
+typedef struct {
+    /**
+     * @brief The name of the shared memory object (such as /neurosync).
+     */
+    const char *name;
+
+    /**
+     * @brief The number of steps between samples.
+     */
+    int interval;
+
+    /**
+     * @brief The number of samples the ring holds before the oldest is overwritten.
+     */
+    int capacity;
+} MonitorParams;
+
+/**
+ * @brief A sample structure which holds the progress of a simulation at one step.
+ */
+typedef struct {
+    /**
+     * @brief Twice the number of the sample plus 2 once written, and odd while being written (so readers can tell a
+     * torn or overwritten sample).
+     */
+    _Atomic uint64_t sequence;
+
+    /**
+     * @brief The step and x position of the sample.
+     */
+    int32_t step;
+    float x;
+
+    /**
+     * @brief The steps taken per second of wall time since the previous sample.
+     */
+    float stepsPerSecond;
+
+    /**
+     * @brief The synchronization error (standard deviation of the voltages) at the sample.
+     */
+    float syncError;
+
+    /**
+     * @brief The spikes found so far across every neuron (-1 when spikes are not being found).
+     */
+    int64_t spikeCount;
+
+    /**
+     * @brief The MONITOR_* flags raised so far.
+     */
+    int32_t flags;
+} MonitorSample;
+
+/**
+ * @brief A ring structure which is laid out in shared memory, followed by its samples.
+ */
+typedef struct {
+    /**
+     * @brief The magic bytes (MONITOR_MAGIC).
+     */
+    char magic[4];
+
+    /**
+     * @brief The number of samples in the ring.
+     */
+    int32_t capacity;
+
+    /**
+     * @brief The number of neurons and the number of steps planned.
+     */
+    int32_t neuronCount, stepCount;
+
+    /**
+     * @brief The starting and final x positions.
+     */
+    float x0, xEnd;
+
+    /**
+     * @brief The process running the simulation.
+     */
+    int32_t pid;
+
+    /**
+     * @brief The number of samples published so far. Sample i is in samples[i % capacity].
+     */
+    _Atomic uint64_t published;
+
+    /**
+     * @brief The samples.
+     */
+    MonitorSample samples[];
+} MonitorRing;
+
+/**
+ * @brief A monitor structure which publishes the progress of one simulation.
+ */
+typedef struct {
+    /**
+     * @brief The mapped ring (NULL when the simulation is not monitored).
+     */
+    MonitorRing *ring;
+
+    /**
+     * @brief The size of the mapping in bytes.
+     */
+    size_t size;
+
+    /**
+     * @brief The name of the shared memory object, removed when the monitor is freed.
+     */
+    char *name;
+
+    /**
+     * @brief The number of steps between samples.
+     */
+    int interval;
+
+    /**
+     * @brief The step at which the next sample is published.
+     */
+    int nextStep;
+
+    /**
+     * @brief The step and wall time of the previous sample.
+     */
+    int lastStep;
+    double lastTime;
+
+    /**
+     * @brief The MONITOR_* flags raised so far.
+     */
+    int flags;
+} Monitor;
+
+/**
+ * @brief Creates the shared memory ring of a simulation.
+ *
+ * @param params the monitor parameters.
+ * @param neuronCount the number of neurons.
+ * @param stepCount the number of steps planned.
+ * @param x0 the starting x position.
+ * @param xEnd the final x position.
+ * @return Monitor - the initialized monitor structure (a NULL ring if the ring could not be created).
+ */
+Monitor initMonitor(MonitorParams *params, int neuronCount, int stepCount, float x0, float xEnd);
+
+/**
+ * @brief Publishes a sample of the current state.
+ *
+ * @param monitor the monitor.
+ * @param step the number of the completed step.
+ * @param curX the x position of the step.
+ * @param neuronCount the number of neurons.
+ * @param state the value of each function for every neuron. Access using state[functionNum][neuronNum].
+ * @param funcCount the number of functions of each neuron.
+ * @param spikes the spikes found so far for each neuron (NULL when spikes are not being found).
+ * @param finished whether this is the final step of the simulation.
+ */
+void publishProgress(Monitor *monitor, int step, float curX, int neuronCount, float state[][neuronCount], int funcCount, const Points *spikes, int finished);
+
+/**
+ * @brief Attaches to the ring of a running simulation for reading.
+ *
+ * @param name the name of the shared memory object.
+ * @param size where to store the size of the mapping.
+ * @return const MonitorRing* - the mapped ring (NULL if there is no such ring).
+ */
+const MonitorRing *attachMonitor(const char *name, size_t *size);
+
+/**
+ * @brief Copies a sample out of a ring, checking it was not being written or overwritten meanwhile.
+ *
+ * @param ring the ring.
+ * @param index the number of the sample.
+ * @param sample where to store the sample.
+ * @return int - 1 if the sample was read whole, otherwise 0.
+ */
+int readMonitorSample(const MonitorRing *ring, uint64_t index, MonitorSample *sample);
+
+/**
+ * @brief Detaches from a ring.
+ *
+ * @param ring the ring.
+ * @param size the size of the mapping.
+ */
+void detachMonitor(const MonitorRing *ring, size_t size);
+
+/**
+ * @brief Publishes the final sample if it was not yet, then unmaps and removes the ring (an attached viewer keeps its mapping).
+ *
+ * @param monitor the monitor to be freed.
+ * @param step the number of the final step.
+ * @param curX the x position of the final step.
+ * @param neuronCount the number of neurons.
+ * @param state the value of each function for every neuron. Access using state[functionNum][neuronNum].
+ * @param funcCount the number of functions of each neuron.
+ * @param spikes the spikes found for each neuron (NULL when spikes were not found).
+ */
+void freeMonitor(Monitor *monitor, int step, float curX, int neuronCount, float state[][neuronCount], int funcCount, const Points *spikes);
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file monitor_viewer.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Driver for watching the progress of a running simulation.
+ * @version 0.1
+ * @date 2022-10-16
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "monitor_viewer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_NAME "neurosync"    // The default shared memory object.
+#define DEFAULT_PERIOD 1.0          // The default seconds between polls.
+
+int main(int argc, char *argv[]) {
+    myArgs args = getArgs(argc, argv);
+    struct timespec pause = {
+        .tv_sec = (time_t) args.period,
+        .tv_nsec = (long) ((args.period - (time_t) args.period) * 1000000000.0)
+    };
+
+    // Attach to the ring, waiting for the simulation to create it if requested.
+    const MonitorRing *ring;
+    size_t size;
+    float waited = 0.0;
+    while ((ring = attachMonitor(args.name, &size)) == NULL) {
+        if (waited >= args.wait) {
+            fprintf(stderr, "No simulation is publishing to %s, exiting ...\n", args.name);
+            exit(EXIT_FAILURE);
+        }
+        nanosleep(&pause, NULL);
+        waited += args.period;
+    }
+    printf("Watching process %d: %d neurons, %d steps from x = %g to %g\n", ring->pid, ring->neuronCount, ring->stepCount, ring->x0, ring->xEnd);
+
+    // Print each new sample until the simulation finishes or disappears.
+    uint64_t next = 0;
+    int flags = 0, stopped = 0;
+    while (!(flags & MONITOR_FINISHED)) {
+        uint64_t published = atomic_load_explicit((_Atomic uint64_t *) &ring->published, memory_order_acquire);
+        if (args.once || published - next > (uint64_t) ring->capacity) {
+            next = published > 0 ? published - 1 : 0;
+        }
+        for (MonitorSample sample; next < published; ++next) {
+            if (readMonitorSample(ring, next, &sample)) {
+                printSample(ring, &sample);
+                flags = sample.flags;
+            }
+        }
+        if (args.once) {
+            break;
+        }
+        if (!(flags & MONITOR_FINISHED) && kill(ring->pid, 0) != 0 && errno == ESRCH) {
+            fprintf(stderr, "The simulation stopped without finishing\n");
+            stopped = 1;
+            break;
+        }
+        if (!(flags & MONITOR_FINISHED)) {
+            nanosleep(&pause, NULL);
+        }
+    }
+
+    detachMonitor(ring, size);
+    exit(stopped || flags & (MONITOR_NAN | MONITOR_BLOWUP) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+myArgs getArgs(int argc, char *argv[]) {
+    myArgs args = {
+        .name = DEFAULT_NAME,
+        .period = DEFAULT_PERIOD,
+        .wait = 0.0,
+        .once = 0
+    };
+
+    // Get the options.
+    int opt;
+    while ((opt = getopt(argc, argv, "p:w:o")) != -1) {
+        switch (opt) {
+            case 'p':
+                if ((args.period = strtod(optarg, NULL)) <= 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'w':
+                if ((args.wait = strtod(optarg, NULL)) < 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'o':
+                args.once = 1;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    // Get the name.
+    if (argc - optind > 1) {
+        usage(argv[0]);
+    }
+    if (argc - optind == 1) {
+        args.name = argv[optind];
+    }
+
+    return args;
+}
+
+void printSample(const MonitorRing *ring, const MonitorSample *sample) {
+    printf("x = %-10.2f step %d/%d (%5.1f%%)  %10.0f steps/s  sync error %-8.4f", sample->x, sample->step, ring->stepCount,
+           ring->stepCount > 0 ? 100.0 * sample->step / ring->stepCount : 100.0, sample->stepsPerSecond, sample->syncError);
+    if (sample->spikeCount >= 0) {
+        printf("  %lld spikes", (long long) sample->spikeCount);
+    }
+    if (sample->flags & MONITOR_NAN) {
+        printf("  NaN");
+    }
+    if (sample->flags & MONITOR_BLOWUP) {
+        printf("  BLOW-UP");
+    }
+    if (sample->flags & MONITOR_FINISHED) {
+        printf("  finished");
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+void usage(const char *prog_name) {
+    fprintf(stderr, "\nUsage: %s [options] [shared memory name (default %s)]\n", prog_name, DEFAULT_NAME);
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "\t-p [seconds]\tthe seconds between polls (default %g)\n", DEFAULT_PERIOD);
+    fprintf(stderr, "\t-w [seconds]\thow long to wait for the simulation to start publishing (default 0)\n");
+    fprintf(stderr, "\t-o\t\tprint the latest sample and exit\n\n");
+    exit(EXIT_FAILURE);
+}
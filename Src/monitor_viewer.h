@@ -0,0 +1,75 @@
+/**
+ * @file monitor_viewer.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that attaches to the shared memory ring of a running simulation and prints its
+ * progress as it is published.
+ * @version 0.1
+ * @date 2022-10-16
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef MONITOR_VIEWER
+#define MONITOR_VIEWER
+
+#include "monitor.h"
+
+/**
+ * @brief A structure to capture all necessary command-line arguments.
+ */
+typedef struct {
+    /**
+     * @brief The name of the shared memory object the simulation publishes to.
+     */
+    char *name;
+
+    /**
+     * @brief The seconds between polls of the ring.
+     */
+    float period;
+
+    /**
+     * @brief The seconds to wait for the simulation to start publishing.
+     */
+    float wait;
+
+    /**
+     * @brief Whether to print only the latest sample and exit.
+     */
+    int once;
+} myArgs;
+
+/**
+ * @brief Watches a running simulation.
+ *
+ * @param argc the command-line argument count.
+ * @param argv the command-line argument values.
+ * @return int - 0 once the simulation finishes cleanly, otherwise 1.
+ */
+int main(int argc, char *argv[]);
+
+/**
+ * @brief Get the command-line arguments.
+ *
+ * @param argc the number of arguments.
+ * @param argv the array of arguments.
+ * @return myArgs - the command line arguments in their correct data types.
+ */
+myArgs getArgs(int, char *[]);
+
+/**
+ * @brief Prints one progress sample.
+ *
+ * @param ring the ring the sample was read from.
+ * @param sample the sample.
+ */
+void printSample(const MonitorRing *ring, const MonitorSample *sample);
+
+/**
+ * @brief Prints a message to stderr explaining how to run the program.
+ *
+ * @param prog_name the name of the executable file.
+ */
+void usage(const char *);
+
+#endif
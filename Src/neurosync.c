@@ -0,0 +1,1217 @@
+/**
+ * @file neurosync.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the neurosync header file.
+ * @version 0.1
+ * @date 2022-09-26
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "neurosync.h"
+#include "differential_equations.h"
+#include "components.h"
+#include "result_cache.h"
+#include "raster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/**
+ * @brief A simulation structure which owns everything a run needs, so runs share no state.
+ */
+struct NsSimulation {
+    /**
+     * @brief The graph, whose rows point into the caller's adjacency matrix.
+     */
+    Graph graph;
+
+    /**
+     * @brief The conditions of the approximation (pointing at the copies below).
+     */
+    EqConditions cond;
+
+    /**
+     * @brief The copied convergence criteria.
+     */
+    ConvergenceCriteria convergence;
+
+    /**
+     * @brief The copied synapse parameters.
+     */
+    SynapseParams synapses;
+
+    /**
+     * @brief The copied noise parameters.
+     */
+    NoiseParams noise;
+
+    /**
+     * @brief The copied plasticity parameters.
+     */
+    PlasticityParams plasticity;
+
+    /**
+     * @brief The copied lattice.
+     */
+    StencilParams stencil;
+
+    /**
+     * @brief The copied monitor parameters (the name is copied when the integrator creates the ring).
+     */
+    MonitorParams monitor;
+
+    /**
+     * @brief The copied record specification (with its own neurons array).
+     */
+    RecordSpec record;
+
+    /**
+     * @brief The global numbers of the neurons when simulating one component of a larger graph.
+     */
+    NeuronIds ids;
+
+    /**
+     * @brief The scratch memory of the integrator when the caller gives none.
+     */
+    Workspace workspace;
+
+    /**
+     * @brief The approximation in progress.
+     */
+    Integrator integ;
+};
+
+/**
+ * @brief Checks the parameters of a simulation.
+ *
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the simulation.
+ * @return NsStatus - NS_OK, or NS_ERROR_ARGUMENT if a parameter is invalid.
+ */
+static NsStatus checkParams(int neuronCount, const NsParams *params) {
+    // Check the bounds and method.
+    if (!(params->step > 0.0) || !(params->xEnd > params->x0)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->method != METHOD_RK4 && params->method != METHOD_MULTIRATE && params->method != METHOD_ETD) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if ((params->method == METHOD_MULTIRATE && params->ratio < 1) || (params->synapses != NULL && params->method != METHOD_RK4)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->threads < 1 || (params->threads > 1 && (params->method != METHOD_RK4 || params->synapses != NULL))) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->plasticity != NULL && (params->method == METHOD_MULTIRATE || params->synapses != NULL || params->threads > 1)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    const PlasticityParams *plasticity = params->plasticity;
+    if (plasticity != NULL && (!(plasticity->tauPlus > 0.0) || !(plasticity->tauMinus > 0.0) || !(plasticity->maxWeight > 0.0) ||
+        !(plasticity->potentiation >= 0.0) || !(plasticity->depression >= 0.0) || !(plasticity->snapshotInterval >= 0.0))) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->monitor != NULL && (params->monitor->name == NULL || params->monitor->name[0] == '\0' ||
+        params->monitor->interval < 1 || params->monitor->capacity < 1)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->synapses != NULL && !(params->synapses->decay > 0.0)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->convergence != NULL && !(params->convergence->window > 0.0)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->noise != NULL && (!(params->noise->strength >= 0.0) || !(params->noise->spread >= 0.0))) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (params->stencil != NULL && (getStencilCellCount(params->stencil) != neuronCount || params->synapses != NULL || params->plasticity != NULL)) {
+        return NS_ERROR_ARGUMENT;
+    }
+
+    // Check the record specification selects existing functions and neurons in ascending order.
+    RecordSpec *record = params->record;
+    if (record != NULL) {
+        if (record->funcMask & ~((1 << NS_FUNC_COUNT) - 1) || record->stride < 1 || !(record->quantum >= 0.0)) {
+            return NS_ERROR_ARGUMENT;
+        }
+        if (record->keyframeInterval < 0 || (record->keyframeInterval > 0 && (params->synapses != NULL || params->plasticity != NULL ||
+            (params->method == METHOD_MULTIRATE && record->keyframeInterval % params->ratio != 0)))) {
+            return NS_ERROR_ARGUMENT;
+        }
+        for (int i = 0; record->neurons != NULL && i < record->neuronCount; ++i) {
+            if (record->neurons[i] < 0 || record->neurons[i] >= neuronCount || (i && record->neurons[i] <= record->neurons[i - 1])) {
+                return NS_ERROR_ARGUMENT;
+            }
+        }
+    }
+
+    return NS_OK;
+}
+
+void nsDefaultParams(NsParams *params) {
+    *params = (NsParams) {
+        .x0 = 0.0,
+        .xEnd = 1000.0,
+        .step = 0.1,
+        .transient = 500.0,
+        .inits = NULL,
+        .method = METHOD_RK4,
+        .ratio = 4,
+        .activityThreshold = -1.0,
+        .threads = 1,
+        .convergence = NULL,
+        .synapses = NULL,
+        .noise = NULL,
+        .plasticity = NULL,
+        .monitor = NULL,
+        .record = NULL,
+        .stencil = NULL,
+        .workspace = NULL
+    };
+}
+
+NsStatus nsReadGraph(char *filename, float **weights, int *neuronCount) {
+    if (filename == NULL || weights == NULL || neuronCount == NULL) {
+        return NS_ERROR_ARGUMENT;
+    }
+
+    // Load the graph.
+    Graph graph;
+    switch (loadGraph(filename, &graph)) {
+        case GRAPH_ERROR_OPEN:
+            return NS_ERROR_GRAPH_OPEN;
+        case GRAPH_ERROR_FORMAT:
+            return NS_ERROR_GRAPH_FORMAT;
+        case GRAPH_ERROR_MEMORY:
+            return NS_ERROR_MEMORY;
+        default:
+            break;
+    }
+
+    // Copy the rows into one row-major matrix.
+    size_t rowBytes = graph.vertexCount * sizeof(float);
+    if ((*weights = (float *) malloc(graph.vertexCount * rowBytes)) == NULL) {
+        freeGraph(&graph);
+        return NS_ERROR_MEMORY;
+    }
+    for (int row = 0; row < graph.vertexCount; ++row) {
+        memcpy(*weights + (size_t) row * graph.vertexCount, graph.adjMatrix[row], rowBytes);
+    }
+    *neuronCount = graph.vertexCount;
+
+    freeGraph(&graph);
+    return NS_OK;
+}
+
+void nsFreeWeights(float *weights) {
+    free(weights);
+}
+
+/**
+ * @brief Creates a simulation from checked parameters.
+ *
+ * @param weights the row-major adjacency matrix. Access using weights[row * neuronCount + column].
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the simulation.
+ * @param ids the global numbers of the neurons (NULL when the simulation is the whole graph).
+ * @param simulation where to store the handle of the created simulation.
+ * @return NsStatus - NS_OK, or NS_ERROR_MEMORY if the simulation could not be allocated.
+ */
+static NsStatus createSimulation(float *weights, int neuronCount, const NsParams *params, const NeuronIds *ids, NsSimulation **simulation) {
+    // Allocate the simulation and point the rows of the graph into the adjacency matrix (a lattice has no rows).
+    NsSimulation *sim;
+    if ((sim = (NsSimulation *) calloc(1, sizeof(NsSimulation))) == NULL) {
+        return NS_ERROR_MEMORY;
+    }
+    sim->graph.vertexCount = neuronCount;
+    if (params->stencil == NULL && (sim->graph.adjMatrix = (float **) malloc(neuronCount * sizeof(float *))) == NULL) {
+        free(sim);
+        return NS_ERROR_MEMORY;
+    }
+    for (int row = 0; row < neuronCount && params->stencil == NULL; ++row) {
+        sim->graph.adjMatrix[row] = weights + (size_t) row * neuronCount;
+    }
+
+    // Copy the parameters.
+    sim->cond = initEqConditions(params->x0, params->xEnd, params->step, params->transient, NS_FUNC_COUNT);
+    if (sim->cond.inits == NULL) {
+        nsDestroy(sim);
+        return NS_ERROR_MEMORY;
+    }
+    for (int func = 0; func < NS_FUNC_COUNT && params->inits != NULL; ++func) {
+        sim->cond.inits[func] = params->inits[func];
+    }
+    if (params->convergence != NULL) {
+        sim->convergence = *params->convergence;
+        sim->cond.convergence = &sim->convergence;
+    }
+    if (params->synapses != NULL) {
+        sim->synapses = *params->synapses;
+        sim->cond.synapses = &sim->synapses;
+    }
+    if (params->stencil != NULL) {
+        sim->stencil = *params->stencil;
+        sim->cond.stencil = &sim->stencil;
+    }
+    if (params->noise != NULL) {
+        sim->noise = *params->noise;
+        sim->cond.noise = &sim->noise;
+    }
+    if (params->plasticity != NULL) {
+        sim->plasticity = *params->plasticity;
+        sim->cond.plasticity = &sim->plasticity;
+    }
+    if (params->monitor != NULL) {
+        sim->monitor = *params->monitor;
+        sim->cond.monitor = &sim->monitor;
+    }
+    if (params->record != NULL) {
+        sim->record = *params->record;
+        if (params->record->neurons != NULL) {
+            if ((sim->record.neurons = (int *) malloc((params->record->neuronCount ? params->record->neuronCount : 1) * sizeof(int))) == NULL) {
+                nsDestroy(sim);
+                return NS_ERROR_MEMORY;
+            }
+            memcpy(sim->record.neurons, params->record->neurons, params->record->neuronCount * sizeof(int));
+        }
+        sim->cond.record = &sim->record;
+    }
+    if (ids != NULL) {
+        sim->ids = *ids;
+        sim->cond.ids = &sim->ids;
+    }
+    sim->workspace = initWorkspace();
+    sim->cond.workspace = params->workspace != NULL ? params->workspace : &sim->workspace;
+
+    // Start the approximation.
+    sim->integ = initIntegrator(params->method, &getHR, &getHRLinear, &sim->cond, &sim->graph, NS_FUNC_COUNT, params->ratio, params->activityThreshold, params->threads);
+    if (sim->integ.sol.x == NULL) {
+        sim->integ.cond = NULL;
+        nsDestroy(sim);
+        return NS_ERROR_MEMORY;
+    }
+
+    *simulation = sim;
+    return NS_OK;
+}
+
+NsStatus nsCreate(float *weights, int neuronCount, const NsParams *params, NsSimulation **simulation) {
+    if (neuronCount < 1 || params == NULL || simulation == NULL || (weights == NULL && params->stencil == NULL)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    NsStatus status = checkParams(neuronCount, params);
+    if (status != NS_OK) {
+        return status;
+    }
+    return createSimulation(weights, neuronCount, params, NULL, simulation);
+}
+
+NsStatus nsStep(NsSimulation *simulation, int steps, int *taken) {
+    if (simulation == NULL || steps < 0) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (simulation->integ.recorder.failed) {
+        return NS_ERROR_MEMORY;
+    }
+    if (isIntegratorFinished(&simulation->integ)) {
+        return NS_ERROR_FINISHED;
+    }
+
+    int count = advanceIntegrator(&simulation->integ, steps);
+    if (taken != NULL) {
+        *taken = count;
+    }
+    return simulation->integ.recorder.failed ? NS_ERROR_MEMORY : NS_OK;
+}
+
+NsStatus nsRun(NsSimulation *simulation) {
+    if (simulation == NULL) {
+        return NS_ERROR_ARGUMENT;
+    }
+    return nsStep(simulation, simulation->integ.sol.stepCount, NULL);
+}
+
+int nsFinished(const NsSimulation *simulation) {
+    return simulation->integ.curStep >= simulation->integ.sol.stepCount;
+}
+
+int nsStepsTaken(const NsSimulation *simulation) {
+    return simulation->integ.curStep;
+}
+
+float nsCurrentX(const NsSimulation *simulation) {
+    return simulation->integ.sol.x[simulation->integ.curStep];
+}
+
+const float *nsState(const NsSimulation *simulation) {
+    return simulation->integ.state;
+}
+
+const Points *nsSpikes(const NsSimulation *simulation) {
+    return simulation->integ.sol.spikes;
+}
+
+const EqSolution *nsSolution(const NsSimulation *simulation) {
+    return &simulation->integ.sol;
+}
+
+NsStatus nsReadSamples(const NsSimulation *simulation, int record, int func, int first, int count, float samples[]) {
+    const EqSolution *sol = &simulation->integ.sol;
+    if (record < 0 || record >= sol->recordCount || func < 0 || func >= sol->funcCount || first < 0 || count < 0 ||
+        first + count > sol->sampleCount || samples == NULL) {
+        return NS_ERROR_ARGUMENT;
+    }
+
+    // Copy the samples, or decode them when compressed.
+    if (sol->approx[record][func] != NULL) {
+        memcpy(samples, sol->approx[record][func] + first, count * sizeof(float));
+    }
+    else if (sol->compressed != NULL && sol->compressed[record][func].quantum > 0.0) {
+        decodeTrajectory(&sol->compressed[record][func], first, count, samples);
+    }
+    else {
+        return NS_ERROR_ARGUMENT;
+    }
+
+    return NS_OK;
+}
+
+const Partition *nsPartition(const NsSimulation *simulation) {
+    return simulation->integ.pool != NULL ? &simulation->integ.partition : NULL;
+}
+
+const Plasticity *nsPlasticity(const NsSimulation *simulation) {
+    return simulation->integ.plasticity.graph != NULL ? &simulation->integ.plasticity : NULL;
+}
+
+/**
+ * @brief Compares two neuron numbers for bsearch().
+ *
+ * @param a the first neuron.
+ * @param b the second neuron.
+ * @return int - negative, zero, or positive as a is below, equal to, or above b.
+ */
+static int compareNeurons(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+/**
+ * @brief Writes the results of a simulation, numbering the files of each neuron by its global number.
+ *
+ * @param simulation the simulation.
+ * @param directory the directory to write the files into.
+ * @param outputs the outputs to write (NS_WRITE_* flags).
+ * @param ids the global number of each neuron of the simulation (NULL to number the neurons from 0).
+ * @param record the record specification whose neurons limit the stored approximations written (NULL to write all).
+ * @return NsStatus - NS_OK, NS_ERROR_IO if the directory or a file cannot be written to, NS_ERROR_MEMORY if memory
+ * could not be allocated, or NS_ERROR_ARGUMENT if spikes are missing.
+ */
+static NsStatus writeResults(const NsSimulation *simulation, const char *directory, int outputs, const int ids[], const RecordSpec *record) {
+    const EqSolution *sol = &simulation->integ.sol;
+    if (sol->spikes == NULL && outputs & (NS_WRITE_SPIKES | NS_WRITE_ISI | NS_WRITE_FREQS | NS_WRITE_RASTER)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (access(directory, W_OK) != 0) {
+        return NS_ERROR_IO;
+    }
+    float transient = simulation->cond.transient;
+    char filename[strlen(directory) + 32];
+
+    // Write the stored approximation of each neuron (x keeps its original name).
+    for (int rec = 0; rec < sol->recordCount && outputs & NS_WRITE_APPROX; ++rec) {
+        for (int func = 0; func < sol->funcCount; ++func) {
+            if (sol->approx[rec][func] == NULL && (sol->compressed == NULL || sol->compressed[rec][func].quantum == 0.0)) {
+                continue;
+            }
+            int number = ids != NULL ? ids[sol->neurons[rec]] : sol->neurons[rec];
+            if (record != NULL && record->neurons != NULL &&
+                bsearch(&number, record->neurons, record->neuronCount, sizeof(int), compareNeurons) == NULL) {
+                continue;
+            }
+            if (func == 0) {
+                sprintf(filename, "%s/approx%d", directory, number);
+            }
+            else {
+                sprintf(filename, "%s/approx%d_%d", directory, number, func);
+            }
+            int written = sol->compressed != NULL ? writeTrajectory(filename, sol->sampleX, &sol->compressed[rec][func], transient)
+                                                  : writeSolution(filename, sol->sampleX, sol->approx[rec][func], sol->sampleCount, transient);
+            if (!written) {
+                return NS_ERROR_IO;
+            }
+        }
+    }
+
+    for (int neuron = 0; neuron < sol->neuronCount && outputs & (NS_WRITE_SPIKES | NS_WRITE_ISI); ++neuron) {
+        int number = ids != NULL ? ids[neuron] : neuron;
+
+        // Write the neuron spikes.
+        if (outputs & NS_WRITE_SPIKES) {
+            sprintf(filename, "%s/spikes%d", directory, number);
+            if (!writePoints(filename, &sol->spikes[neuron])) {
+                return NS_ERROR_IO;
+            }
+        }
+
+        // Write the neuron inter-spike interval.
+        if (outputs & NS_WRITE_ISI) {
+            ISI isi = calcISI(&sol->spikes[neuron]);
+            if (isi.size < 0) {
+                return NS_ERROR_MEMORY;
+            }
+            sprintf(filename, "%s/ISI%d", directory, number);
+            int written = writeISI(filename, &isi);
+            freeISI(&isi);
+            if (!written) {
+                return NS_ERROR_IO;
+            }
+        }
+    }
+
+    if (outputs & NS_WRITE_FREQS) {
+        // Write the average frequency of each neuron.
+        float *avgFreqs;
+        if ((avgFreqs = (float *) malloc(sol->neuronCount * sizeof(float))) == NULL) {
+            return NS_ERROR_MEMORY;
+        }
+        float xEnd = sol->stopReason == STOP_END ? simulation->cond.xEnd : sol->x[simulation->integ.curStep];
+        for (int neuron = 0; neuron < sol->neuronCount; ++neuron) {
+            avgFreqs[neuron] = calcAvgFrequency(sol->spikes[neuron].size, transient, xEnd, 1000.0);
+        }
+        sprintf(filename, "%s/avg_freqs", directory);
+        int written = writeAvgFrequencies(filename, avgFreqs, sol->neuronCount);
+        free(avgFreqs);
+
+        // Write the s values of each neuron.
+        sprintf(filename, "%s/s_values", directory);
+        if (!written || !writeSs(filename, sol->neuronCount)) {
+            return NS_ERROR_IO;
+        }
+    }
+
+    // Write the spikes of every neuron to the raster.
+    if (outputs & NS_WRITE_RASTER) {
+        Raster raster = initRaster(sol->neuronCount, sol->x[0], simulation->cond.step, outputs & NS_WRITE_PEAKS ? RASTER_PEAKS : 0);
+        if (raster.neurons == NULL) {
+            return NS_ERROR_MEMORY;
+        }
+        for (int neuron = 0; neuron < sol->neuronCount; ++neuron) {
+            if (!addRasterPoints(&raster, neuron, &sol->spikes[neuron], sol->x, simulation->integ.curStep + 1)) {
+                freeRaster(&raster);
+                return NS_ERROR_MEMORY;
+            }
+        }
+        sprintf(filename, "%s/raster", directory);
+        int written = writeRaster(&raster, filename);
+        freeRaster(&raster);
+        if (!written) {
+            return NS_ERROR_IO;
+        }
+    }
+
+    // Write the weight snapshots of a plastic simulation.
+    if (outputs & NS_WRITE_WEIGHTS && simulation->integ.plasticity.graph != NULL) {
+        sprintf(filename, "%s/weights", directory);
+        if (!writeWeightSnapshots(&simulation->integ.plasticity, filename)) {
+            return NS_ERROR_IO;
+        }
+    }
+
+    // Write the keyframes of the simulation.
+    if (outputs & NS_WRITE_KEYFRAMES && simulation->integ.keyframes.run.interval > 0) {
+        sprintf(filename, "%s/keyframes", directory);
+        if (!writeKeyframes(&simulation->integ.keyframes, filename)) {
+            return NS_ERROR_IO;
+        }
+    }
+
+    return NS_OK;
+}
+
+NsStatus nsWriteResults(const NsSimulation *simulation, const char *directory, int outputs) {
+    return writeResults(simulation, directory, outputs, NULL, NULL);
+}
+
+/**
+ * @brief Checks if keyframes were taken from a simulation with the same parameters.
+ *
+ * @param keyframes the keyframes.
+ * @param integ the integrator of the simulation.
+ * @param params the parameters of the simulation.
+ * @return int - 1 if every parameter the steps depend on matches, otherwise 0.
+ */
+static int matchesKeyframes(const Keyframes *keyframes, const Integrator *integ, const NsParams *params) {
+    const KeyframeRun *run = &keyframes->run;
+    int neuronCount = integ->sol.neuronCount;
+
+    // The replay stores from x0, so the conditions are hashed with the transient of the simulation.
+    EqConditions cond = *integ->cond;
+    cond.transient = params->transient;
+    return run->conditions == hashConditions(&cond, integ->graph, integ->sol.funcCount) && run->neuronCount == neuronCount && run->funcCount == integ->sol.funcCount && run->method == (int32_t) integ->method &&
+           run->ratio == integ->ratio && run->stepCount == integ->sol.stepCount && run->interval > 0 && run->x0 == params->x0 &&
+           run->step == params->step && run->activityThreshold == (integ->method == METHOD_MULTIRATE ? params->activityThreshold : 0.0f) &&
+           run->noiseStrength == (params->noise != NULL ? params->noise->strength : 0.0f) && run->noiseSeed == (params->noise != NULL ? params->noise->seed : 0) &&
+           keyframes->frameSize == integ->sol.funcCount * neuronCount + (integ->method == METHOD_MULTIRATE ? neuronCount : 0) &&
+           keyframes->count > 0 && keyframes->steps[0] == 0;
+}
+
+NsStatus nsReplay(float *weights, int neuronCount, const NsParams *params, const char *keyframeFile, float start, float end, const char *directory, NsReplayStats *stats) {
+    if (neuronCount < 1 || params == NULL || keyframeFile == NULL || directory == NULL || !(end >= start) || (weights == NULL && params->stencil == NULL)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    NsStatus status = checkParams(neuronCount, params);
+    if (status != NS_OK) {
+        return status;
+    }
+    if (params->synapses != NULL || params->plasticity != NULL) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (access(directory, W_OK) != 0) {
+        return NS_ERROR_IO;
+    }
+    Keyframes keyframes;
+    if (!readKeyframes(keyframeFile, &keyframes)) {
+        return NS_ERROR_IO;
+    }
+
+    // Store every function of the recorded neurons at every step of the window, without stopping early, spikes, or a
+    // monitor (the transient is the start, so each sample is written with its own x).
+    NsParams replay = *params;
+    replay.transient = params->x0;
+    replay.convergence = NULL;
+    replay.monitor = NULL;
+    RecordSpec record = {
+        .funcMask = (1 << NS_FUNC_COUNT) - 1,
+        .neurons = params->record != NULL ? params->record->neurons : NULL,
+        .neuronCount = params->record != NULL ? params->record->neuronCount : 0,
+        .start = start,
+        .end = end,
+        .stride = 1,
+        .spikes = 0,
+        .quantum = 0.0,
+        .keyframeInterval = 0
+    };
+    replay.record = &record;
+
+    NsSimulation *sim = NULL;
+    if ((status = createSimulation(weights, neuronCount, &replay, NULL, &sim)) != NS_OK) {
+        freeKeyframes(&keyframes);
+        return status;
+    }
+    Integrator *integ = &sim->integ;
+    if (!matchesKeyframes(&keyframes, integ, params) || integ->sol.recordFirst > integ->sol.recordLast) {
+        freeKeyframes(&keyframes);
+        nsDestroy(sim);
+        return NS_ERROR_ARGUMENT;
+    }
+
+    // Resume from the last keyframe before the window and take the steps to its end in whole macro-steps.
+    int frame = findKeyframe(&keyframes, integ->sol.recordFirst);
+    resumeIntegrator(integ, &keyframes, frame);
+    int steps = integ->sol.recordLast - keyframes.steps[frame];
+    steps = (steps + integ->ratio - 1) / integ->ratio * integ->ratio;
+    int taken = steps > 0 ? advanceIntegrator(integ, steps) : 0;
+    if (stats != NULL) {
+        *stats = (NsReplayStats) {
+            .keyframeX = keyframes.x[frame],
+            .steps = taken
+        };
+    }
+    freeKeyframes(&keyframes);
+
+    status = integ->recorder.failed ? NS_ERROR_MEMORY : writeResults(sim, directory, NS_WRITE_APPROX, NULL, NULL);
+    nsDestroy(sim);
+    return status;
+}
+
+/**
+ * @brief Hashes everything the results of a run depend on into its cache key. The parameter structures are hashed
+ * whole, since none of them has padding.
+ *
+ * @param weights the row-major adjacency matrix (ignored with a stencil).
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the run.
+ * @param outputs the outputs written.
+ * @return uint64_t - the key.
+ */
+static uint64_t hashRun(const float *weights, int neuronCount, const NsParams *params, int outputs) {
+    const char *build = NS_VERSION " " __DATE__ " " __TIME__;
+    uint64_t hash = hashBytes(CACHE_HASH_START, build, strlen(build));
+    hash = hashBytes(hash, &neuronCount, sizeof(int));
+    hash = hashBytes(hash, &outputs, sizeof(int));
+
+    // The coupling.
+    if (params->stencil != NULL) {
+        hash = hashBytes(hash, params->stencil, sizeof(StencilParams));
+    }
+    else {
+        hash = hashBytes(hash, weights, (size_t) neuronCount * neuronCount * sizeof(float));
+    }
+
+    // The solver settings.
+    float settings[] = {params->x0, params->xEnd, params->step, params->transient, params->activityThreshold};
+    int method[] = {params->method, params->ratio};
+    hash = hashBytes(hash, settings, sizeof(settings));
+    hash = hashBytes(hash, method, sizeof(method));
+    if (params->inits != NULL) {
+        hash = hashBytes(hash, params->inits, NS_FUNC_COUNT * sizeof(float));
+    }
+
+    // The options, each preceded by whether it is used.
+    const void *options[] = {params->inits, params->convergence, params->synapses, params->noise, params->plasticity, params->record, params->stencil};
+    for (size_t i = 0; i < sizeof(options) / sizeof(options[0]); ++i) {
+        char used = options[i] != NULL;
+        hash = hashBytes(hash, &used, 1);
+    }
+    if (params->convergence != NULL) {
+        hash = hashBytes(hash, params->convergence, sizeof(ConvergenceCriteria));
+    }
+    if (params->synapses != NULL) {
+        hash = hashBytes(hash, params->synapses, sizeof(SynapseParams));
+    }
+    if (params->noise != NULL) {
+        hash = hashBytes(hash, params->noise, sizeof(NoiseParams));
+    }
+    if (params->plasticity != NULL) {
+        hash = hashBytes(hash, params->plasticity, sizeof(PlasticityParams));
+    }
+    if (params->record != NULL) {
+        const RecordSpec *record = params->record;
+        int counts[] = {record->funcMask, record->neuronCount, record->stride, record->spikes, record->keyframeInterval};
+        float values[] = {record->start, record->end, record->spikeThreshold, record->quantum};
+        hash = hashBytes(hash, counts, sizeof(counts));
+        hash = hashBytes(hash, values, sizeof(values));
+        if (record->neurons != NULL) {
+            hash = hashBytes(hash, record->neurons, record->neuronCount * sizeof(int));
+        }
+    }
+
+    return hash;
+}
+
+NsStatus nsRunCached(float *weights, int neuronCount, const NsParams *params, const char *cache, long long cacheBytes, const char *directory, int outputs,
+                     NsCacheStats *stats) {
+    if (neuronCount < 1 || params == NULL || cache == NULL || cacheBytes < 0 || directory == NULL || (weights == NULL && params->stencil == NULL)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    NsStatus status = checkParams(neuronCount, params);
+    if (status != NS_OK) {
+        return status;
+    }
+    if (outputs && access(directory, W_OK) != 0) {
+        return NS_ERROR_IO;
+    }
+
+    // Copy the results of an earlier run if they are cached.
+    CachedRun run;
+    uint64_t key = hashRun(weights, neuronCount, params, outputs);
+    int hit = fetchCacheEntry(cache, key, directory, &run);
+
+    // Otherwise run, write the results into a private entry, copy them out, and publish the entry.
+    if (!hit) {
+        char path[PATH_MAX];
+        NsSimulation *sim = NULL;
+        if (!openCacheEntry(cache, key, path, PATH_MAX)) {
+            return NS_ERROR_IO;
+        }
+        if ((status = nsCreate(weights, neuronCount, params, &sim)) == NS_OK && (status = nsRun(sim)) == NS_OK &&
+            (status = nsWriteResults(sim, path, outputs)) == NS_OK) {
+            run = (CachedRun) {
+                .key = key,
+                .neuronCount = neuronCount,
+                .steps = nsStepsTaken(sim),
+                .evalCount = sim->integ.sol.evalCount,
+                .stopReason = sim->integ.sol.stopReason
+            };
+            status = copyCacheEntry(path, directory) ? NS_OK : NS_ERROR_IO;
+        }
+        nsDestroy(sim);
+        if (status != NS_OK) {
+            removeCacheEntry(path);
+            return status;
+        }
+        commitCacheEntry(cache, path, &run, cacheBytes);
+    }
+
+    if (stats != NULL) {
+        *stats = (NsCacheStats) {
+            .key = key,
+            .hit = hit,
+            .steps = run.steps,
+            .evalCount = run.evalCount,
+            .stopReason = run.stopReason
+        };
+    }
+    return NS_OK;
+}
+
+void nsDestroy(NsSimulation *simulation) {
+    if (simulation == NULL) {
+        return;
+    }
+
+    // Free the approximation (if it was started), the copied parameters, and the rows of the graph.
+    if (simulation->integ.cond != NULL) {
+        EqSolution sol = finishIntegrator(&simulation->integ);
+        freeEqSolution(&sol);
+    }
+    freeWorkspace(&simulation->workspace);
+    free(simulation->record.neurons);
+    freeEqConditions(&simulation->cond);
+    free(simulation->graph.adjMatrix);
+    free(simulation);
+}
+
+/**
+ * @brief A component jobs structure which the threads of nsRunComponents() share.
+ */
+typedef struct {
+    /**
+     * @brief The row-major adjacency matrix of the whole graph.
+     */
+    const float *weights;
+
+    /**
+     * @brief The number of neurons of the whole graph.
+     */
+    int neuronCount;
+
+    /**
+     * @brief The parameters of the run.
+     */
+    const NsParams *params;
+
+    /**
+     * @brief The directory to write the files into.
+     */
+    const char *directory;
+
+    /**
+     * @brief The outputs written for each component (NS_WRITE_FREQS and NS_WRITE_RASTER are written once for the whole graph).
+     */
+    int outputs;
+
+    /**
+     * @brief The components of the graph.
+     */
+    Components components;
+
+    /**
+     * @brief The copies of each representative. Component c is copied by copies[copyStart[c]] to copies[copyStart[c + 1] - 1].
+     */
+    int *copyStart, *copies;
+
+    /**
+     * @brief The representatives, largest first.
+     */
+    int *order;
+
+    /**
+     * @brief The number of representatives and the next one to take.
+     */
+    int orderCount, next;
+
+    /**
+     * @brief The average frequency of each neuron of the whole graph.
+     */
+    float *avgFreqs;
+
+    /**
+     * @brief The spikes of every neuron of the whole graph (if the raster is written).
+     */
+    Raster raster;
+
+    /**
+     * @brief The steps taken by the largest component and the evaluations of every component.
+     */
+    int steps;
+    long evalCount;
+
+    /**
+     * @brief The first failure of any component.
+     */
+    NsStatus status;
+
+    /**
+     * @brief Whether a thread has taken the workspace of the caller.
+     */
+    int lent;
+
+    /**
+     * @brief The lock guarding next, raster, steps, evalCount, status, and lent.
+     */
+    pthread_mutex_t lock;
+} ComponentJobs;
+
+/**
+ * @brief A size structure which orders the representatives by their number of neurons.
+ */
+typedef struct {
+    /**
+     * @brief The number of neurons in the component.
+     */
+    int size;
+
+    /**
+     * @brief The number of the component.
+     */
+    int component;
+} ComponentSize;
+
+/**
+ * @brief Compares two component sizes for qsort(), largest first and then by component number.
+ *
+ * @param a the first size.
+ * @param b the second size.
+ * @return int - negative, zero, or positive as a comes before, with, or after b.
+ */
+static int compareSizes(const void *a, const void *b) {
+    const ComponentSize *first = (const ComponentSize *) a, *second = (const ComponentSize *) b;
+    if (first->size != second->size) {
+        return second->size - first->size;
+    }
+    return first->component - second->component;
+}
+
+/**
+ * @brief Gets the neurons of a representative component or one of its copies.
+ *
+ * @param jobs the shared jobs.
+ * @param c the representative component.
+ * @param copy 0 for the component itself, or 1 and up for its copies.
+ * @return const int* - the neurons in ascending order.
+ */
+static const int *copyNeurons(const ComponentJobs *jobs, int c, int copy) {
+    int target = copy == 0 ? c : jobs->copies[jobs->copyStart[c] + copy - 1];
+    return &jobs->components.neurons[jobs->components.first[target]];
+}
+
+/**
+ * @brief Simulates one representative component and writes its results under its own neurons and those of its copies.
+ *
+ * @param jobs the shared jobs.
+ * @param c the component.
+ * @param workspace the scratch memory of the thread.
+ * @return NsStatus - NS_OK, or the reason the component could not be simulated.
+ */
+static NsStatus runComponent(ComponentJobs *jobs, int c, Workspace *workspace) {
+    const Components *components = &jobs->components;
+    const int *neurons = &components->neurons[components->first[c]];
+    int size = components->first[c + 1] - components->first[c], copyCount = jobs->copyStart[c + 1] - jobs->copyStart[c];
+    const RecordSpec *record = jobs->params->record;
+
+    // Copy the weights between the neurons of the component and the recorded neurons among them.
+    float *weights = (float *) malloc((size_t) size * size * sizeof(float));
+    int *recorded = (int *) malloc(size * sizeof(int));
+    if (weights == NULL || recorded == NULL) {
+        free(weights);
+        free(recorded);
+        return NS_ERROR_MEMORY;
+    }
+    for (int row = 0; row < size; ++row) {
+        for (int column = 0; column < size; ++column) {
+            weights[(size_t) row * size + column] = jobs->weights[(size_t) neurons[row] * jobs->neuronCount + neurons[column]];
+        }
+    }
+    NsParams params = *jobs->params;
+    RecordSpec localRecord;
+    if (record != NULL) {
+        localRecord = *record;
+        if (record->neurons != NULL) {
+            // Store each position recorded in the component or any of its copies.
+            localRecord.neuronCount = 0;
+            for (int i = 0; i < size; ++i) {
+                int stored = 0;
+                for (int copy = 0; copy <= copyCount && !stored; ++copy) {
+                    stored = bsearch(&copyNeurons(jobs, c, copy)[i], record->neurons, record->neuronCount, sizeof(int), compareNeurons) != NULL;
+                }
+                if (stored) {
+                    recorded[localRecord.neuronCount++] = i;
+                }
+            }
+            localRecord.neurons = recorded;
+        }
+        params.record = &localRecord;
+    }
+    params.threads = 1;
+    params.workspace = workspace;
+
+    // Run the component.
+    NsSimulation *sim = NULL;
+    NeuronIds ids = {
+        .ids = neurons,
+        .total = jobs->neuronCount
+    };
+    NsStatus status = createSimulation(weights, size, &params, &ids, &sim);
+    if (status == NS_OK) {
+        status = nsRun(sim);
+    }
+
+    // Write the results of the component and each of its copies.
+    for (int copy = 0; copy <= copyCount && status == NS_OK; ++copy) {
+        const int *targetNeurons = copyNeurons(jobs, c, copy);
+        status = writeResults(sim, jobs->directory, jobs->outputs & ~(NS_WRITE_FREQS | NS_WRITE_RASTER), targetNeurons, record);
+        const EqSolution *sol = &sim->integ.sol;
+        for (int i = 0; i < size && status == NS_OK && jobs->avgFreqs != NULL; ++i) {
+            jobs->avgFreqs[targetNeurons[i]] = calcAvgFrequency(sol->spikes[i].size, params.transient, params.xEnd, 1000.0);
+        }
+        if (status == NS_OK && jobs->outputs & NS_WRITE_RASTER) {
+            pthread_mutex_lock(&jobs->lock);
+            for (int i = 0; i < size && status == NS_OK; ++i) {
+                if (!addRasterPoints(&jobs->raster, targetNeurons[i], &sol->spikes[i], sol->x, sim->integ.curStep + 1)) {
+                    status = NS_ERROR_MEMORY;
+                }
+            }
+            pthread_mutex_unlock(&jobs->lock);
+        }
+    }
+
+    // Count the steps and evaluations.
+    if (status == NS_OK) {
+        pthread_mutex_lock(&jobs->lock);
+        jobs->steps = sim->integ.curStep > jobs->steps ? sim->integ.curStep : jobs->steps;
+        jobs->evalCount += sim->integ.sol.evalCount;
+        pthread_mutex_unlock(&jobs->lock);
+    }
+
+    nsDestroy(sim);
+    free(weights);
+    free(recorded);
+    return status;
+}
+
+/**
+ * @brief Takes representatives largest first until none are left or one fails, reusing one workspace for all of them
+ * (the caller's for the first thread to start, if it gave one).
+ *
+ * @param arg the shared jobs.
+ * @return void* - NULL.
+ */
+static void *runComponents(void *arg) {
+    ComponentJobs *jobs = (ComponentJobs *) arg;
+    Workspace own = initWorkspace(), *workspace = &own;
+    pthread_mutex_lock(&jobs->lock);
+    if (jobs->params->workspace != NULL && !jobs->lent) {
+        workspace = jobs->params->workspace;
+        jobs->lent = 1;
+    }
+    pthread_mutex_unlock(&jobs->lock);
+
+    while (1) {
+        pthread_mutex_lock(&jobs->lock);
+        int c = jobs->next < jobs->orderCount && jobs->status == NS_OK ? jobs->order[jobs->next++] : -1;
+        pthread_mutex_unlock(&jobs->lock);
+        if (c < 0) {
+            break;
+        }
+
+        NsStatus status = runComponent(jobs, c, workspace);
+        if (status != NS_OK) {
+            pthread_mutex_lock(&jobs->lock);
+            jobs->status = jobs->status == NS_OK ? status : jobs->status;
+            pthread_mutex_unlock(&jobs->lock);
+        }
+    }
+
+    freeWorkspace(&own);
+    return NULL;
+}
+
+NsStatus nsRunComponents(float *weights, int neuronCount, const NsParams *params, int threads, const char *directory, int outputs, NsComponentStats *stats) {
+    if (weights == NULL || neuronCount < 1 || params == NULL || threads < 1 || directory == NULL) {
+        return NS_ERROR_ARGUMENT;
+    }
+    NsStatus status = checkParams(neuronCount, params);
+    if (status != NS_OK) {
+        return status;
+    }
+    if (params->convergence != NULL || params->plasticity != NULL || params->monitor != NULL || params->stencil != NULL ||
+        (params->record != NULL && params->record->keyframeInterval > 0)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if ((params->record == NULL || !params->record->spikes) && outputs & (NS_WRITE_SPIKES | NS_WRITE_ISI | NS_WRITE_FREQS | NS_WRITE_RASTER)) {
+        return NS_ERROR_ARGUMENT;
+    }
+    if (outputs && access(directory, W_OK) != 0) {
+        return NS_ERROR_IO;
+    }
+
+    // Point the rows of a graph into the adjacency matrix.
+    Graph graph = {
+        .vertexCount = neuronCount
+    };
+    if ((graph.adjMatrix = (float **) malloc(neuronCount * sizeof(float *))) == NULL) {
+        return NS_ERROR_MEMORY;
+    }
+    for (int row = 0; row < neuronCount; ++row) {
+        graph.adjMatrix[row] = weights + (size_t) row * neuronCount;
+    }
+
+    // Find the components, matching copies by their s values (noise makes every component unique).
+    float *labels = NULL;
+    if (params->noise == NULL) {
+        if ((labels = (float *) malloc(neuronCount * sizeof(float))) == NULL) {
+            free(graph.adjMatrix);
+            return NS_ERROR_MEMORY;
+        }
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            labels[neuron] = getNeuronS(neuron, neuronCount);
+        }
+    }
+    ComponentJobs jobs = {
+        .weights = weights,
+        .neuronCount = neuronCount,
+        .params = params,
+        .directory = directory,
+        .outputs = outputs,
+        .components = findComponents(&graph, labels),
+        .orderCount = 0,
+        .next = 0,
+        .avgFreqs = NULL,
+        .raster = {
+            .neurons = NULL
+        },
+        .steps = 0,
+        .evalCount = 0,
+        .status = NS_OK,
+        .lent = 0
+    };
+    free(labels);
+    free(graph.adjMatrix);
+    Components *components = &jobs.components;
+    if (components->neurons == NULL) {
+        return NS_ERROR_MEMORY;
+    }
+
+    // Allocate heap memory for the copies, the order, the frequencies, and the raster.
+    jobs.copyStart = (int *) calloc(components->count + 1, sizeof(int));
+    jobs.copies = (int *) malloc(components->count * sizeof(int));
+    jobs.order = (int *) malloc(components->count * sizeof(int));
+    ComponentSize *sizes = (ComponentSize *) malloc(components->count * sizeof(ComponentSize));
+    if (outputs & NS_WRITE_FREQS) {
+        jobs.avgFreqs = (float *) malloc(neuronCount * sizeof(float));
+    }
+    if (outputs & NS_WRITE_RASTER) {
+        jobs.raster = initRaster(neuronCount, params->x0, params->step, outputs & NS_WRITE_PEAKS ? RASTER_PEAKS : 0);
+    }
+    if (jobs.copyStart == NULL || jobs.copies == NULL || jobs.order == NULL || sizes == NULL ||
+        (outputs & NS_WRITE_FREQS && jobs.avgFreqs == NULL) || (outputs & NS_WRITE_RASTER && jobs.raster.neurons == NULL)) {
+        freeComponents(components);
+        free(jobs.copyStart);
+        free(jobs.copies);
+        free(jobs.order);
+        free(sizes);
+        free(jobs.avgFreqs);
+        freeRaster(&jobs.raster);
+        return NS_ERROR_MEMORY;
+    }
+
+    // Group the copies by representative and order the representatives largest first.
+    for (int c = 0; c < components->count; ++c) {
+        if (components->representative[c] != c) {
+            ++jobs.copyStart[components->representative[c] + 1];
+        }
+        else {
+            sizes[jobs.orderCount++] = (ComponentSize) {
+                .size = components->first[c + 1] - components->first[c],
+                .component = c
+            };
+        }
+    }
+    for (int c = 0; c < components->count; ++c) {
+        jobs.copyStart[c + 1] += jobs.copyStart[c];
+    }
+    int *filled = jobs.order;
+    memcpy(filled, jobs.copyStart, components->count * sizeof(int));
+    for (int c = 0; c < components->count; ++c) {
+        if (components->representative[c] != c) {
+            jobs.copies[filled[components->representative[c]]++] = c;
+        }
+    }
+    qsort(sizes, jobs.orderCount, sizeof(ComponentSize), compareSizes);
+    for (int i = 0; i < jobs.orderCount; ++i) {
+        jobs.order[i] = sizes[i].component;
+    }
+    free(sizes);
+
+    // Run the representatives on the threads (if a thread cannot be started, the others stop taking components).
+    threads = threads < jobs.orderCount ? threads : jobs.orderCount;
+    pthread_t workers[threads];
+    pthread_mutex_init(&jobs.lock, NULL);
+    int started = 0;
+    while (started < threads && pthread_create(&workers[started], NULL, runComponents, &jobs) == 0) {
+        ++started;
+    }
+    if (started < threads) {
+        pthread_mutex_lock(&jobs.lock);
+        jobs.status = jobs.status == NS_OK ? NS_ERROR_MEMORY : jobs.status;
+        pthread_mutex_unlock(&jobs.lock);
+    }
+    for (int t = 0; t < started; ++t) {
+        pthread_join(workers[t], NULL);
+    }
+    pthread_mutex_destroy(&jobs.lock);
+
+    // Write the average frequencies and s values of the whole graph.
+    if (jobs.status == NS_OK && outputs & NS_WRITE_FREQS) {
+        char filename[strlen(directory) + 32];
+        sprintf(filename, "%s/avg_freqs", directory);
+        int written = writeAvgFrequencies(filename, jobs.avgFreqs, neuronCount);
+        sprintf(filename, "%s/s_values", directory);
+        if (!written || !writeSs(filename, neuronCount)) {
+            jobs.status = NS_ERROR_IO;
+        }
+    }
+
+    // Write the spikes of the whole graph to the raster.
+    if (outputs & NS_WRITE_RASTER) {
+        char filename[strlen(directory) + 32];
+        sprintf(filename, "%s/raster", directory);
+        if (jobs.status == NS_OK && !writeRaster(&jobs.raster, filename)) {
+            jobs.status = NS_ERROR_IO;
+        }
+        freeRaster(&jobs.raster);
+    }
+
+    if (stats != NULL) {
+        *stats = (NsComponentStats) {
+            .components = components->count,
+            .simulated = components->uniqueCount,
+            .largest = components->largest,
+            .steps = jobs.steps,
+            .evalCount = jobs.evalCount
+        };
+    }
+
+    freeComponents(components);
+    free(jobs.copyStart);
+    free(jobs.copies);
+    free(jobs.order);
+    free(jobs.avgFreqs);
+    return jobs.status;
+}
+
+const char *nsStatusName(NsStatus status) {
+    switch (status) {
+        case NS_OK:
+            return "success";
+        case NS_ERROR_ARGUMENT:
+            return "invalid argument";
+        case NS_ERROR_GRAPH_OPEN:
+            return "graph file could not be opened";
+        case NS_ERROR_GRAPH_FORMAT:
+            return "graph file is not formatted correctly";
+        case NS_ERROR_MEMORY:
+            return "out of memory";
+        case NS_ERROR_FINISHED:
+            return "simulation already finished";
+        case NS_ERROR_IO:
+            return "output could not be written";
+        default:
+            return "unknown status";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,433 @@
+/**
+ * @file neurosync.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for the neurosync library, a reentrant interface for creating, running, and reading simulations
+ * of Hindmarsh-Rose neuron networks within another program.
+ * @version 0.1
+ * @date 2022-09-26
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef NEUROSYNC
+#define NEUROSYNC
+
+#include "numerical_methods.h"
+
+#define NS_FUNC_COUNT 3     // The number of functions of each neuron (x, y, and z of the Hindmarsh-Rose model).
+#define NS_WRITE_APPROX 0x1 // Write the stored approximations (approx<neuron> and approx<neuron>_<function>).
+#define NS_WRITE_SPIKES 0x2 // Write the spikes of each neuron (spikes<neuron>).
+#define NS_WRITE_ISI 0x4    // Write the inter-spike intervals of each neuron (ISI<neuron>).
+#define NS_WRITE_FREQS 0x8  // Write the average frequencies and s values of the neurons (avg_freqs and s_values).
+#define NS_WRITE_WEIGHTS 0x10   // Write the weight snapshots of a plastic simulation (weights).
+#define NS_WRITE_KEYFRAMES 0x20 // Write the keyframes of a simulation that took them (keyframes).
+#define NS_WRITE_RASTER 0x40  // Write the spikes of every neuron to one compact file (raster).
+#define NS_WRITE_PEAKS 0x80   // Keep the peak of each spike in the raster.
+#define NS_WRITE_ALL 0x3F   // Write every output but the raster.
+#define NS_VERSION "0.1"    // The version of the library (part of every cache key, along with when it was built).
+
+/**
+ * @brief The results of the library functions.
+ */
+typedef enum {
+    NS_OK,                  // The call succeeded.
+    NS_ERROR_ARGUMENT,      // An argument or parameter is invalid.
+    NS_ERROR_GRAPH_OPEN,    // The graph file could not be opened.
+    NS_ERROR_GRAPH_FORMAT,  // The graph file is not a formatted graph.
+    NS_ERROR_MEMORY,        // Memory could not be allocated.
+    NS_ERROR_FINISHED,      // The simulation has no steps left to take.
+    NS_ERROR_IO             // The output directory or one of its files cannot be written to.
+} NsStatus;
+
+/**
+ * @brief A parameters structure which specifies a simulation.
+ */
+typedef struct {
+    /**
+     * @brief The starting and final x positions.
+     */
+    float x0, xEnd;
+
+    /**
+     * @brief The size of each step.
+     */
+    float step;
+
+    /**
+     * @brief The x position in which the network starts exhibiting its normal behavior.
+     */
+    float transient;
+
+    /**
+     * @brief The initial value of each function (NULL to start every function at 0).
+     */
+    float *inits;
+
+    /**
+     * @brief The numerical method used to run the simulation.
+     */
+    Method method;
+
+    /**
+     * @brief The number of micro-steps per macro-step of the multirate method.
+     */
+    int ratio;
+
+    /**
+     * @brief The voltage a neuron must reach to take micro-steps in the multirate method.
+     */
+    float activityThreshold;
+
+    /**
+     * @brief The number of pinned threads taking each step (rk4 with electrical coupling only above 1).
+     */
+    int threads;
+
+    /**
+     * @brief The criteria for stopping the simulation early (NULL to always run to xEnd).
+     */
+    ConvergenceCriteria *convergence;
+
+    /**
+     * @brief The parameters of chemical synapses replacing the electrical coupling (NULL for electrical coupling, rk4 only).
+     */
+    SynapseParams *synapses;
+
+    /**
+     * @brief The noise added to x and the spread of the initial values (NULL for a deterministic simulation).
+     */
+    NoiseParams *noise;
+
+    /**
+     * @brief The spike-timing-dependent plasticity of the weights (NULL for fixed weights, rk4 or etd with electrical
+     * coupling and one thread only). The caller's weights are copied, so they are never modified.
+     */
+    PlasticityParams *plasticity;
+
+    /**
+     * @brief Where and how often the progress is published to shared memory for a viewer (NULL to publish nothing).
+     */
+    MonitorParams *monitor;
+
+    /**
+     * @brief What the simulation stores (NULL to store every function of every neuron at every step).
+     */
+    RecordSpec *record;
+
+    /**
+     * @brief The lattice coupling the neurons through their neighbours instead of the weights (NULL to couple through
+     * the weights, which may then be NULL). neuronCount must be its number of cells, and it cannot be combined with
+     * synapses or plasticity.
+     */
+    StencilParams *stencil;
+
+    /**
+     * @brief The scratch memory of the numerical methods, owned by the caller so it is reused across runs (NULL for
+     * memory of the simulation's own). It must not be used by two simulations at once.
+     */
+    Workspace *workspace;
+} NsParams;
+
+/**
+ * @brief A component statistics structure which summarizes a run split into connected components.
+ */
+typedef struct {
+    /**
+     * @brief The number of connected components.
+     */
+    int components;
+
+    /**
+     * @brief The number of components simulated (the rest copied the results of an identical component).
+     */
+    int simulated;
+
+    /**
+     * @brief The number of neurons in the largest component.
+     */
+    int largest;
+
+    /**
+     * @brief The number of steps taken by each component.
+     */
+    int steps;
+
+    /**
+     * @brief The number of times getODEs() was evaluated for a neuron across every simulated component.
+     */
+    long evalCount;
+} NsComponentStats;
+
+/**
+ * @brief A replay statistics structure which summarizes a window integrated again from a keyframe.
+ */
+typedef struct {
+    /**
+     * @brief The x position of the keyframe the window was integrated from.
+     */
+    float keyframeX;
+
+    /**
+     * @brief The number of steps integrated (from the keyframe to the end of the window).
+     */
+    int steps;
+} NsReplayStats;
+
+/**
+ * @brief A cache statistics structure which summarizes a run through the result cache.
+ */
+typedef struct {
+    /**
+     * @brief The key of the run in the cache.
+     */
+    uint64_t key;
+
+    /**
+     * @brief Whether the results were copied from the cache instead of running.
+     */
+    int hit;
+
+    /**
+     * @brief The number of steps taken.
+     */
+    int steps;
+
+    /**
+     * @brief The number of times getODEs() was evaluated for a neuron (when the results were first computed).
+     */
+    long evalCount;
+
+    /**
+     * @brief Why the run stopped.
+     */
+    StopReason stopReason;
+} NsCacheStats;
+
+/**
+ * @brief A handle to a simulation. Every simulation is independent, so separate handles may be used from separate threads.
+ */
+typedef struct NsSimulation NsSimulation;
+
+/**
+ * @brief Sets the default parameters (a 0 to 1000 run with steps of 0.1 and a transient of 500 using rk4).
+ *
+ * @param params the parameters to set.
+ */
+void nsDefaultParams(NsParams *params);
+
+/**
+ * @brief Reads a graph from a formatted file into a row-major adjacency matrix.
+ *
+ * @param filename the name of the file to be read.
+ * @param weights where to store the adjacency matrix (free with nsFreeWeights()). Access using weights[row * neuronCount + column].
+ * @param neuronCount where to store the number of neurons.
+ * @return NsStatus - NS_OK, or the reason the graph could not be read.
+ */
+NsStatus nsReadGraph(char *filename, float **weights, int *neuronCount);
+
+/**
+ * @brief Frees an adjacency matrix read by nsReadGraph().
+ *
+ * @param weights the adjacency matrix to be freed.
+ */
+void nsFreeWeights(float *weights);
+
+/**
+ * @brief Creates a simulation. The parameters are copied, but the adjacency matrix is used in place and must outlive
+ * the simulation.
+ *
+ * @param weights the row-major adjacency matrix (may be NULL with a stencil). Access using weights[row * neuronCount + column].
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the simulation.
+ * @param simulation where to store the handle of the created simulation.
+ * @return NsStatus - NS_OK, or the reason the simulation could not be created (NS_ERROR_MEMORY if the memory or
+ * threads of the solver could not be allocated).
+ */
+NsStatus nsCreate(float *weights, int neuronCount, const NsParams *params, NsSimulation **simulation);
+
+/**
+ * @brief Advances a simulation by up to a number of steps. It stops early at xEnd, once the network has converged, or
+ * once memory could not be allocated to store a step (the simulation then takes no more steps).
+ *
+ * @param simulation the simulation.
+ * @param steps the most steps to take.
+ * @param taken where to store the number of steps taken (may be NULL).
+ * @return NsStatus - NS_OK, NS_ERROR_MEMORY if a step could not be stored, or NS_ERROR_FINISHED if no steps were left.
+ */
+NsStatus nsStep(NsSimulation *simulation, int steps, int *taken);
+
+/**
+ * @brief Runs a simulation until xEnd or until the network has converged.
+ *
+ * @param simulation the simulation.
+ * @return NsStatus - NS_OK, NS_ERROR_MEMORY if a step could not be stored, or NS_ERROR_FINISHED if no steps were left.
+ */
+NsStatus nsRun(NsSimulation *simulation);
+
+/**
+ * @brief Checks if a simulation has no steps left to take.
+ *
+ * @param simulation the simulation.
+ * @return int - 1 if finished, otherwise 0.
+ */
+int nsFinished(const NsSimulation *simulation);
+
+/**
+ * @brief Gets the number of steps a simulation has taken.
+ *
+ * @param simulation the simulation.
+ * @return int - the number of steps taken.
+ */
+int nsStepsTaken(const NsSimulation *simulation);
+
+/**
+ * @brief Gets the current x position of a simulation.
+ *
+ * @param simulation the simulation.
+ * @return float - the current x position.
+ */
+float nsCurrentX(const NsSimulation *simulation);
+
+/**
+ * @brief Gets the current value of each function for every neuron. The pointer stays valid until the simulation is destroyed.
+ *
+ * @param simulation the simulation.
+ * @return const float* - the current state. Access using state[functionNum * neuronCount + neuronNum].
+ */
+const float *nsState(const NsSimulation *simulation);
+
+/**
+ * @brief Gets the spikes found so far for every neuron. The spikes of a neuron may move as more are found.
+ *
+ * @param simulation the simulation.
+ * @return const Points* - the spikes (NULL unless the record specification requested them). Access using spikes[neuronNum].
+ */
+const Points *nsSpikes(const NsSimulation *simulation);
+
+/**
+ * @brief Gets the solution of a simulation, holding the stored samples, x values, and spikes so far. Its stepCount
+ * is the number of steps planned until the simulation is finished.
+ *
+ * @param simulation the simulation.
+ * @return const EqSolution* - the solution.
+ */
+const EqSolution *nsSolution(const NsSimulation *simulation);
+
+/**
+ * @brief Copies stored samples of a function of a recorded neuron, decoding them if the record specification
+ * compressed them.
+ *
+ * @param simulation the simulation.
+ * @param record the number of the record (the index of the neuron within the solution's neurons).
+ * @param func the number of the function.
+ * @param first the number of the first sample.
+ * @param count the number of samples.
+ * @param samples where to store the samples.
+ * @return NsStatus - NS_OK, or NS_ERROR_ARGUMENT if the function is not stored or the samples do not exist yet.
+ */
+NsStatus nsReadSamples(const NsSimulation *simulation, int record, int func, int first, int count, float samples[]);
+
+/**
+ * @brief Gets the partitions the neurons of a simulation are split into between its threads.
+ *
+ * @param simulation the simulation.
+ * @return const Partition* - the partitions (NULL when the simulation steps on the calling thread).
+ */
+const Partition *nsPartition(const NsSimulation *simulation);
+
+/**
+ * @brief Gets the plastic weights, traces, and snapshots of a simulation.
+ *
+ * @param simulation the simulation.
+ * @return const Plasticity* - the plasticity (NULL unless the simulation is plastic). Its graph holds the current weights.
+ */
+const Plasticity *nsPlasticity(const NsSimulation *simulation);
+
+/**
+ * @brief Writes the results of a simulation as the files the driver produces. Spike based outputs require the
+ * record specification to have requested spikes, and the weight snapshots are only written for a plastic simulation.
+ *
+ * @param simulation the simulation.
+ * @param directory the directory to write the files into.
+ * @param outputs the outputs to write (NS_WRITE_* flags).
+ * @return NsStatus - NS_OK, NS_ERROR_IO if the directory or a file cannot be written to, NS_ERROR_MEMORY if memory
+ * could not be allocated, or NS_ERROR_ARGUMENT if spikes are missing.
+ */
+NsStatus nsWriteResults(const NsSimulation *simulation, const char *directory, int outputs);
+
+/**
+ * @brief Runs a graph as its connected components, which evolve independently, and writes the results as the files
+ * nsWriteResults() produces for the whole graph. The components are taken largest first by the threads, and without
+ * noise a component that is a copy of an earlier one (equal s values and weights) reuses its results. Each neuron keeps
+ * its s value and noise stream from the whole graph, so the results match a run of the whole graph.
+ *
+ * @param weights the row-major adjacency matrix. Access using weights[row * neuronCount + column].
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the run (without convergence, plasticity, a monitor, keyframes, or a stencil; each
+ * component steps on one thread).
+ * @param threads the number of components simulated at once.
+ * @param directory the directory to write the files into.
+ * @param outputs the outputs to write (NS_WRITE_* flags).
+ * @param stats where to store the statistics of the run (may be NULL).
+ * @return NsStatus - NS_OK, or the reason the run failed.
+ */
+NsStatus nsRunComponents(float *weights, int neuronCount, const NsParams *params, int threads, const char *directory, int outputs, NsComponentStats *stats);
+
+/**
+ * @brief Integrates a window of an earlier simulation again from the last keyframe at or before its start, and writes
+ * every function of the recorded neurons at every step of the window as the approx files nsWriteResults() produces
+ * (with their own x positions). The steps match the earlier simulation exactly when it was run with the same weights
+ * and parameters and stepped through in whole macro-steps.
+ *
+ * @param weights the row-major adjacency matrix of the earlier simulation (may be NULL with a stencil). Access using
+ * weights[row * neuronCount + column].
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the earlier simulation (without synapses or plasticity, whose events and weights
+ * are not kept; its convergence, monitor, spikes, and stored functions are ignored).
+ * @param keyframeFile the keyframes the earlier simulation wrote (NS_WRITE_KEYFRAMES).
+ * @param start the x position of the start of the window.
+ * @param end the x position of the end of the window.
+ * @param directory the directory to write the files into.
+ * @param stats where to store the statistics of the replay (may be NULL).
+ * @return NsStatus - NS_OK, NS_ERROR_IO if the keyframes cannot be read or the directory cannot be written to, or
+ * NS_ERROR_ARGUMENT if the keyframes were taken from different parameters or the window is outside the simulation.
+ */
+NsStatus nsReplay(float *weights, int neuronCount, const NsParams *params, const char *keyframeFile, float start, float end, const char *directory, NsReplayStats *stats);
+
+/**
+ * @brief Runs a simulation and writes its results as nsWriteResults() does, through a cache of earlier results. The
+ * cache key hashes the weights (or lattice), every parameter that affects the results, the outputs, and the version
+ * and build of the library; the threads and the monitor are left out, since the results do not depend on them. When the
+ * key is in the cache, its files are copied into the directory without running. Otherwise the results are written into
+ * the cache, copied into the directory, and the least recently used entries are evicted until the cache fits in
+ * cacheBytes. Separate processes and threads may share a cache.
+ *
+ * @param weights the row-major adjacency matrix (may be NULL with a stencil). Access using weights[row * neuronCount + column].
+ * @param neuronCount the number of neurons.
+ * @param params the parameters of the simulation.
+ * @param cache the cache directory (created if needed).
+ * @param cacheBytes the most bytes the files of the cache may take.
+ * @param directory the directory to write the files into (unused without outputs).
+ * @param outputs the outputs to write (NS_WRITE_* flags).
+ * @param stats where to store the statistics of the run (may be NULL).
+ * @return NsStatus - NS_OK, NS_ERROR_IO if the directory or the cache cannot be written to, or the reason the run failed.
+ */
+NsStatus nsRunCached(float *weights, int neuronCount, const NsParams *params, const char *cache, long long cacheBytes, const char *directory, int outputs,
+                     NsCacheStats *stats);
+
+/**
+ * @brief Destroys a simulation, freeing all of its memory.
+ *
+ * @param simulation the simulation to be destroyed (may be NULL).
+ */
+void nsDestroy(NsSimulation *simulation);
+
+/**
+ * @brief Gets a readable description of a status.
+ *
+ * @param status the status.
+ * @return const char* - the description of the status.
+ */
+const char *nsStatusName(NsStatus status);
+
+#endif
\ No newline at end of file
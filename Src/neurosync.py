@@ -0,0 +1,406 @@
+# File - neurosync.py
+# Author - Alex Smith (SmithAlexLee30@gmail.com)
+# Description - Python bindings (ctypes, standard library only) over the neurosync simulation library.
+#               The adjacency matrix is passed to the library as a buffer, and the state, stored samples, and spikes
+#               are returned as memoryviews over the solver's memory, so nothing is copied.
+# Date - 2022-09-28
+
+from array import array
+from ctypes import (CDLL, POINTER, Structure, byref, c_char_p, c_float, c_int, c_long, c_uint64, c_void_p, cast, pointer)
+from dataclasses import dataclass
+from math import isqrt
+from os import environ
+from pathlib import Path
+from typing import Optional, Sequence, Tuple, Union
+
+FUNC_COUNT = 3                                      # The functions of each neuron (x, y, and z).
+METHODS = {"rk4": 0, "multirate": 1, "etd": 2}      # The numerical methods of the library.
+STOP_REASONS = ["reached xEnd", "synchronized", "periodic"]
+CHECK_SYNCHRONY = 0x1
+CHECK_PERIODIC = 0x2
+NS_OK = 0
+NS_ERROR_FINISHED = 5
+NS_WRITE_KEYFRAMES = 0x20
+
+class _ConvergenceCriteria(Structure):
+    _fields_ = [("checks", c_int), ("syncTolerance", c_float), ("isiTolerance", c_float),
+                ("window", c_float), ("hold", c_float), ("spikeThreshold", c_float)]
+
+class _SynapseParams(Structure):
+    _fields_ = [("reversal", c_float), ("decay", c_float), ("delay", c_float), ("threshold", c_float)]
+
+class _NoiseParams(Structure):
+    _fields_ = [("seed", c_uint64), ("strength", c_float), ("spread", c_float)]
+
+class _PlasticityParams(Structure):
+    _fields_ = [("potentiation", c_float), ("depression", c_float), ("tauPlus", c_float), ("tauMinus", c_float),
+                ("maxWeight", c_float), ("threshold", c_float), ("snapshotInterval", c_float)]
+
+class _MonitorParams(Structure):
+    _fields_ = [("name", c_char_p), ("interval", c_int), ("capacity", c_int)]
+
+class _Graph(Structure):
+    _fields_ = [("adjMatrix", POINTER(POINTER(c_float))), ("vertexCount", c_int)]
+
+class _Plasticity(Structure):
+    # Only the leading fields of the library's Plasticity are read.
+    _fields_ = [("params", _PlasticityParams), ("graph", POINTER(_Graph))]
+
+class _RecordSpec(Structure):
+    _fields_ = [("funcMask", c_int), ("neurons", POINTER(c_int)), ("neuronCount", c_int), ("start", c_float),
+                ("end", c_float), ("stride", c_int), ("spikes", c_int), ("spikeThreshold", c_float),
+                ("quantum", c_float), ("keyframeInterval", c_int)]
+
+class _StencilParams(Structure):
+    _fields_ = [("axes", c_int), ("shape", c_int * 3), ("neighbours", c_int), ("periodic", c_int),
+                ("strength", c_float * 3), ("diagonal", c_float)]
+
+class _NsParams(Structure):
+    _fields_ = [("x0", c_float), ("xEnd", c_float), ("step", c_float), ("transient", c_float),
+                ("inits", POINTER(c_float)), ("method", c_int), ("ratio", c_int), ("activityThreshold", c_float),
+                ("threads", c_int), ("convergence", POINTER(_ConvergenceCriteria)), ("synapses", POINTER(_SynapseParams)),
+                ("noise", POINTER(_NoiseParams)), ("plasticity", POINTER(_PlasticityParams)),
+                ("monitor", POINTER(_MonitorParams)), ("record", POINTER(_RecordSpec)),
+                ("stencil", POINTER(_StencilParams)), ("workspace", c_void_p)]
+
+class _Points(Structure):
+    _fields_ = [("x", POINTER(c_float)), ("y", POINTER(c_float)), ("size", c_int), ("capacity", c_int)]
+
+class _EqSolution(Structure):
+    _fields_ = [("x", POINTER(c_float)), ("approx", POINTER(POINTER(POINTER(c_float)))), ("compressed", c_void_p),
+                ("neurons", POINTER(c_int)),
+                ("recordCount", c_int), ("sampleX", POINTER(c_float)), ("sampleCount", c_int),
+                ("recordFirst", c_int), ("recordLast", c_int), ("recordStride", c_int), ("spikes", POINTER(_Points)),
+                ("neuronCount", c_int), ("funcCount", c_int), ("stepCount", c_int), ("stopReason", c_int),
+                ("evalCount", c_long)]
+
+def _load_library() -> CDLL:
+    """Loads the shared library from NEUROSYNC_LIBRARY or the Bin directory."""
+    path = environ.get("NEUROSYNC_LIBRARY", str(Path(__file__).resolve().parent.parent / "Bin" / "libneurosync.so"))
+    lib = CDLL(path)
+
+    lib.nsReadGraph.argtypes = [c_char_p, POINTER(POINTER(c_float)), POINTER(c_int)]
+    lib.nsFreeWeights.argtypes = [POINTER(c_float)]
+    lib.nsCreate.argtypes = [POINTER(c_float), c_int, POINTER(_NsParams), POINTER(c_void_p)]
+    lib.nsStep.argtypes = [c_void_p, c_int, POINTER(c_int)]
+    lib.nsRun.argtypes = [c_void_p]
+    lib.nsFinished.argtypes = [c_void_p]
+    lib.nsStepsTaken.argtypes = [c_void_p]
+    lib.nsCurrentX.argtypes = [c_void_p]
+    lib.nsCurrentX.restype = c_float
+    lib.nsState.argtypes = [c_void_p]
+    lib.nsState.restype = POINTER(c_float)
+    lib.nsSolution.argtypes = [c_void_p]
+    lib.nsSolution.restype = POINTER(_EqSolution)
+    lib.nsReadSamples.argtypes = [c_void_p, c_int, c_int, c_int, c_int, POINTER(c_float)]
+    lib.nsWriteResults.argtypes = [c_void_p, c_char_p, c_int]
+    lib.nsPlasticity.argtypes = [c_void_p]
+    lib.nsPlasticity.restype = POINTER(_Plasticity)
+    lib.nsDestroy.argtypes = [c_void_p]
+    lib.nsStatusName.argtypes = [c_int]
+    lib.nsStatusName.restype = c_char_p
+    for name in ("nsReadGraph", "nsCreate", "nsStep", "nsRun", "nsFinished", "nsStepsTaken", "nsReadSamples", "nsWriteResults"):
+        getattr(lib, name).restype = c_int
+    return lib
+
+_lib = _load_library()
+
+class NeurosyncError(Exception):
+    """An error status returned by the library."""
+    def __init__(self, status: int):
+        super().__init__(_lib.nsStatusName(status).decode())
+        self.status = status
+
+def _check(status: int) -> None:
+    """Raises the status if it is an error."""
+    if status != NS_OK:
+        raise NeurosyncError(status)
+
+def _view(data, count: int, fmt: str = "f") -> memoryview:
+    """Wraps count items at a C pointer in a flat memoryview without copying."""
+    if not data or count <= 0:
+        return memoryview(array(fmt))
+    items = (data._type_ * count).from_address(cast(data, c_void_p).value)
+    return memoryview(items).cast("B").cast(fmt)
+
+@dataclass
+class Convergence:
+    """The criteria for stopping once the network has converged (a tolerance of None disables that check)."""
+    sync_tolerance: Optional[float] = None
+    isi_tolerance: Optional[float] = None
+    window: float = 200.0
+    hold: float = 200.0
+    spike_threshold: float = 0.0
+
+@dataclass
+class Synapses:
+    """The parameters of event-driven chemical synapses (rk4 only)."""
+    reversal: float = 2.0
+    decay: float = 10.0
+    delay: float = 1.0
+    threshold: float = 0.0
+
+@dataclass
+class Noise:
+    """The white noise added to x and the spread of the random initial values, reproducible from the seed."""
+    strength: float = 0.0
+    spread: float = 0.0
+    seed: int = 0
+
+@dataclass
+class Plasticity:
+    """Pair-based STDP of the coupling weights (rk4 or etd with one thread only), with a weight snapshot every
+    snapshot_interval (0 for none)."""
+    potentiation: float = 0.01
+    depression: float = 0.012
+    tau_plus: float = 20.0
+    tau_minus: float = 20.0
+    max_weight: float = 1.0
+    threshold: float = 0.0
+    snapshot_interval: float = 0.0
+
+@dataclass
+class Monitor:
+    """Publishes the progress every interval steps to the shared memory object name for Bin/monitor to watch."""
+    name: str = "neurosync"
+    interval: int = 100
+    capacity: int = 1024
+
+@dataclass
+class Record:
+    """What the simulation stores (neurons of None stores every neuron, start/end of None store the whole run, and a
+    quantum above 0 stores the samples compressed, rounded to multiples of it). keyframes above 0 keeps the whole state
+    every that many steps, written as the keyframes output for a replay of any window."""
+    funcs: Sequence[int] = (0,)
+    neurons: Optional[Sequence[int]] = None
+    start: Optional[float] = None
+    end: Optional[float] = None
+    stride: int = 1
+    spikes: bool = True
+    spike_threshold: float = 0.0
+    quantum: float = 0.0
+    keyframes: int = 0
+
+@dataclass
+class Stencil:
+    """A regular 2-D or 3-D lattice coupling each cell to its neighbours instead of weights (shape slowest axis first,
+    neighbours of None for 4 in 2-D or 6 in 3-D, 8 adds the corners in 2-D). strength is one value or one per axis, and
+    diagonal of None uses the mean of the row and column strengths."""
+    shape: Sequence[int]
+    neighbours: Optional[int] = None
+    periodic: bool = False
+    strength: Union[float, Sequence[float]] = 0.2
+    diagonal: Optional[float] = None
+
+def read_graph(filename: str) -> Tuple[array, int]:
+    """Reads a formatted graph file into a row-major float array and its neuron count."""
+    weights = POINTER(c_float)()
+    count = c_int()
+    _check(_lib.nsReadGraph(filename.encode(), byref(weights), byref(count)))
+    try:
+        matrix = array("f", _view(weights, count.value * count.value))
+    finally:
+        _lib.nsFreeWeights(weights)
+    return matrix, count.value
+
+class Simulation:
+    """A simulation run by the library. The weights buffer is used in place, so it must not change size while the
+    simulation is open (with threads above 1 each thread copies its rows when the simulation is created, so later
+    changes to the weights are not seen). With a stencil the weights may be None. Memoryviews returned by this class are
+    only valid until close(), and spike views until the next step."""
+
+    def __init__(self, weights, neuron_count: Optional[int] = None, x0: float = 0.0, x_end: float = 1000.0,
+                 step: float = 0.1, transient: float = 500.0, inits: Optional[Sequence[float]] = None,
+                 method: str = "rk4", ratio: int = 4, activity_threshold: float = -1.0, threads: int = 1,
+                 convergence: Optional[Convergence] = None, synapses: Optional[Synapses] = None,
+                 noise: Optional[Noise] = None, plasticity: Optional[Plasticity] = None,
+                 monitor: Optional[Monitor] = None, record: Optional[Record] = Record(),
+                 stencil: Optional[Stencil] = None):
+        # Find the size of the lattice, whose neighbours couple the neurons instead of the weights.
+        lattice = None
+        if stencil is not None:
+            axes = len(stencil.shape)
+            strength = [stencil.strength] * axes if isinstance(stencil.strength, (int, float)) else list(stencil.strength)
+            diagonal = stencil.diagonal if stencil.diagonal is not None else (strength[-2] + strength[-1]) / 2
+            lattice = _StencilParams(axes, (c_int * 3)(*stencil.shape), stencil.neighbours or (6 if axes == 3 else 4),
+                                     int(stencil.periodic), (c_float * 3)(*strength), diagonal)
+            neuron_count = 1
+            for size in stencil.shape:
+                neuron_count *= size
+
+        # Pass the weights in place when the buffer is writable float32, otherwise copy them once.
+        self._weights = None
+        if weights is not None:
+            view = memoryview(weights)
+            if view.format == "B" and view.c_contiguous and view.nbytes % 4 == 0:
+                view = view.cast("f")
+            if view.format not in ("f", "<f") or not view.c_contiguous:
+                raise TypeError("weights must be a contiguous float32 buffer")
+            size = view.nbytes // 4
+            neuron_count = neuron_count if neuron_count is not None else isqrt(size)
+            if neuron_count * neuron_count != size:
+                raise ValueError("weights must hold neuron_count * neuron_count values")
+            matrix = c_float * size
+            self._weights = matrix.from_buffer(view) if not view.readonly else matrix.from_buffer_copy(view)
+        elif lattice is None:
+            raise ValueError("weights are needed without a stencil")
+        self.neuron_count = neuron_count
+
+        params = _NsParams(x0, x_end, step, transient, None, METHODS[method], ratio, activity_threshold,
+                            threads)
+        if inits is not None:
+            self._inits = (c_float * FUNC_COUNT)(*inits)
+            params.inits = self._inits
+        if convergence is not None:
+            checks = (CHECK_SYNCHRONY if convergence.sync_tolerance is not None else 0) | \
+                     (CHECK_PERIODIC if convergence.isi_tolerance is not None else 0)
+            criteria = _ConvergenceCriteria(checks, convergence.sync_tolerance or 0.0, convergence.isi_tolerance or 0.0,
+                                            convergence.window, convergence.hold, convergence.spike_threshold)
+            params.convergence = pointer(criteria)
+        if synapses is not None:
+            params.synapses = pointer(_SynapseParams(synapses.reversal, synapses.decay, synapses.delay,
+                                                        synapses.threshold))
+        if noise is not None:
+            params.noise = pointer(_NoiseParams(noise.seed, noise.strength, noise.spread))
+        if plasticity is not None:
+            params.plasticity = pointer(_PlasticityParams(plasticity.potentiation, plasticity.depression,
+                                                          plasticity.tau_plus, plasticity.tau_minus,
+                                                          plasticity.max_weight, plasticity.threshold,
+                                                          plasticity.snapshot_interval))
+        if monitor is not None:
+            params.monitor = pointer(_MonitorParams(monitor.name.encode(), monitor.interval, monitor.capacity))
+        if record is not None:
+            mask = 0
+            for func in record.funcs:
+                mask |= 1 << func
+            spec = _RecordSpec(mask, None, 0, x0 if record.start is None else record.start,
+                               x_end if record.end is None else record.end, record.stride, int(record.spikes),
+                               record.spike_threshold, record.quantum, record.keyframes)
+            if record.neurons is not None:
+                neurons = sorted(set(record.neurons))
+                spec.neurons = (c_int * len(neurons))(*neurons)
+                spec.neuronCount = len(neurons)
+            params.record = pointer(spec)
+        if lattice is not None:
+            params.stencil = pointer(lattice)
+
+        self._handle = c_void_p()
+        _check(_lib.nsCreate(self._weights, self.neuron_count, byref(params), byref(self._handle)))
+        self._solution = _lib.nsSolution(self._handle).contents
+
+    def step(self, steps: int) -> int:
+        """Advances by up to steps steps and returns the number taken (0 once finished)."""
+        taken = c_int(0)
+        status = _lib.nsStep(self._handle, steps, byref(taken))
+        if status != NS_ERROR_FINISHED:
+            _check(status)
+        return taken.value
+
+    def run(self) -> None:
+        """Runs until xEnd or until the network has converged."""
+        status = _lib.nsRun(self._handle)
+        if status != NS_ERROR_FINISHED:
+            _check(status)
+
+    @property
+    def finished(self) -> bool:
+        return bool(_lib.nsFinished(self._handle))
+
+    @property
+    def steps_taken(self) -> int:
+        return _lib.nsStepsTaken(self._handle)
+
+    @property
+    def current_x(self) -> float:
+        return _lib.nsCurrentX(self._handle)
+
+    @property
+    def eval_count(self) -> int:
+        return self._solution.evalCount
+
+    @property
+    def stop_reason(self) -> str:
+        return STOP_REASONS[self._solution.stopReason]
+
+    @property
+    def state(self) -> memoryview:
+        """The current value of each function of every neuron. Access using state[func, neuron]."""
+        return _view(_lib.nsState(self._handle), FUNC_COUNT * self.neuron_count).cast("B").cast(
+            "f", (FUNC_COUNT, self.neuron_count))
+
+    @property
+    def plastic_weights(self) -> memoryview:
+        """The current plastic weights (the caller's weights are never modified). Access using weights[post, pre]."""
+        plasticity = _lib.nsPlasticity(self._handle)
+        if not plasticity:
+            raise KeyError("the simulation is not plastic")
+        size = self.neuron_count * self.neuron_count
+        return _view(plasticity.contents.graph.contents.adjMatrix[0], size).cast("B").cast(
+            "f", (self.neuron_count, self.neuron_count))
+
+    @property
+    def recorded_neurons(self) -> memoryview:
+        """The neuron number of each record."""
+        return _view(self._solution.neurons, self._solution.recordCount, "i")
+
+    @property
+    def sample_x(self) -> memoryview:
+        """The x value of each stored sample so far."""
+        return _view(self._solution.sampleX, self._solution.sampleCount)
+
+    def samples(self, neuron: int, func: int = 0) -> memoryview:
+        """The stored samples so far of a function of a recorded neuron (decoded into a new buffer when compressed)."""
+        records = self.recorded_neurons
+        if neuron not in records:
+            raise KeyError(f"neuron {neuron} is not recorded")
+        record = records.tolist().index(neuron)
+        functions = self._solution.approx[record]
+        if functions[func]:
+            return _view(functions[func], self._solution.sampleCount)
+        decoded = (c_float * max(self._solution.sampleCount, 1))()
+        if _lib.nsReadSamples(self._handle, record, func, 0, self._solution.sampleCount, decoded) != NS_OK:
+            raise KeyError(f"function {func} is not recorded")
+        return memoryview(decoded).cast("B").cast("f")[:self._solution.sampleCount]
+
+    def spikes(self, neuron: int) -> Tuple[memoryview, memoryview]:
+        """The times and values of the spikes found so far for a neuron."""
+        if not self._solution.spikes:
+            raise KeyError("spikes are not recorded")
+        if not 0 <= neuron < self.neuron_count:
+            raise IndexError(neuron)
+        points = self._solution.spikes[neuron]
+        return _view(points.x, points.size), _view(points.y, points.size)
+
+    def write_keyframes(self, directory: str) -> None:
+        """Writes the keyframes taken so far to directory/keyframes for Bin/driver -R to replay."""
+        _check(_lib.nsWriteResults(self._handle, directory.encode(), NS_WRITE_KEYFRAMES))
+
+    def close(self) -> None:
+        """Destroys the simulation, freeing the solver's memory."""
+        if self._handle:
+            _lib.nsDestroy(self._handle)
+            self._handle = c_void_p()
+
+    def __enter__(self) -> "Simulation":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        if getattr(self, "_handle", None):
+            self.close()
+
+if __name__ == "__main__":
+    from sys import argv
+
+    if len(argv) != 2:
+        raise SystemExit(f"\nUsage: {argv[0]} [graph file path]")
+
+    matrix, count = read_graph(argv[1])
+    with Simulation(matrix, count) as sim:
+        sim.run()
+        print(f"{count} neurons and {sim.steps_taken} steps ({sim.stop_reason})")
+        for neuron in range(count):
+            times, _ = sim.spikes(neuron)
+            print(f"\tneuron {neuron}: {len(times)} spikes")
\ No newline at end of file
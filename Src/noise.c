@@ -0,0 +1,95 @@
+/**
+ * @file noise.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the noise header file.
+ * @version 0.1
+ * @date 2022-10-05
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "noise.h"
+
+#include <stddef.h>
+#include <math.h>
+
+#define PHILOX_M0 0xD2511F53U   // The multiplier of the first word pair.
+#define PHILOX_M1 0xCD9E8D57U   // The multiplier of the second word pair.
+#define PHILOX_W0 0x9E3779B9U   // The increment of the first key word each round.
+#define PHILOX_W1 0xBB67AE85U   // The increment of the second key word each round.
+#define PHILOX_ROUNDS 10
+#define TWO_PI 6.283185307179586
+
+void calcPhilox(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        // Multiply the even words, then mix the halves of the products with the odd words and the key.
+        uint64_t product0 = (uint64_t) PHILOX_M0 * c0;
+        uint64_t product1 = (uint64_t) PHILOX_M1 * c2;
+        c0 = (uint32_t) (product1 >> 32) ^ c1 ^ k0;
+        c2 = (uint32_t) (product0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t) product1;
+        c3 = (uint32_t) product0;
+
+        // Bump the key.
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+}
+
+/**
+ * @brief Calculates the block of a (neuron, step, stream) counter.
+ *
+ * @param seed the seed of the generator.
+ * @param neuron the number of the neuron.
+ * @param step the number of the step (or block for the initial values).
+ * @param stream the stream (NOISE_STREAM_*).
+ * @param result where the four random words are stored.
+ */
+static void calcBlock(uint64_t seed, int neuron, int step, int stream, uint32_t result[4]) {
+    const uint32_t counter[4] = {(uint32_t) neuron, (uint32_t) step, 0, (uint32_t) stream};
+    const uint32_t key[2] = {(uint32_t) seed, (uint32_t) (seed >> 32)};
+    calcPhilox(counter, key, result);
+}
+
+float getNormal(uint64_t seed, int neuron, int step) {
+    uint32_t words[4];
+    calcBlock(seed, neuron, step, NOISE_STREAM_STEP, words);
+
+    // Box-Muller with u1 in (0, 1] so the logarithm is finite.
+    double u1 = (words[0] + 1.0) / 4294967296.0;
+    double u2 = words[1] / 4294967296.0;
+    return sqrt(-2.0 * log(u1)) * cos(TWO_PI * u2);
+}
+
+void addNoise(const NoiseParams *params, const NeuronIds *ids, int firstNeuron, int lastNeuron, float x[], int step, float stepSize) {
+    float scale = params->strength * sqrtf(stepSize);
+    if (scale == 0.0) {
+        return;
+    }
+
+    for (int neuron = firstNeuron; neuron < lastNeuron; ++neuron) {
+        x[neuron] += scale * getNormal(params->seed, ids != NULL ? ids->ids[neuron] : neuron, step);
+    }
+}
+
+void randomizeInits(const NoiseParams *params, const NeuronIds *ids, int neuronCount, int funcCount, const float inits[], float state[]) {
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        // Each block gives the uniform numbers of four functions.
+        uint32_t words[4];
+        for (int func = 0; func < funcCount; ++func) {
+            if (func % 4 == 0) {
+                calcBlock(params->seed, ids != NULL ? ids->ids[neuron] : neuron, func / 4, NOISE_STREAM_INITS, words);
+            }
+            float uniform = (words[func % 4] >> 8) / 16777216.0F;
+            state[func * neuronCount + neuron] = inits[func] + params->spread * (2.0F * uniform - 1.0F);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+/**
+ * @file noise.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that implements reproducible noise and random initial values using the Philox4x32-10
+ * counter-based generator.
+ * @version 0.1
+ * @date 2022-10-05
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef NOISE
+#define NOISE
+
+#include <stdint.h>
+
+#include "graph_manipulations.h"
+
+#define NOISE_STREAM_STEP 0     // The stream of the noise added to x at each step.
+#define NOISE_STREAM_INITS 1    // The stream of the random initial values.
+
+/**
+ * @brief A parameters structure which describes the noise. Every random number is a function of (seed, neuron, step,
+ * stream) alone, so it does not depend on the order neurons are calculated in or on which thread calculates them.
+ */
+typedef struct {
+    /**
+     * @brief The seed of the generator.
+     */
+    uint64_t seed;
+
+    /**
+     * @brief The standard deviation of the white noise added to x per unit of x (0 for none).
+     */
+    float strength;
+
+    /**
+     * @brief The half-width of the uniform range around the initial values that each neuron starts in (0 for none).
+     */
+    float spread;
+} NoiseParams;
+
+/**
+ * @brief Calculates one block of the Philox4x32-10 generator.
+ *
+ * @param counter the counter of the block.
+ * @param key the key of the generator.
+ * @param result where the four random words are stored.
+ */
+void calcPhilox(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+/**
+ * @brief Gets a standard normal random number for a neuron at a step.
+ *
+ * @param seed the seed of the generator.
+ * @param neuron the number of the neuron.
+ * @param step the number of the step.
+ * @return float - the random number.
+ */
+float getNormal(uint64_t seed, int neuron, int step);
+
+/**
+ * @brief Adds the noise of a step to x of a range of neurons (the Euler-Maruyama increment strength * sqrt(step) * N(0, 1)).
+ *
+ * @param params the noise parameters.
+ * @param ids the numbers of the neurons within the whole graph, which key their noise (NULL when the graph is whole).
+ * @param firstNeuron the first neuron of the range.
+ * @param lastNeuron one past the last neuron of the range.
+ * @param x the value of x of each neuron. Access using x[neuronNum].
+ * @param step the number of the completed step.
+ * @param stepSize the size of the step.
+ */
+void addNoise(const NoiseParams *params, const NeuronIds *ids, int firstNeuron, int lastNeuron, float x[], int step, float stepSize);
+
+/**
+ * @brief Sets the initial value of each function of every neuron to a uniform random number within spread of its
+ * initial value.
+ *
+ * @param params the noise parameters.
+ * @param ids the numbers of the neurons within the whole graph, which key their values (NULL when the graph is whole).
+ * @param neuronCount the number of neurons in the graph.
+ * @param funcCount the number of functions of each neuron.
+ * @param inits the initial value of each function. Access using inits[functionNum].
+ * @param state where the initial values are stored. Access using state[functionNum * neuronCount + neuronNum].
+ */
+void randomizeInits(const NoiseParams *params, const NeuronIds *ids, int neuronCount, int funcCount, const float inits[], float state[]);
+
+#endif
\ No newline at end of file
@@ -9,23 +9,321 @@
  */
 
 #include "numerical_methods.h"
+#include "result_cache.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <pthread.h>
+
+#define RK4_STABILITY_LIMIT 2.5F    // The largest step times linear coefficient a quiescent macro-step may take (RK4 is stable to about 2.78).
+
+/**
+ * @brief A step worker structure which holds the neurons of one partition and its own copy of their adjacency rows.
+ */
+typedef struct {
+    /**
+     * @brief The pool the worker belongs to.
+     */
+    struct WorkerPool *pool;
+
+    /**
+     * @brief The number of the worker (also the core it is pinned to).
+     */
+    int id;
+
+    /**
+     * @brief The first position and one past the last position of the partition.
+     */
+    int first, last;
+
+    /**
+     * @brief The neuron at each position (NULL when each neuron is at the position of its own number).
+     */
+    const int *neurons;
+
+    /**
+     * @brief The adjacency rows of the partition, allocated and copied by the worker so they sit on its node.
+     */
+    float *rows;
+
+    /**
+     * @brief The slopes of the neuron being calculated.
+     */
+    float *slopes;
+
+    /**
+     * @brief The inputs in the order of the neuron numbers, gathered by the worker before each stage when the neurons are
+     * listed (x of every neuron and every function of its own neurons; NULL for ranges of numbers). Access using
+     * inputs[functionNum * neuronCount + neuronNum].
+     */
+    float *inputs;
+} StepWorker;
+
+/**
+ * @brief A worker pool structure which takes the fourth-order Runge-Kutta steps of an integrator across pinned threads.
+ */
+struct WorkerPool {
+    /**
+     * @brief The worker threads.
+     */
+    pthread_t *threads;
+
+    /**
+     * @brief The worker of each thread.
+     */
+    StepWorker *workers;
+
+    /**
+     * @brief The number of workers.
+     */
+    int workerCount;
+
+    /**
+     * @brief Releases the workers into a step (every worker and the integrator thread wait on it).
+     */
+    pthread_barrier_t start;
+
+    /**
+     * @brief Releases the integrator thread once a step is done (every worker and the integrator thread wait on it).
+     */
+    pthread_barrier_t done;
+
+    /**
+     * @brief Separates the stages of a step (only the workers wait on it).
+     */
+    pthread_barrier_t stage;
+
+    /**
+     * @brief Held while the workers are started, so none waits on a barrier before it is sized for the started threads.
+     */
+    pthread_mutex_t gate;
+
+    /**
+     * @brief Whether the workers should exit once released.
+     */
+    int stop;
+
+    /**
+     * @brief A pointer to function that returns the result(s) of ODEs with given inputs.
+     */
+    void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]);
+
+    /**
+     * @brief The input graph.
+     */
+    Graph *graph;
+
+    /**
+     * @brief A copy of the lattice coupling the neurons instead of the graph (its coupling is NULL to couple through the
+     * graph). The workers share its coupling, each sweeping its own neurons.
+     */
+    Stencil stencil;
+
+    /**
+     * @brief The noise added to x (NULL for none).
+     */
+    NoiseParams *noise;
+
+    /**
+     * @brief The numbers of the neurons within the whole graph (NULL when the graph is whole).
+     */
+    NeuronIds *ids;
+
+    /**
+     * @brief The numbers within the whole graph of the neuron at each position, which key its noise.
+     */
+    NeuronIds positions;
+
+    /**
+     * @brief The number of neurons and functions.
+     */
+    int neuronCount, funcCount;
+
+    /**
+     * @brief The size of each step.
+     */
+    float step;
+
+    /**
+     * @brief The scratch memory the workers step, each neuron at its position so every partition is a contiguous slice.
+     * For ranges of numbers it is the scratch memory of the integrator. Access using state[functionNum * neuronCount +
+     * position] and k[kNum][position * funcCount + functionNum].
+     */
+    float *state, *inputs, *nextInputs, *k[4];
+
+    /**
+     * @brief The state of the integrator in the order of the neuron numbers, which the workers load from after it is set
+     * and store to after each step when the neurons are listed (state itself for ranges of numbers).
+     */
+    float *shared;
+
+    /**
+     * @brief The memory of the scratch arrays and of the numbers of the positions (NULL for ranges of numbers).
+     */
+    float *memory;
+    int *numbers;
+
+    /**
+     * @brief Whether the workers load the state of the integrator before the next step.
+     */
+    int load;
+
+    /**
+     * @brief The x position and number of the step being taken (set by the integrator thread before each step).
+     */
+    float curX;
+    int curStep;
+};
+
+/**
+ * @brief Initializes a recorder structure for an approximation.
+ * 
+ * @param cond the input conditions.
+ * @param sol the solution being approximated.
+ * @return Recorder - the initialized recorder structure.
+ */
+static Recorder initRecorder(EqConditions *cond, EqSolution *sol) {
+    Recorder recorder = {
+        .record = cond->record,
+        .spikeStart = -1,
+        .transient = cond->transient,
+        .converging = cond->convergence != NULL,
+        .failed = 0
+    };
+
+    if (sol->spikes != NULL) {
+        recorder.detector = initSpikeDetector(sol->neuronCount, cond->record->spikeThreshold);
+    }
+    if (recorder.converging) {
+        recorder.monitor = initConvergenceMonitor(cond->convergence, sol->neuronCount, cond->step);
+    }
+
+    return recorder;
+}
+
+/**
+ * @brief Stores the selected samples of a completed step, finds its spikes, and stops the solution if it has converged
+ * (or if memory could not be allocated to store the step, setting recorder->failed).
+ * 
+ * @param recorder the recorder.
+ * @param sol the solution being approximated (sol->x[step] must already be set).
+ * @param step the number of the completed step.
+ * @param neuronCount the number of neurons in the graph.
+ * @param state the value of each function for every neuron at the step. Access using state[functionNum][neuronNum].
+ * @return int - 1 if the solution was stopped at this step, otherwise 0.
+ */
+static int recordStep(Recorder *recorder, EqSolution *sol, int step, int neuronCount, float state[][neuronCount]) {
+    // Store the selected functions of the selected neurons.
+    if (step >= sol->recordFirst && step <= sol->recordLast && (step - sol->recordFirst) % sol->recordStride == 0) {
+        int sample = sol->sampleCount++;
+        sol->sampleX[sample] = sol->x[step];
+        for (int record = 0; record < sol->recordCount; ++record) {
+            for (int curFunc = 0; curFunc < sol->funcCount; ++curFunc) {
+                if (sol->approx[record][curFunc] != NULL) {
+                    sol->approx[record][curFunc][sample] = state[curFunc][sol->neurons[record]];
+                }
+                else if (sol->compressed != NULL && sol->compressed[record][curFunc].quantum > 0.0 &&
+                         !appendSample(&sol->compressed[record][curFunc], state[curFunc][sol->neurons[record]])) {
+                    recorder->failed = 1;
+                }
+            }
+        }
+    }
+
+    // Find the spikes after the transient (x is shifted to the transient step, matching findSpikes()).
+    if (sol->spikes != NULL) {
+        if (recorder->spikeStart < 0 && sol->x[step] >= recorder->transient) {
+            recorder->spikeStart = step;
+        }
+        if (recorder->spikeStart >= 0) {
+            for (int neuron = 0; neuron < neuronCount; ++neuron) {
+                if (detectSpike(&recorder->detector, neuron, state[0][neuron]) &&
+                    !appendPoint(&sol->spikes[neuron], sol->x[step - 1 - recorder->spikeStart], recorder->detector.prev[neuron])) {
+                    recorder->failed = 1;
+                }
+            }
+        }
+    }
+
+    // Stop at this step if it could not be stored, or early once the network has converged.
+    if (recorder->failed) {
+        return 1;
+    }
+    if (recorder->converging && step > 0) {
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            observeNeuron(&recorder->monitor, neuron, sol->x[step], state[0][neuron]);
+        }
+        if ((sol->stopReason = finishConvergenceStep(&recorder->monitor, sol->x[step], recorder->transient)) != STOP_END) {
+            sol->stepCount = step;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a recorder structure.
+ * 
+ * @param recorder the recorder to be freed.
+ * @param sol the solution that was approximated.
+ */
+static void freeRecorder(Recorder *recorder, EqSolution *sol) {
+    if (sol->spikes != NULL) {
+        freeSpikeDetector(&recorder->detector);
+    }
+    if (recorder->converging) {
+        freeConvergenceMonitor(&recorder->monitor);
+    }
+}
+
+/**
+ * @brief Calculates the coefficients of an ETD2RK step for a linear coefficient c: e^(ch), phi1 = (e^(ch) - 1) / c, 
+ * and phi2 = (e^(ch) - 1 - ch) / (c^2 h).
+ * 
+ * @param c the linear coefficient.
+ * @param h the size of the step.
+ * @param expLh where e^(ch) is stored.
+ * @param phi1 where phi1 is stored.
+ * @param phi2 where phi2 is stored.
+ */
+static void calcExponentialCoefficients(double c, double h, float *expLh, float *phi1, float *phi2) {
+    double z = c * h;
+    *expLh = exp(z);
+
+    // Use the Taylor series when z is small to avoid cancellation.
+    if (fabs(z) < 1e-4) {
+        *phi1 = h * (1.0 + z / 2.0 + z * z / 6.0);
+        *phi2 = h * (0.5 + z / 6.0 + z * z / 24.0);
+    }
+    else {
+        *phi1 = h * expm1(z) / z;
+        *phi2 = h * (expm1(z) - z) / (z * z);
+    }
+}
 
 EqConditions initEqConditions(float x0, float xEnd, float step, float transient, int funcCount) {
     EqConditions cond = {
         .x0 = x0,
         .xEnd = xEnd,
         .step = step,
-        .transient = transient
+        .transient = transient,
+        .convergence = NULL,
+        .synapses = NULL,
+        .stencil = NULL,
+        .noise = NULL,
+        .plasticity = NULL,
+        .ids = NULL,
+        .monitor = NULL,
+        .workspace = NULL,
+        .record = NULL
     };
 
     // Allocate heap memory for the initial values array.
     if ((cond.inits = (float *) malloc(funcCount * sizeof(float))) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+        return cond;
     }
 
     // Set the initial values to 0.
@@ -36,44 +334,118 @@ EqConditions initEqConditions(float x0, float xEnd, float step, float transient,
     return cond;
 }
 
-EqSolution initEqSolution(float x0, float xEnd, float step, int neuronCount, int funcCount) {
+/**
+ * @brief Frees what an unfinished solution structure has allocated so far and marks it as failed.
+ * 
+ * @param sol the solution (every array it has not allocated must be NULL).
+ * @return EqSolution - the solution with NULL arrays and nothing left to free.
+ */
+static EqSolution failEqSolution(EqSolution *sol) {
+    freeEqSolution(sol);
+    sol->x = sol->sampleX = NULL;
+    sol->neurons = NULL;
+    sol->approx = NULL;
+    sol->compressed = NULL;
+    sol->spikes = NULL;
+    sol->recordCount = 0;
+    return *sol;
+}
+
+EqSolution initEqSolution(float x0, float xEnd, float step, int neuronCount, int funcCount, RecordSpec *record) {
     // Calculate the step count and the number of bytes required.
     int stepCount = ceil((xEnd - x0) / step);
     int size = stepCount + 1;
-    int numBytes = size * sizeof(float);
+    size_t numBytes = (size_t) size * sizeof(float);
 
     EqSolution sol = {
         .neuronCount = neuronCount,
         .funcCount = funcCount,
-        .stepCount = stepCount
+        .stepCount = stepCount,
+        .sampleCount = 0,
+        .recordFirst = 0,
+        .recordLast = stepCount,
+        .recordStride = 1,
+        .recordCount = 0,
+        .x = NULL,
+        .sampleX = NULL,
+        .neurons = NULL,
+        .approx = NULL,
+        .compressed = NULL,
+        .spikes = NULL,
+        .stopReason = STOP_END,
+        .evalCount = 0
     };
+    int funcMask = (1 << funcCount) - 1;
 
-    // Allocate heap memory for the x array.
-    if ((sol.x = (float *) malloc(numBytes)) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+    // Find the steps to store (with some tolerance for the rounding of x).
+    if (record != NULL) {
+        funcMask = record->funcMask;
+        sol.recordStride = record->stride > 0 ? record->stride : 1;
+        int first = ceil((record->start - x0) / step - 1e-3);
+        int last = floor((record->end - x0) / step + 1e-3);
+        sol.recordFirst = first > 0 ? first : 0;
+        sol.recordLast = last < stepCount ? last : stepCount;
     }
+    int sampleCapacity = sol.recordLast >= sol.recordFirst ? (sol.recordLast - sol.recordFirst) / sol.recordStride + 1 : 0;
+    size_t sampleBytes = (size_t) (sampleCapacity ? sampleCapacity : 1) * sizeof(float);
 
-    // Allocate heap memory for the approximation of each neuron.
-    if ((sol.approx = (float ***) malloc(neuronCount * sizeof(float **))) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+    // Allocate heap memory for the x arrays.
+    if ((sol.x = (float *) malloc(numBytes)) == NULL || (sol.sampleX = (float *) malloc(sampleBytes)) == NULL) {
+        return failEqSolution(&sol);
     }
-    for (int neuron = 0; neuron < neuronCount; ++neuron) {
-        // Allocate heap memory for the approximation of each function.
-        if ((sol.approx[neuron] = (float **) malloc(funcCount * sizeof(float *))) == NULL) {
-            perror("malloc() failure");
-            exit(EXIT_FAILURE);
+
+    // Select the neurons to store (each must exist).
+    int recordCount = record != NULL && record->neurons != NULL ? record->neuronCount : neuronCount;
+    if ((sol.neurons = (int *) malloc((recordCount ? recordCount : 1) * sizeof(int))) == NULL) {
+        return failEqSolution(&sol);
+    }
+    for (int i = 0; i < recordCount; ++i) {
+        sol.neurons[i] = record != NULL && record->neurons != NULL ? record->neurons[i] : i;
+        if (sol.neurons[i] < 0 || sol.neurons[i] >= neuronCount) {
+            return failEqSolution(&sol);
+        }
+    }
+
+    // Allocate zeroed heap memory for the approximation of each stored neuron.
+    if ((sol.approx = (float ***) calloc(recordCount ? recordCount : 1, sizeof(float **))) == NULL) {
+        return failEqSolution(&sol);
+    }
+    if (record != NULL && record->quantum > 0.0 &&
+        (sol.compressed = (CompressedTrajectory **) calloc(recordCount ? recordCount : 1, sizeof(CompressedTrajectory *))) == NULL) {
+        return failEqSolution(&sol);
+    }
+    sol.recordCount = recordCount;
+    for (int rec = 0; rec < sol.recordCount; ++rec) {
+        // Allocate zeroed heap memory for the approximation of each function.
+        if ((sol.approx[rec] = (float **) calloc(funcCount, sizeof(float *))) == NULL) {
+            return failEqSolution(&sol);
         }        
         for (int func = 0; func < funcCount; ++func) {
-            // Allocate heap memory for the approximation of each step + 1 (for the initial position).
-            if ((sol.approx[neuron][func] = (float *) malloc(numBytes)) == NULL) {
-                perror("malloc() failure");
-                exit(EXIT_FAILURE);
+            // Allocate heap memory for each stored sample of the selected functions.
+            if (sol.compressed == NULL && funcMask & (1 << func) && (sol.approx[rec][func] = (float *) malloc(sampleBytes)) == NULL) {
+                return failEqSolution(&sol);
             }            
         }
+
+        // Or start the compressed samples of the selected functions (the others stay empty, with no quantum).
+        if (sol.compressed == NULL) {
+            continue;
+        }
+        if ((sol.compressed[rec] = (CompressedTrajectory *) calloc(funcCount, sizeof(CompressedTrajectory))) == NULL) {
+            return failEqSolution(&sol);
+        }
+        for (int func = 0; func < funcCount; ++func) {
+            if (funcMask & (1 << func) && (sol.compressed[rec][func] = initTrajectory(record->quantum, sampleCapacity)).blocks == NULL) {
+                return failEqSolution(&sol);
+            }
+        }
     }    
 
+    // Allocate zeroed heap memory for the spikes of every neuron.
+    if (record != NULL && record->spikes && (sol.spikes = (Points *) calloc(neuronCount, sizeof(Points))) == NULL) {
+        return failEqSolution(&sol);
+    }
+
     return sol;
 }
 
@@ -101,84 +473,1120 @@ EqSolution initEqSolution(float x0, float xEnd, float step, int neuronCount, int
 //     }
 // }
 
-EqSolution runRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, float result[]), EqConditions *cond, Graph *graph, int funcCount) {
-    EqSolution sol = initEqSolution(cond->x0, cond->xEnd, cond->step, graph->vertexCount, funcCount);
+/**
+ * @brief Finds the spikes of a completed step and updates the plastic weights of the neurons that spiked (setting
+ * recorder.failed if memory could not be allocated for a snapshot of the weights).
+ * 
+ * @param integ the integrator (integ->curStep is the step being completed and its x position must already be set).
+ * @param x the value of x of each neuron at the end of the step. Access using x[neuronNum].
+ */
+static void learnStep(Integrator *integ, float x[]) {
+    for (int neuron = 0; neuron < integ->sol.neuronCount; ++neuron) {
+        detectPlasticSpike(&integ->plasticity, neuron, x[neuron]);
+    }
+    if (!applyPlasticity(&integ->plasticity, integ->sol.x[integ->curStep], integ->sol.x[integ->curStep + 1])) {
+        integ->recorder.failed = 1;
+    }
+}
 
-    // Assign initial values for each function of each neuron and x.
-    float inputs[funcCount][sol.neuronCount]; 
-    for (int neuron = 0; neuron < sol.neuronCount; ++neuron) {
+/**
+ * @brief Calculates the slopes of a neuron, coupling it through the lattice or through its adjacency row.
+ * 
+ * @param integ the integrator.
+ * @param inputs the inputs for each function for every neuron. Access using inputs[functionNum][neuronNum].
+ * @param curX the current x position.
+ * @param neuron the number of the neuron.
+ * @param slopes where the slope of each function is stored.
+ */
+static void calcCoupledSlopes(Integrator *integ, float inputs[][integ->sol.neuronCount], float curX, int neuron, float slopes[]) {
+    if (integ->cond->stencil != NULL) {
+        integ->getODEs(integ->sol.neuronCount, inputs, curX, NULL, neuron, integ->cond->ids, slopes);
+        slopes[0] -= calcStencilCoupling(&integ->stencil, inputs[0], neuron);
+    }
+    else {
+        integ->getODEs(integ->sol.neuronCount, inputs, curX, integ->graph->adjMatrix[neuron], neuron, integ->cond->ids, slopes);
+    }
+}
+
+/**
+ * @brief Calculates the diagonal linear coefficients of a neuron, coupling it through the lattice or through its adjacency row.
+ * 
+ * @param integ the integrator.
+ * @param inputs the inputs for each function for every neuron. Access using inputs[functionNum][neuronNum].
+ * @param neuron the number of the neuron.
+ * @param result where the linear coefficient of each function is stored.
+ */
+static void calcCoupledLinear(Integrator *integ, float inputs[][integ->sol.neuronCount], int neuron, float result[]) {
+    if (integ->cond->stencil != NULL) {
+        integ->getLinear(integ->sol.neuronCount, inputs, NULL, neuron, result);
+        result[0] -= getStencilDegree(&integ->stencil, neuron);
+    }
+    else {
+        integ->getLinear(integ->sol.neuronCount, inputs, integ->graph->adjMatrix[neuron], neuron, result);
+    }
+}
+
+/**
+ * @brief Takes one fourth-order Runge-Kutta step.
+ * 
+ * @param integ the integrator.
+ * @return int - the number of steps taken.
+ */
+static int stepRungeKutta(Integrator *integ) {
+    EqConditions *cond = integ->cond;
+    EqSolution *sol = &integ->sol;
+    int neuronCount = sol->neuronCount, funcCount = sol->funcCount, curStep = integ->curStep;
+    float (*state)[neuronCount] = (float (*)[neuronCount]) integ->state;
+    float (*inputs)[neuronCount] = (float (*)[neuronCount]) integ->inputs;
+    float (*nextInputs)[neuronCount] = (float (*)[neuronCount]) integ->nextInputs;
+    float (*k[4])[funcCount];
+    for (int curK = 0; curK < 4; ++curK) {
+        k[curK] = (float (*)[funcCount]) integ->k[curK];
+    }
+    float *slopes = integ->slopes;
+
+    // Deliver the presynaptic spikes that have arrived.
+    if (cond->synapses != NULL) {
+        deliverSpikes(&integ->synapses, sol->x[curStep]);
+    }
+
+    // Calculate k1-4 for each function, building the inputs of the next k (or step) as each neuron finishes.
+    const double stageOffsets[4] = {0.0, 0.5, 0.5, 1.0};
+    for (int curK = 0; curK < 4; ++curK) {
+        float curX = sol->x[curStep] + stageOffsets[curK] * cond->step;
+        if (cond->stencil != NULL) {
+            sweepStencil(&integ->stencil, inputs[0], 0, neuronCount);
+        }
+
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            // Calculate slopes.
+            if (cond->synapses != NULL) {
+                integ->getODEs(neuronCount, inputs, curX, NULL, neuron, cond->ids, slopes);
+                slopes[0] += calcSynapticCurrent(&integ->synapses, neuron, inputs[0][neuron], curX - sol->x[curStep]);
+            }
+            else if (cond->stencil != NULL) {
+                integ->getODEs(neuronCount, inputs, curX, NULL, neuron, cond->ids, slopes);
+                slopes[0] -= integ->stencil.coupling[neuron];
+            }
+            else {
+                integ->getODEs(neuronCount, inputs, curX, integ->graph->adjMatrix[neuron], neuron, cond->ids, slopes);
+            }
+            ++sol->evalCount;
+
+            for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                k[curK][neuron][curFunc] = cond->step * slopes[curFunc];
+
+                if (curK < 3) {
+                    // Calculate the input of this function for the next k.
+                    nextInputs[curFunc][neuron] = state[curFunc][neuron] + stageOffsets[curK + 1] * k[curK][neuron][curFunc];
+                }
+                else {
+                    // Calculate the approximation, which is also the input of the next step.
+                    state[curFunc][neuron] = state[curFunc][neuron] + (k[0][neuron][curFunc] + k[1][neuron][curFunc] + k[1][neuron][curFunc] + k[2][neuron][curFunc] + k[2][neuron][curFunc] + k[3][neuron][curFunc]) / 6.0;
+                    nextInputs[curFunc][neuron] = state[curFunc][neuron];
+                }
+            }
+        }
+
+        // The inputs just built become the current inputs.
+        float (*swap)[neuronCount] = inputs;
+        inputs = nextInputs;
+        nextInputs = swap;
+    }
+
+    // Add the noise of the step to x, which is also the input of the next step.
+    if (cond->noise != NULL) {
+        addNoise(cond->noise, cond->ids, 0, neuronCount, state[0], curStep + 1, cond->step);
+        memcpy(inputs[0], state[0], neuronCount * sizeof(float));
+    }
+
+    // Calculate next step in the x direction.
+    sol->x[curStep + 1] = sol->x[curStep] + cond->step;        
+
+    // Queue the new presynaptic spikes and decay the conductances.
+    if (cond->synapses != NULL) {
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            if (!detectSynapticSpike(&integ->synapses, neuron, state[0][neuron], sol->x[curStep])) {
+                integ->recorder.failed = 1;
+            }
+        }
+        decayConductances(&integ->synapses, cond->step);
+    }
+
+    // Update the weights of the neurons that spiked.
+    if (integ->plasticity.graph != NULL) {
+        learnStep(integ, state[0]);
+    }
+
+    // Store the step (this ends the approximation early once the network has converged).
+    integ->curStep = curStep + 1;
+    recordStep(&integ->recorder, sol, curStep + 1, neuronCount, state);
+
+    return 1;
+}
+
+/**
+ * @brief Takes the fourth-order Runge-Kutta step of the neurons of a worker. The workers meet between stages, since each 
+ * stage reads the inputs of every neuron built by the last one.
+ * 
+ * @param worker the worker.
+ */
+static void stepPartition(StepWorker *worker) {
+    struct WorkerPool *pool = worker->pool;
+    int neuronCount = pool->neuronCount, funcCount = pool->funcCount;
+    float (*state)[neuronCount] = (float (*)[neuronCount]) pool->state;
+    float (*inputs)[neuronCount] = (float (*)[neuronCount]) pool->inputs;
+    float (*nextInputs)[neuronCount] = (float (*)[neuronCount]) pool->nextInputs;
+    float (*shared)[neuronCount] = (float (*)[neuronCount]) pool->shared;
+    float (*k[4])[funcCount];
+    for (int curK = 0; curK < 4; ++curK) {
+        k[curK] = (float (*)[funcCount]) pool->k[curK];
+    }
+    float (*rows)[neuronCount] = (float (*)[neuronCount]) worker->rows;
+    float *slopes = worker->slopes;
+
+    // Load the state of the integrator into the positions of the partition once it was set or restored.
+    if (pool->load) {
+        for (int at = worker->first; at < worker->last; ++at) {
+            for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                state[curFunc][at] = inputs[curFunc][at] = shared[curFunc][worker->neurons[at]];
+            }
+        }
+        pthread_barrier_wait(&pool->stage);
+    }
+
+    // Calculate k1-4 for each function of the partition, exactly as stepRungeKutta() does for every neuron.
+    const double stageOffsets[4] = {0.0, 0.5, 0.5, 1.0};
+    for (int curK = 0; curK < 4; ++curK) {
+        float curX = pool->curX + stageOffsets[curK] * pool->step;
+        if (pool->stencil.coupling != NULL) {
+            sweepStencil(&pool->stencil, inputs[0], worker->first, worker->last);
+        }
+
+        // Gather the listed inputs back into the order of the numbers, so the coupling sums over the neurons in order.
+        float (*coupled)[neuronCount] = inputs;
+        if (worker->inputs != NULL) {
+            coupled = (float (*)[neuronCount]) worker->inputs;
+            for (int at = 0; at < neuronCount; ++at) {
+                coupled[0][worker->neurons[at]] = inputs[0][at];
+            }
+            for (int at = worker->first; at < worker->last; ++at) {
+                for (int curFunc = 1; curFunc < funcCount; ++curFunc) {
+                    coupled[curFunc][worker->neurons[at]] = inputs[curFunc][at];
+                }
+            }
+        }
+
+        for (int at = worker->first; at < worker->last; ++at) {
+            int neuron = worker->neurons != NULL ? worker->neurons[at] : at;
+            pool->getODEs(neuronCount, coupled, curX, pool->stencil.coupling != NULL ? NULL : rows[at - worker->first], neuron, pool->ids, slopes);
+            if (pool->stencil.coupling != NULL) {
+                slopes[0] -= pool->stencil.coupling[neuron];
+            }
+
+            for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                k[curK][at][curFunc] = pool->step * slopes[curFunc];
+
+                if (curK < 3) {
+                    nextInputs[curFunc][at] = state[curFunc][at] + stageOffsets[curK + 1] * k[curK][at][curFunc];
+                }
+                else {
+                    state[curFunc][at] = state[curFunc][at] + (k[0][at][curFunc] + k[1][at][curFunc] + k[1][at][curFunc] + k[2][at][curFunc] + k[2][at][curFunc] + k[3][at][curFunc]) / 6.0;
+                    nextInputs[curFunc][at] = state[curFunc][at];
+                }
+            }
+        }
+
+        // The inputs just built become the current inputs once every partition has built them.
+        float (*swap)[neuronCount] = inputs;
+        inputs = nextInputs;
+        nextInputs = swap;
+        if (curK < 3) {
+            pthread_barrier_wait(&pool->stage);
+        }
+    }
+
+    // Add the noise of the step to x of the partition (the noise of each neuron depends only on its number and the step).
+    if (pool->noise != NULL) {
+        addNoise(pool->noise, worker->neurons != NULL ? &pool->positions : pool->ids, worker->first, worker->last, state[0], pool->curStep + 1, pool->step);
+        memcpy(&inputs[0][worker->first], &state[0][worker->first], (worker->last - worker->first) * sizeof(float));
+    }
+
+    // Store the state of the listed neurons for the integrator to record.
+    for (int at = worker->first; at < worker->last && worker->neurons != NULL; ++at) {
         for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
-            sol.approx[neuron][curFunc][0] = cond->inits[curFunc];
+            shared[curFunc][worker->neurons[at]] = state[curFunc][at];
         }
     }
-    sol.x[0] = cond->x0;
+}
+
+/**
+ * @brief Runs a step worker thread until its pool is stopped.
+ * 
+ * @param arg the worker.
+ * @return void* - NULL.
+ */
+static void *runStepWorker(void *arg) {
+    StepWorker *worker = (StepWorker *) arg;
+    struct WorkerPool *pool = worker->pool;
+    int neuronCount = pool->neuronCount, funcCount = pool->funcCount, size = worker->last - worker->first;
+    pinThread(worker->id);
+
+    // Touch the slices of the partition first so their pages are placed on the node of this thread (listed neurons are
+    // stepped at their positions, so every partition is a contiguous slice).
+    for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+        memset(&pool->state[curFunc * neuronCount + worker->first], 0, size * sizeof(float));
+        memset(&pool->inputs[curFunc * neuronCount + worker->first], 0, size * sizeof(float));
+        memset(&pool->nextInputs[curFunc * neuronCount + worker->first], 0, size * sizeof(float));
+    }
+    for (int curK = 0; curK < 4; ++curK) {
+        memset(&pool->k[curK][(size_t) worker->first * funcCount], 0, (size_t) size * funcCount * sizeof(float));
+    }
+
+    // Copy the adjacency rows of the partition (a lattice needs none), and make room to gather the inputs into the order
+    // of the numbers if the neurons are listed. If memory cannot be allocated the pool stops.
+    size_t rowBytes = pool->stencil.coupling != NULL ? sizeof(float) : (size_t) size * neuronCount * sizeof(float);
+    if (worker->neurons != NULL) {
+        worker->inputs = (float *) malloc((size_t) funcCount * neuronCount * sizeof(float));
+    }
+    if ((worker->rows = (float *) malloc(rowBytes)) != NULL && (worker->slopes = (float *) malloc(funcCount * sizeof(float))) != NULL) {
+        for (int at = worker->first; at < worker->last && pool->stencil.coupling == NULL; ++at) {
+            int neuron = worker->neurons != NULL ? worker->neurons[at] : at;
+            memcpy(&worker->rows[(size_t) (at - worker->first) * neuronCount], pool->graph->adjMatrix[neuron], neuronCount * sizeof(float));
+        }
+    }
+    pthread_mutex_lock(&pool->gate);
+    pthread_mutex_unlock(&pool->gate);
+    pthread_barrier_wait(&pool->start);
+
+    // Take a step each time the pool is released.
+    while (1) {
+        pthread_barrier_wait(&pool->start);
+        if (pool->stop) {
+            break;
+        }
+        stepPartition(worker);
+        pthread_barrier_wait(&pool->done);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Stops the worker threads of a pool and frees it.
+ * 
+ * @param pool the pool to be stopped.
+ */
+static void stopWorkerPool(struct WorkerPool *pool) {
+    // Release the workers with the stop flag set.
+    pool->stop = 1;
+    pthread_barrier_wait(&pool->start);
+    for (int w = 0; w < pool->workerCount; ++w) {
+        pthread_join(pool->threads[w], NULL);
+        free(pool->workers[w].rows);
+        free(pool->workers[w].slopes);
+        free(pool->workers[w].inputs);
+    }
+
+    pthread_barrier_destroy(&pool->start);
+    pthread_barrier_destroy(&pool->done);
+    pthread_barrier_destroy(&pool->stage);
+    pthread_mutex_destroy(&pool->gate);
+    free(pool->workers);
+    free(pool->threads);
+    free(pool->memory);
+    free(pool->numbers);
+    free(pool);
+}
 
-    // Begin Runge-Kutta method.
-    float k[4][sol.neuronCount][funcCount], slopes[funcCount];
-    for (int curStep = 0; curStep < sol.stepCount; ++curStep) {
-        // Calculate k1-4 for each function.
+/**
+ * @brief Starts a worker thread for each partition of an integrator. Returns once every worker has placed its slices 
+ * of the scratch memory, so the initial values must be assigned after. Listed neurons are stepped in memory of the pool
+ * holding each neuron at its position in the list, which the workers load from the state of the integrator before the
+ * first step and store back to after each step.
+ * 
+ * @param integ the integrator (its scratch memory and partition must already be set).
+ * @return struct WorkerPool* - the started pool (stop with stopWorkerPool()), or NULL if memory or a thread could not
+ * be allocated.
+ */
+static struct WorkerPool *startWorkerPool(Integrator *integ) {
+    struct WorkerPool *pool;
+    int workerCount = integ->partition.count;
+    if ((pool = (struct WorkerPool *) malloc(sizeof(struct WorkerPool))) == NULL) {
+        return NULL;
+    }
+    pool->threads = (pthread_t *) malloc(workerCount * sizeof(pthread_t));
+    pool->workers = (StepWorker *) malloc(workerCount * sizeof(StepWorker));
+    if (pool->threads == NULL || pool->workers == NULL) {
+        free(pool->threads);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    pool->stop = 0;
+    pool->getODEs = integ->getODEs;
+    pool->graph = integ->graph;
+    pool->stencil = integ->stencil;
+    pool->noise = integ->cond->noise;
+    pool->ids = integ->cond->ids;
+    pool->neuronCount = integ->sol.neuronCount;
+    pool->funcCount = integ->sol.funcCount;
+    pool->step = integ->cond->step;
+    pool->state = integ->state;
+    pool->inputs = integ->inputs;
+    pool->nextInputs = integ->nextInputs;
+    for (int curK = 0; curK < 4; ++curK) {
+        pool->k[curK] = integ->k[curK];
+    }
+    pool->shared = integ->state;
+    pool->memory = NULL;
+    pool->numbers = NULL;
+    pool->load = 0;
+
+    // Give listed neurons memory of their own, and the numbers within the whole graph of each position to key the noise.
+    int neuronCount = pool->neuronCount;
+    if (integ->partition.neurons != NULL) {
+        size_t stateSize = (size_t) pool->funcCount * neuronCount;
+        pool->memory = (float *) malloc(7 * stateSize * sizeof(float));
+        pool->numbers = (int *) malloc(neuronCount * sizeof(int));
+        if (pool->memory == NULL || pool->numbers == NULL) {
+            free(pool->memory);
+            free(pool->numbers);
+            free(pool->threads);
+            free(pool->workers);
+            free(pool);
+            return NULL;
+        }
+        pool->state = pool->memory;
+        pool->inputs = pool->memory + stateSize;
+        pool->nextInputs = pool->memory + 2 * stateSize;
         for (int curK = 0; curK < 4; ++curK) {
-            // Calculate inputs of each neuron for the current k.
-            for (int neuron = 0; neuron < sol.neuronCount; ++neuron) {
+            pool->k[curK] = pool->memory + (3 + curK) * stateSize;
+        }
+        for (int at = 0; at < neuronCount; ++at) {
+            int neuron = integ->partition.neurons[at];
+            pool->numbers[at] = pool->ids != NULL ? pool->ids->ids[neuron] : neuron;
+        }
+        pool->positions = (NeuronIds) {.ids = pool->numbers, .total = pool->ids != NULL ? pool->ids->total : neuronCount};
+        pool->load = 1;
+    }
+    pthread_mutex_init(&pool->gate, NULL);
+
+    // Start a worker for each partition, then size the barriers for the workers that started.
+    pthread_mutex_lock(&pool->gate);
+    int started = 0;
+    while (started < workerCount) {
+        pool->workers[started] = (StepWorker) {
+            .pool = pool,
+            .id = started,
+            .first = integ->partition.first[started],
+            .last = integ->partition.first[started + 1],
+            .neurons = integ->partition.neurons
+        };
+        if (pthread_create(&pool->threads[started], NULL, runStepWorker, &pool->workers[started]) != 0) {
+            break;
+        }
+        ++started;
+    }
+    pool->workerCount = started;
+    pthread_barrier_init(&pool->start, NULL, started + 1);
+    pthread_barrier_init(&pool->done, NULL, started + 1);
+    pthread_barrier_init(&pool->stage, NULL, started ? started : 1);
+    pthread_mutex_unlock(&pool->gate);
+
+    // Wait for the workers to place their memory, and stop them if any could not start or allocate its rows.
+    pthread_barrier_wait(&pool->start);
+    int failed = started < workerCount;
+    for (int w = 0; w < started; ++w) {
+        failed = failed || pool->workers[w].rows == NULL || pool->workers[w].slopes == NULL || (pool->memory != NULL && pool->workers[w].inputs == NULL);
+    }
+    if (failed) {
+        stopWorkerPool(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+/**
+ * @brief Takes one fourth-order Runge-Kutta step across the worker threads of an integrator.
+ * 
+ * @param integ the integrator.
+ * @return int - the number of steps taken.
+ */
+static int stepParallel(Integrator *integ) {
+    EqSolution *sol = &integ->sol;
+    int neuronCount = sol->neuronCount, curStep = integ->curStep;
+
+    // Release the workers into the step and wait for them to finish it.
+    integ->pool->curX = sol->x[curStep];
+    integ->pool->curStep = curStep;
+    pthread_barrier_wait(&integ->pool->start);
+    pthread_barrier_wait(&integ->pool->done);
+    integ->pool->load = 0;
+    sol->evalCount += 4L * neuronCount;
+
+    // Calculate next step in the x direction.
+    sol->x[curStep + 1] = sol->x[curStep] + integ->cond->step;
+
+    // Store the step (this ends the approximation early once the network has converged).
+    integ->curStep = curStep + 1;
+    recordStep(&integ->recorder, sol, curStep + 1, neuronCount, (float (*)[neuronCount]) integ->state);
+
+    return 1;
+}
+
+/**
+ * @brief Takes one multirate fourth-order Runge-Kutta macro-step (redoing it until no quiescent neuron becomes active).
+ * 
+ * @param integ the integrator.
+ * @param maxSteps the most micro-steps the macro-step may span.
+ * @return int - the number of steps taken.
+ */
+static int stepMultirate(Integrator *integ, int maxSteps) {
+    EqConditions *cond = integ->cond;
+    EqSolution *sol = &integ->sol;
+    int neuronCount = sol->neuronCount, funcCount = sol->funcCount, macroStart = integ->curStep;
+    float activityThreshold = integ->activityThreshold;
+    float (*history)[funcCount][neuronCount] = (float (*)[funcCount][neuronCount]) integ->state;
+    float (*inputs)[neuronCount] = (float (*)[neuronCount]) integ->inputs;
+    float (*predicted)[neuronCount] = (float (*)[neuronCount]) integ->predicted;
+    float (*k[4])[funcCount];
+    for (int curK = 0; curK < 4; ++curK) {
+        k[curK] = (float (*)[funcCount]) integ->k[curK];
+    }
+    float *recentMax = integ->recentMax, *slopes = integ->slopes;
+    int *active = integ->active, *quiet = integ->quiet;
+
+    int microCount = integ->ratio < sol->stepCount - macroStart ? integ->ratio : sol->stepCount - macroStart;
+    microCount = microCount < maxSteps ? microCount : maxSteps;
+    float macroStep = microCount * cond->step;
+
+    // Calculate the x values within the macro-step.
+    for (int micro = 0; micro < microCount; ++micro) {
+        sol->x[macroStart + micro + 1] = sol->x[macroStart + micro] + cond->step;
+    }
+
+    const float stageOffsets[4] = {0.0, 0.5, 0.5, 1.0};
+    int rejected;
+    do {
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                inputs[curFunc][neuron] = history[0][curFunc][neuron];
+            }
+        }
+
+        // Split the neurons by their activity over the last macro-step (a neuron too stiff for the macro-step stays active).
+        int activeCount = 0, quietCount = 0;
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            int stable = 1;
+            if (recentMax[neuron] < activityThreshold && integ->getLinear != NULL) {
+                calcCoupledLinear(integ, inputs, neuron, slopes);
                 for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
-                    switch (curK) {
-                        case 0:
-                            inputs[curFunc][neuron] = sol.approx[neuron][curFunc][curStep];
-                            break;
-                        case 1:
-                            inputs[curFunc][neuron] = sol.approx[neuron][curFunc][curStep] + 0.5 * k[0][neuron][curFunc];
-                            break;
-                        case 2:
-                            inputs[curFunc][neuron] = sol.approx[neuron][curFunc][curStep] + 0.5 * k[1][neuron][curFunc];
-                            break;
-                        case 3:
-                            inputs[curFunc][neuron] = sol.approx[neuron][curFunc][curStep] + k[2][neuron][curFunc];
-                            break;
+                    stable &= fabsf(slopes[curFunc]) * macroStep <= RK4_STABILITY_LIMIT;
+                }
+            }
+            if (recentMax[neuron] >= activityThreshold || !stable) {
+                active[activeCount++] = neuron;
+            }
+            else {
+                quiet[quietCount++] = neuron;
+            }
+        }
+
+        // Calculate k1 of the quiescent neurons and predict their macro-step end with it.
+        for (int q = 0; q < quietCount; ++q) {
+            calcCoupledSlopes(integ, inputs, sol->x[macroStart], quiet[q], slopes);
+            ++sol->evalCount;
+            for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                k[0][quiet[q]][curFunc] = macroStep * slopes[curFunc];
+                predicted[curFunc][quiet[q]] = history[0][curFunc][quiet[q]] + k[0][quiet[q]][curFunc];
+            }
+        }
+
+        // Take the micro-steps of the active neurons, interpolating the quiescent neurons they couple to.
+        for (int micro = 0; micro < microCount; ++micro) {
+            int curStep = macroStart + micro;
+            for (int curK = 0; curK < 4; ++curK) {
+                float weight = (micro + stageOffsets[curK]) / microCount;
+                for (int q = 0; q < quietCount; ++q) {
+                    for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                        inputs[curFunc][quiet[q]] = history[0][curFunc][quiet[q]] + weight * (predicted[curFunc][quiet[q]] - history[0][curFunc][quiet[q]]);
                     }
                 }
-            }                                
-            
-            // Calculate curX.
-            float curX = sol.x[curStep];
-            switch (curK) {
-                case 1:
-                case 2:
-                    curX += 0.5 * cond->step;
-                    break;
-                case 3:
-                    curX += cond->step;
-                    break;
-            }
-
-            for (int neuron = 0; neuron < sol.neuronCount; ++neuron) {
-                // Calculate slopes.
-                getODEs(sol.neuronCount, inputs, curX, graph->adjMatrix[neuron], neuron, slopes);
-
-                // Calculate curK.
+                for (int a = 0; a < activeCount; ++a) {
+                    for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                        inputs[curFunc][active[a]] = history[micro][curFunc][active[a]] + (curK ? stageOffsets[curK] * k[curK - 1][active[a]][curFunc] : 0.0);
+                    }
+                }
+
+                float curX = sol->x[curStep] + stageOffsets[curK] * cond->step;
+                for (int a = 0; a < activeCount; ++a) {
+                    calcCoupledSlopes(integ, inputs, curX, active[a], slopes);
+                    ++sol->evalCount;
+                    for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                        k[curK][active[a]][curFunc] = cond->step * slopes[curFunc];
+                    }
+                }
+            }
+
+            for (int a = 0; a < activeCount; ++a) {
                 for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
-                    k[curK][neuron][curFunc] = cond->step * slopes[curFunc];
+                    history[micro + 1][curFunc][active[a]] = history[micro][curFunc][active[a]] + (k[0][active[a]][curFunc] + k[1][active[a]][curFunc] + k[1][active[a]][curFunc] + k[2][active[a]][curFunc] + k[2][active[a]][curFunc] + k[3][active[a]][curFunc]) / 6.0;
                 }
-            }            
+            }
         }
 
-        // Calculate approximation for each function of each neuron.
-        for (int neuron = 0; neuron < sol.neuronCount; ++neuron) {
+        // Calculate k2-4 of the quiescent neurons, interpolating the finished micro-steps of the active neurons.
+        for (int curK = 1; curK < 4 && quietCount; ++curK) {
+            float position = stageOffsets[curK] * microCount;
+            int before = position;
+            float fraction = position - before;
+            for (int a = 0; a < activeCount; ++a) {
+                for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                    float value = history[before][curFunc][active[a]];
+                    inputs[curFunc][active[a]] = before < microCount ? value + fraction * (history[before + 1][curFunc][active[a]] - value) : value;
+                }
+            }
+            for (int q = 0; q < quietCount; ++q) {
+                for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                    inputs[curFunc][quiet[q]] = history[0][curFunc][quiet[q]] + stageOffsets[curK] * k[curK - 1][quiet[q]][curFunc];
+                }
+            }
+
+            float curX = sol->x[macroStart] + stageOffsets[curK] * macroStep;
+            for (int q = 0; q < quietCount; ++q) {
+                calcCoupledSlopes(integ, inputs, curX, quiet[q], slopes);
+                ++sol->evalCount;
+                for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+                    k[curK][quiet[q]][curFunc] = macroStep * slopes[curFunc];
+                }
+            }
+        }
+
+        // Redo the macro-step with micro-steps for any quiescent neuron that became active during it.
+        rejected = 0;
+        for (int q = 0; q < quietCount; ++q) {
+            float last = history[0][0][quiet[q]] + (k[0][quiet[q]][0] + k[1][quiet[q]][0] + k[1][quiet[q]][0] + k[2][quiet[q]][0] + k[2][quiet[q]][0] + k[3][quiet[q]][0]) / 6.0;
+            if (!(last < activityThreshold)) {
+                recentMax[quiet[q]] = activityThreshold;
+                rejected = 1;
+            }
+        }
+
+        // Calculate the macro-step end of the quiescent neurons and fill the steps between by linear interpolation.
+        for (int q = 0; q < quietCount && !rejected; ++q) {
             for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
-                sol.approx[neuron][curFunc][curStep + 1] = sol.approx[neuron][curFunc][curStep] + (k[0][neuron][curFunc] + k[1][neuron][curFunc] + k[1][neuron][curFunc] + k[2][neuron][curFunc] + k[2][neuron][curFunc] + k[3][neuron][curFunc]) / 6.0;
+                float first = history[0][curFunc][quiet[q]];
+                float last = first + (k[0][quiet[q]][curFunc] + k[1][quiet[q]][curFunc] + k[1][quiet[q]][curFunc] + k[2][quiet[q]][curFunc] + k[2][quiet[q]][curFunc] + k[3][quiet[q]][curFunc]) / 6.0;
+                for (int micro = 1; micro <= microCount; ++micro) {
+                    history[micro][curFunc][quiet[q]] = first + (last - first) * micro / microCount;
+                }
+            }
+        }
+    } while (rejected);
+
+    // Add the noise of each micro-step to x, carrying the noise of the earlier micro-steps forward.
+    if (cond->noise != NULL && cond->noise->strength != 0.0) {
+        float scale = cond->noise->strength * sqrtf(cond->step);
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            float offset = 0.0;
+            for (int micro = 1; micro <= microCount; ++micro) {
+                offset += scale * getNormal(cond->noise->seed, cond->ids != NULL ? cond->ids->ids[neuron] : neuron, macroStart + micro);
+                history[micro][0][neuron] += offset;
             }
         }
-        
-        // Calculate next step in the x direction.
-        sol.x[curStep + 1] = sol.x[curStep] + cond->step;        
     }
 
-    return sol;
+    // Track the activity of each neuron over this macro-step.
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        recentMax[neuron] = history[0][0][neuron];
+        for (int micro = 1; micro <= microCount; ++micro) {
+            if (history[micro][0][neuron] > recentMax[neuron]) {
+                recentMax[neuron] = history[micro][0][neuron];
+            }
+        }
+    }
+
+    // Store the micro-steps (this ends the approximation early once the network has converged).
+    int taken = 0;
+    while (taken < microCount && !recordStep(&integ->recorder, sol, macroStart + taken + 1, neuronCount, history[taken + 1])) {
+        ++taken;
+    }
+    if (taken < microCount) {
+        ++taken;
+    }
+
+    // The end of the taken micro-steps is the start of the next macro-step.
+    for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+        for (int neuron = 0; neuron < neuronCount; ++neuron) {
+            history[0][curFunc][neuron] = history[taken][curFunc][neuron];
+        }
+    }
+    integ->curStep = macroStart + taken;
+
+    return taken;
+}
+
+/**
+ * @brief Takes one ETD2RK step.
+ * 
+ * @param integ the integrator.
+ * @return int - the number of steps taken.
+ */
+static int stepExponential(Integrator *integ) {
+    EqConditions *cond = integ->cond;
+    EqSolution *sol = &integ->sol;
+    Graph *graph = integ->graph;
+    int neuronCount = sol->neuronCount, funcCount = sol->funcCount, curStep = integ->curStep;
+    double h = cond->step;
+    float (*state)[neuronCount] = (float (*)[neuronCount]) integ->state;
+    float (*inputs)[neuronCount] = (float (*)[neuronCount]) integ->inputs;
+    float (*linear)[funcCount] = (float (*)[funcCount]) integ->linear;
+    float (*expLh)[funcCount] = (float (*)[funcCount]) integ->expLh;
+    float (*phi1)[funcCount] = (float (*)[funcCount]) integ->phi1;
+    float (*phi2)[funcCount] = (float (*)[funcCount]) integ->phi2;
+    float (*nonlinear)[funcCount] = (float (*)[funcCount]) integ->nonlinear;
+    float *slopes = integ->slopes;
+
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+            inputs[curFunc][neuron] = state[curFunc][neuron];
+        }
+    }
+
+    // Calculate the linear part and its exponential coefficients at the current step.
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        calcCoupledLinear(integ, inputs, neuron, linear[neuron]);
+        for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+            calcExponentialCoefficients(linear[neuron][curFunc], h, &expLh[neuron][curFunc], &phi1[neuron][curFunc], &phi2[neuron][curFunc]);
+        }
+    }
+
+    // Calculate the nonlinear part at the current step.
+    if (cond->stencil != NULL) {
+        sweepStencil(&integ->stencil, inputs[0], 0, neuronCount);
+    }
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        integ->getODEs(neuronCount, inputs, sol->x[curStep], cond->stencil != NULL ? NULL : graph->adjMatrix[neuron], neuron, cond->ids, slopes);
+        if (cond->stencil != NULL) {
+            slopes[0] -= integ->stencil.coupling[neuron];
+        }
+        ++sol->evalCount;
+        for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+            nonlinear[neuron][curFunc] = slopes[curFunc] - linear[neuron][curFunc] * inputs[curFunc][neuron];
+        }
+    }
+
+    // Calculate the exponential Euler predictor.
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+            inputs[curFunc][neuron] = expLh[neuron][curFunc] * state[curFunc][neuron] + phi1[neuron][curFunc] * nonlinear[neuron][curFunc];
+        }
+    }
+
+    // Correct the predictor with the change in the nonlinear part across the step.
+    float nextX = sol->x[curStep] + cond->step;
+    if (cond->stencil != NULL) {
+        sweepStencil(&integ->stencil, inputs[0], 0, neuronCount);
+    }
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        integ->getODEs(neuronCount, inputs, nextX, cond->stencil != NULL ? NULL : graph->adjMatrix[neuron], neuron, cond->ids, slopes);
+        if (cond->stencil != NULL) {
+            slopes[0] -= integ->stencil.coupling[neuron];
+        }
+        ++sol->evalCount;
+        for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+            float predicted = inputs[curFunc][neuron];
+            float nonlinearNext = slopes[curFunc] - linear[neuron][curFunc] * predicted;
+            state[curFunc][neuron] = predicted + phi2[neuron][curFunc] * (nonlinearNext - nonlinear[neuron][curFunc]);
+        }
+    }
+
+    // Add the noise of the step to x.
+    if (cond->noise != NULL) {
+        addNoise(cond->noise, cond->ids, 0, neuronCount, state[0], curStep + 1, cond->step);
+    }
+
+    // Calculate next step in the x direction.
+    sol->x[curStep + 1] = nextX;
+
+    // Update the weights of the neurons that spiked.
+    if (integ->plasticity.graph != NULL) {
+        learnStep(integ, state[0]);
+    }
+
+    // Store the step (this ends the approximation early once the network has converged).
+    integ->curStep = curStep + 1;
+    recordStep(&integ->recorder, sol, curStep + 1, neuronCount, state);
+
+    return 1;
 }
 
-void writeSolution(char *filename, float x[], float approx[], int size, float transient) {
+/**
+ * @brief Keeps the state of the current step, followed by the recent maximum of each neuron for METHOD_MULTIRATE
+ * (setting recorder.failed if memory could not be allocated for it).
+ * 
+ * @param integ the integrator.
+ */
+static void keepKeyframe(Integrator *integ) {
+    int stateSize = integ->sol.funcCount * integ->sol.neuronCount;
+    if (!takeKeyframe(&integ->keyframes, integ->curStep, integ->sol.x[integ->curStep], integ->state, stateSize, integ->method == METHOD_MULTIRATE ? integ->recentMax : NULL)) {
+        integ->recorder.failed = 1;
+    }
+}
+
+/**
+ * @brief Frees an integrator that could not be initialized.
+ * 
+ * @param integ the integrator (every part it has not initialized must be zeroed).
+ * @return Integrator - the integrator with a NULL sol.x and nothing left to finish.
+ */
+static Integrator abandonIntegrator(Integrator *integ) {
+    finishIntegrator(integ);
+    freeEqSolution(&integ->sol);
+    integ->sol.x = NULL;
+    return *integ;
+}
+
+Integrator initIntegrator(Method method, void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), void (*getLinear)(int neuronCount, float inputs[][neuronCount], float weights[], int myNeuron, float result[]), EqConditions *cond, Graph *graph, int funcCount, int ratio, float activityThreshold, int threadCount) {
+    Integrator integ = {
+        .method = method,
+        .getODEs = getODEs,
+        .getLinear = getLinear,
+        .cond = cond,
+        .graph = graph,
+        .ratio = method == METHOD_MULTIRATE ? ratio : 1,
+        .activityThreshold = activityThreshold,
+        .sol = initEqSolution(cond->x0, cond->xEnd, cond->step, graph->vertexCount, funcCount, cond->record),
+        .curStep = 0,
+        .temporary = initWorkspace(),
+        .threadCount = 1,
+        .pool = NULL
+    };
+    int neuronCount = graph->vertexCount;
+    if (integ.sol.x == NULL) {
+        return integ;
+    }
+
+    // Take the scratch memory of the method from the workspace (the state holds ratio + 1 steps for the multirate method).
+    Workspace *workspace = cond->workspace != NULL ? cond->workspace : &integ.temporary;
+    size_t stateBytes = (size_t) funcCount * neuronCount * sizeof(float);
+    size_t maxBytes = (size_t) neuronCount * sizeof(float), listBytes = (size_t) neuronCount * sizeof(int);
+    size_t slopeBytes = funcCount * sizeof(float);
+    size_t scratchBytes = 7 * alignWorkspaceBytes(stateBytes) + alignWorkspaceBytes(slopeBytes);
+    if (method == METHOD_MULTIRATE) {
+        scratchBytes = alignWorkspaceBytes((integ.ratio + 1) * stateBytes) + 6 * alignWorkspaceBytes(stateBytes) + alignWorkspaceBytes(maxBytes) + 2 * alignWorkspaceBytes(listBytes) + alignWorkspaceBytes(slopeBytes);
+    }
+    if (!reserveWorkspace(workspace, scratchBytes)) {
+        return abandonIntegrator(&integ);
+    }
+    switch (method) {
+        case METHOD_MULTIRATE:
+            integ.state = takeWorkspace(workspace, (integ.ratio + 1) * stateBytes);
+            integ.inputs = takeWorkspace(workspace, stateBytes);
+            integ.predicted = takeWorkspace(workspace, stateBytes);
+            for (int curK = 0; curK < 4; ++curK) {
+                integ.k[curK] = takeWorkspace(workspace, stateBytes);
+            }
+            integ.recentMax = takeWorkspace(workspace, maxBytes);
+            integ.active = takeWorkspace(workspace, listBytes);
+            integ.quiet = takeWorkspace(workspace, listBytes);
+            break;
+        case METHOD_ETD:
+            integ.state = takeWorkspace(workspace, stateBytes);
+            integ.inputs = takeWorkspace(workspace, stateBytes);
+            integ.linear = takeWorkspace(workspace, stateBytes);
+            integ.expLh = takeWorkspace(workspace, stateBytes);
+            integ.phi1 = takeWorkspace(workspace, stateBytes);
+            integ.phi2 = takeWorkspace(workspace, stateBytes);
+            integ.nonlinear = takeWorkspace(workspace, stateBytes);
+            break;
+        default:
+            integ.state = takeWorkspace(workspace, stateBytes);
+            integ.inputs = takeWorkspace(workspace, stateBytes);
+            integ.nextInputs = takeWorkspace(workspace, stateBytes);
+            for (int curK = 0; curK < 4; ++curK) {
+                integ.k[curK] = takeWorkspace(workspace, stateBytes);
+            }
+    }
+    integ.slopes = takeWorkspace(workspace, slopeBytes);
+
+    // Copy the weights into a plastic graph for the coupling to read if requested.
+    if (cond->plasticity != NULL && method != METHOD_MULTIRATE && cond->synapses == NULL) {
+        integ.plasticity = initPlasticity(cond->plasticity, graph, cond->x0);
+        if ((integ.graph = integ.plasticity.graph) == NULL) {
+            return abandonIntegrator(&integ);
+        }
+    }
+
+    // Find the neighbours of the lattice if requested.
+    if (cond->stencil != NULL && (integ.stencil = initStencil(cond->stencil)).coupling == NULL) {
+        return abandonIntegrator(&integ);
+    }
+
+    // Start a pinned worker for each partition if requested.
+    if (threadCount > 1 && method == METHOD_RK4 && cond->synapses == NULL && cond->plasticity == NULL && neuronCount > 1) {
+        integ.partition = cond->stencil != NULL ? initStencilPartition(&integ.stencil, threadCount) : initPartition(graph, threadCount);
+        if (integ.partition.first == NULL) {
+            return abandonIntegrator(&integ);
+        }
+        integ.threadCount = integ.partition.count;
+        if ((integ.pool = startWorkerPool(&integ)) == NULL) {
+            freePartition(&integ.partition);
+            return abandonIntegrator(&integ);
+        }
+    }
+
+    // Assign initial values for each function of each neuron and x.
+    float (*state)[neuronCount] = (float (*)[neuronCount]) integ.state;
+    float (*inputs)[neuronCount] = (float (*)[neuronCount]) integ.inputs;
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+            state[curFunc][neuron] = cond->inits[curFunc];
+        }
+    }
+    if (cond->noise != NULL && cond->noise->spread > 0.0) {
+        randomizeInits(cond->noise, cond->ids, neuronCount, funcCount, cond->inits, integ.state);
+    }
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        for (int curFunc = 0; curFunc < funcCount; ++curFunc) {
+            inputs[curFunc][neuron] = state[curFunc][neuron];
+        }
+        if (method == METHOD_MULTIRATE) {
+            integ.recentMax[neuron] = state[0][neuron];
+        }
+    }
+    integ.sol.x[0] = cond->x0;
+    integ.recorder = initRecorder(cond, &integ.sol);
+    if ((integ.sol.spikes != NULL && integ.recorder.detector.prev == NULL) || (integ.recorder.converging && integ.recorder.monitor.syncErrors == NULL)) {
+        return abandonIntegrator(&integ);
+    }
+    recordStep(&integ.recorder, &integ.sol, 0, neuronCount, state);
+    if (integ.recorder.failed) {
+        return abandonIntegrator(&integ);
+    }
+
+    // Keep the first keyframe if requested.
+    if (cond->record != NULL && cond->record->keyframeInterval > 0) {
+        KeyframeRun run = {
+            .neuronCount = neuronCount,
+            .funcCount = funcCount,
+            .method = method,
+            .ratio = integ.ratio,
+            .stepCount = integ.sol.stepCount,
+            .interval = cond->record->keyframeInterval,
+            .x0 = cond->x0,
+            .step = cond->step,
+            .activityThreshold = method == METHOD_MULTIRATE ? activityThreshold : 0.0,
+            .noiseStrength = cond->noise != NULL ? cond->noise->strength : 0.0,
+            .noiseSeed = cond->noise != NULL ? cond->noise->seed : 0,
+            .conditions = hashConditions(cond, graph, funcCount)
+        };
+        int frameSize = funcCount * neuronCount + (method == METHOD_MULTIRATE ? neuronCount : 0);
+        integ.keyframes = initKeyframes(&run, frameSize, integ.sol.stepCount / run.interval + 1);
+        if (integ.keyframes.frames == NULL) {
+            return abandonIntegrator(&integ);
+        }
+        keepKeyframe(&integ);
+        if (integ.recorder.failed) {
+            return abandonIntegrator(&integ);
+        }
+    }
+
+    // Build the chemical synapses if requested.
+    if (cond->synapses != NULL && (integ.synapses = initSynapses(cond->synapses, graph)).conductance == NULL) {
+        return abandonIntegrator(&integ);
+    }
+
+    // Create the shared memory ring if requested.
+    if (cond->monitor != NULL && (integ.monitor = initMonitor(cond->monitor, neuronCount, integ.sol.stepCount, cond->x0, cond->xEnd)).ring == NULL) {
+        return abandonIntegrator(&integ);
+    }
+
+    return integ;
+}
+
+int advanceIntegrator(Integrator *integ, int steps) {
+    int taken = 0;
+    while (taken < steps && !isIntegratorFinished(integ)) {
+        switch (integ->method) {
+            case METHOD_MULTIRATE:
+                taken += stepMultirate(integ, steps - taken);
+                break;
+            case METHOD_ETD:
+                taken += stepExponential(integ);
+                break;
+            default:
+                taken += integ->pool != NULL ? stepParallel(integ) : stepRungeKutta(integ);
+        }
+
+        // Keep a keyframe once the interval has passed.
+        if (integ->keyframes.run.interval > 0 && integ->curStep % integ->keyframes.run.interval == 0) {
+            keepKeyframe(integ);
+        }
+
+        // Publish the progress once the interval has passed or the approximation has ended.
+        if (integ->monitor.ring != NULL && (integ->curStep >= integ->monitor.nextStep || isIntegratorFinished(integ))) {
+            int neuronCount = integ->sol.neuronCount;
+            publishProgress(&integ->monitor, integ->curStep, integ->sol.x[integ->curStep], neuronCount, (float (*)[neuronCount]) integ->state, integ->sol.funcCount, integ->sol.spikes, isIntegratorFinished(integ));
+        }
+    }
+
+    return taken;
+}
+
+void resumeIntegrator(Integrator *integ, const Keyframes *keyframes, int frame) {
+    EqSolution *sol = &integ->sol;
+    int neuronCount = sol->neuronCount, stateSize = sol->funcCount * neuronCount;
+    const float *values = &keyframes->frames[(size_t) frame * keyframes->frameSize];
+
+    // Restore the state and what the method carries between steps (the inputs of rk4 and the activity of multirate).
+    integ->curStep = keyframes->steps[frame];
+    sol->x[integ->curStep] = keyframes->x[frame];
+    memcpy(integ->state, values, stateSize * sizeof(float));
+    memcpy(integ->inputs, values, stateSize * sizeof(float));
+    if (integ->method == METHOD_MULTIRATE) {
+        memcpy(integ->recentMax, values + stateSize, neuronCount * sizeof(float));
+    }
+    if (integ->pool != NULL) {
+        integ->pool->load = integ->pool->memory != NULL;
+    }
+
+    // Store the step as if it had just been taken (initIntegrator() stored the first step).
+    if (integ->curStep > 0) {
+        recordStep(&integ->recorder, sol, integ->curStep, neuronCount, (float (*)[neuronCount]) integ->state);
+    }
+}
+
+int isIntegratorFinished(Integrator *integ) {
+    return integ->curStep >= integ->sol.stepCount || integ->recorder.failed;
+}
+
+EqSolution finishIntegrator(Integrator *integ) {
+    // The approximation ends where the integrator stopped.
+    integ->sol.stepCount = integ->curStep;
+
+    if (integ->pool != NULL) {
+        stopWorkerPool(integ->pool);
+        freePartition(&integ->partition);
+        integ->pool = NULL;
+    }
+    if (integ->monitor.ring != NULL) {
+        int neuronCount = integ->sol.neuronCount;
+        freeMonitor(&integ->monitor, integ->curStep, integ->sol.x[integ->curStep], neuronCount, (float (*)[neuronCount]) integ->state, integ->sol.funcCount, integ->sol.spikes);
+    }
+    freeRecorder(&integ->recorder, &integ->sol);
+    if (integ->cond->synapses != NULL) {
+        freeSynapses(&integ->synapses);
+    }
+    if (integ->plasticity.graph != NULL) {
+        freePlasticity(&integ->plasticity);
+        integ->graph = NULL;
+    }
+    if (integ->stencil.coupling != NULL) {
+        freeStencil(&integ->stencil);
+        integ->stencil.coupling = NULL;
+    }
+    if (integ->keyframes.run.interval > 0) {
+        freeKeyframes(&integ->keyframes);
+        integ->keyframes.run.interval = 0;
+    }
+    freeWorkspace(&integ->temporary);
+
+    return integ->sol;
+}
+
+/**
+ * @brief Advances an integrator to the end of its approximation and finishes it.
+ * 
+ * @param integ the integrator (its sol.x is NULL if it could not be initialized).
+ * @return EqSolution - the approximation (a NULL x array if memory could not be allocated).
+ */
+static EqSolution runIntegrator(Integrator *integ) {
+    if (integ->sol.x == NULL) {
+        return integ->sol;
+    }
+    advanceIntegrator(integ, integ->sol.stepCount);
+    if (integ->recorder.failed) {
+        return abandonIntegrator(integ).sol;
+    }
+    return finishIntegrator(integ);
+}
+
+EqSolution runRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), EqConditions *cond, Graph *graph, int funcCount) {
+    Integrator integ = initIntegrator(METHOD_RK4, getODEs, NULL, cond, graph, funcCount, 1, 0.0, 1);
+    return runIntegrator(&integ);
+}
+
+EqSolution runMultirateRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), EqConditions *cond, Graph *graph, int funcCount, int ratio, float activityThreshold) {
+    Integrator integ = initIntegrator(METHOD_MULTIRATE, getODEs, NULL, cond, graph, funcCount, ratio, activityThreshold, 1);
+    return runIntegrator(&integ);
+}
+
+EqSolution runExponentialRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), void (*getLinear)(int neuronCount, float inputs[][neuronCount], float weights[], int myNeuron, float result[]), EqConditions *cond, Graph *graph, int funcCount) {
+    Integrator integ = initIntegrator(METHOD_ETD, getODEs, getLinear, cond, graph, funcCount, 1, 0.0, 1);
+    return runIntegrator(&integ);
+}
+
+/**
+ * @brief Compares two neuron numbers for qsort().
+ * 
+ * @param a the first neuron number.
+ * @param b the second neuron number.
+ * @return int - negative, zero, or positive as a is below, equal to, or above b.
+ */
+static int compareNeurons(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+int parseRecordNeurons(char *list, RecordSpec *record) {
+    int capacity = 16;
+    free(record->neurons);
+    record->neuronCount = 0;
+    if ((record->neurons = (int *) malloc(capacity * sizeof(int))) == NULL) {
+        return 0;
+    }
+
+    // Expand each number or range.
+    char *save;
+    for (char *item = strtok_r(list, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save)) {
+        int first, last;
+        if (sscanf(item, "%d-%d", &first, &last) != 2) {
+            last = first = strtol(item, NULL, 10);
+        }
+        for (int neuron = first; neuron <= last; ++neuron) {
+            if (record->neuronCount == capacity) {
+                int *neurons;
+                if ((neurons = (int *) realloc(record->neurons, 2 * capacity * sizeof(int))) == NULL) {
+                    free(record->neurons);
+                    record->neurons = NULL;
+                    record->neuronCount = 0;
+                    return 0;
+                }
+                record->neurons = neurons;
+                capacity *= 2;
+            }
+            record->neurons[record->neuronCount++] = neuron;
+        }
+    }
+
+    // Sort the neurons and drop any duplicates.
+    qsort(record->neurons, record->neuronCount, sizeof(int), compareNeurons);
+    int unique = 0;
+    for (int i = 0; i < record->neuronCount; ++i) {
+        if (!unique || record->neurons[i] != record->neurons[unique - 1]) {
+            record->neurons[unique++] = record->neurons[i];
+        }
+    }
+    record->neuronCount = unique;
+    return 1;
+}
+
+int writeSolution(char *filename, float x[], float approx[], int size, float transient) {
     // Find the point to start printing from.
-    int start = 0;
-    for (int i = 0; i < size && !start; ++i) {
+    int start = size;
+    for (int i = 0; i < size && start == size; ++i) {
         if (x[i] >= transient) {
             start = i;
         }        
@@ -187,8 +1595,7 @@ void writeSolution(char *filename, float x[], float approx[], int size, float tr
     // Open output file for writing.
     FILE *outfile;
     if ((outfile = fopen(filename, "w")) == NULL) {
-        perror("Write Solution");
-        exit(EXIT_FAILURE);
+        return 0;
     }
     
     // Begin writing.
@@ -197,7 +1604,24 @@ void writeSolution(char *filename, float x[], float approx[], int size, float tr
     }
     
     // Close ouput file.
-    fclose(outfile);
+    return fclose(outfile) == 0;
+}
+
+uint64_t hashConditions(const EqConditions *cond, const Graph *graph, int funcCount) {
+    // The coupling, read a row at a time (the rows need not be contiguous).
+    uint64_t hash = CACHE_HASH_START;
+    if (cond->stencil != NULL) {
+        hash = hashBytes(hash, cond->stencil, sizeof(StencilParams));
+    }
+    for (int row = 0; cond->stencil == NULL && row < graph->vertexCount; ++row) {
+        hash = hashBytes(hash, graph->adjMatrix[row], graph->vertexCount * sizeof(float));
+    }
+
+    // The initial values, their spread, and the transient.
+    float spread = cond->noise != NULL ? cond->noise->spread : 0.0;
+    hash = hashBytes(hash, cond->inits, funcCount * sizeof(float));
+    hash = hashBytes(hash, &spread, sizeof(float));
+    return hashBytes(hash, &cond->transient, sizeof(float));
 }
 
 void freeEqConditions(EqConditions *cond) {
@@ -206,17 +1630,38 @@ void freeEqConditions(EqConditions *cond) {
 }
 
 void freeEqSolution(EqSolution *sol) {
-    for (int neuron = 0; neuron < sol->neuronCount; ++neuron) {
-        for (int func = 0; func < sol->funcCount; ++func) {
-            // Free the steps arrays.
-            free(sol->approx[neuron][func]);
+    for (int rec = 0; rec < sol->recordCount; ++rec) {
+        for (int func = 0; sol->approx[rec] != NULL && func < sol->funcCount; ++func) {
+            // Free the sample arrays.
+            free(sol->approx[rec][func]);
         }
 
         // Free the function arrays.
-        free(sol->approx[neuron]);
+        free(sol->approx[rec]);
+
+        // Free the compressed samples.
+        for (int func = 0; sol->compressed != NULL && sol->compressed[rec] != NULL && func < sol->funcCount; ++func) {
+            if (sol->compressed[rec][func].quantum > 0.0) {
+                freeTrajectory(&sol->compressed[rec][func]);
+            }
+        }
+        if (sol->compressed != NULL) {
+            free(sol->compressed[rec]);
+        }
     }  
+
+    // Free the spikes of every neuron.
+    if (sol->spikes != NULL) {
+        for (int neuron = 0; neuron < sol->neuronCount; ++neuron) {
+            freePoints(&sol->spikes[neuron]);
+        }
+        free(sol->spikes);
+    }
     
-    // Free the neuron and x arrays.
+    // Free the record, neuron, and x arrays.
     free(sol->approx);
+    free(sol->compressed);
+    free(sol->neurons);
+    free(sol->sampleX);
     free(sol->x);
 }
\ No newline at end of file
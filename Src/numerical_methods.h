@@ -12,6 +12,82 @@
 #define NUMERICAL_METHODS
 
 #include "graph_manipulations.h"
+#include "convergence.h"
+#include "synapses.h"
+#include "workspace.h"
+#include "spike_calculations.h"
+#include "noise.h"
+#include "partition.h"
+#include "plasticity.h"
+#include "monitor.h"
+#include "trajectory.h"
+#include "keyframes.h"
+#include "stencil.h"
+
+/**
+ * @brief The numerical methods available to run the approximation.
+ */
+typedef enum {
+    METHOD_RK4,
+    METHOD_MULTIRATE,
+    METHOD_ETD
+} Method;
+
+/**
+ * @brief A record specification structure which selects what the approximation stores.
+ */
+typedef struct {
+    /**
+     * @brief The functions to store. Function f is stored when bit (1 << f) is set.
+     */
+    int funcMask;
+
+    /**
+     * @brief The numbers of the neurons to store in ascending order (NULL for every neuron).
+     */
+    int *neurons;
+
+    /**
+     * @brief The number of neurons in the neurons array.
+     */
+    int neuronCount;
+
+    /**
+     * @brief The x position to start storing from.
+     */
+    float start;
+
+    /**
+     * @brief The x position to stop storing after.
+     */
+    float end;
+
+    /**
+     * @brief The number of steps between stored samples.
+     */
+    int stride;
+
+    /**
+     * @brief Whether to find the spikes of every neuron after the transient while approximating.
+     */
+    int spikes;
+
+    /**
+     * @brief The minimum value a spike must reach.
+     */
+    float spikeThreshold;
+
+    /**
+     * @brief The distance between the values stored samples are rounded to, storing them compressed (0 to store floats).
+     */
+    float quantum;
+
+    /**
+     * @brief The number of steps between keyframes of the whole state, from which any window of the approximation can
+     * be integrated again (0 for none, a multiple of the ratio for METHOD_MULTIRATE).
+     */
+    int keyframeInterval;
+} RecordSpec;
 
 /**
  * @brief A conditions structure which specifies the bounds of the approximation.
@@ -41,6 +117,55 @@ typedef struct {
      * @brief The x position in which the differential equation starts exhibiting its normal behavior.
      */
     float transient;
+
+    /**
+     * @brief The criteria for stopping before xEnd once the network converges (NULL to always run to xEnd).
+     */
+    ConvergenceCriteria *convergence;
+
+    /**
+     * @brief The parameters of event-driven chemical synapses replacing the electrical coupling (NULL for electrical coupling).
+     */
+    SynapseParams *synapses;
+
+    /**
+     * @brief The lattice whose neighbours replace the adjacency rows of the graph in the electrical coupling (NULL to
+     * couple through the graph, whose adjMatrix may then be NULL). METHOD_RK4, METHOD_MULTIRATE, and METHOD_ETD only,
+     * without synapses or plasticity.
+     */
+    StencilParams *stencil;
+
+    /**
+     * @brief The noise added to x and the initial values (NULL for a deterministic approximation).
+     */
+    NoiseParams *noise;
+
+    /**
+     * @brief The spike-timing-dependent plasticity of the electrical coupling weights (NULL for fixed weights, METHOD_RK4 
+     * and METHOD_ETD only).
+     */
+    PlasticityParams *plasticity;
+
+    /**
+     * @brief The numbers of the neurons within the whole graph when the input graph is a subgraph of it (NULL when the 
+     * input graph is whole). The model parameters and noise of each neuron follow its number in the whole graph.
+     */
+    NeuronIds *ids;
+
+    /**
+     * @brief Where and how often the progress is published to shared memory (NULL to publish nothing).
+     */
+    MonitorParams *monitor;
+
+    /**
+     * @brief The scratch memory reused by the numerical methods across steps and runs (NULL for a temporary one per run).
+     */
+    Workspace *workspace;
+
+    /**
+     * @brief What the approximation stores (NULL to store every function of every neuron at every step).
+     */
+    RecordSpec *record;
 } EqConditions;
 
 /**
@@ -48,15 +173,52 @@ typedef struct {
  */
 typedef struct {
     /**
-     * @brief The array of x values.
+     * @brief The array of x values of every step.
      */
     float *x;
 
     /**
-     * @brief The 3D array of approximations. Access using approx[neuronNum][functionNum][stepNum].
+     * @brief The 3D array of stored approximations. Access using approx[recordNum][functionNum][sampleNum] 
+     * (approx[recordNum][functionNum] is NULL for functions that are not stored, and for every function when compressed).
      */
     float ***approx;
 
+    /**
+     * @brief The 2D array of compressed samples when the record specification has a quantum (otherwise NULL). Access
+     * using compressed[recordNum][functionNum] (its size is 0 for functions that are not stored).
+     */
+    CompressedTrajectory **compressed;
+
+    /**
+     * @brief The neuron number of each record. Access using neurons[recordNum].
+     */
+    int *neurons;
+
+    /**
+     * @brief The number of stored neurons.
+     */
+    int recordCount;
+
+    /**
+     * @brief The x value of each stored sample. Access using sampleX[sampleNum].
+     */
+    float *sampleX;
+
+    /**
+     * @brief The number of samples stored so far.
+     */
+    int sampleCount;
+
+    /**
+     * @brief The first step, last step, and step stride of the stored samples.
+     */
+    int recordFirst, recordLast, recordStride;
+
+    /**
+     * @brief The spikes found for each neuron (NULL when not requested). Access using spikes[neuronNum].
+     */
+    Points *spikes;
+
     /**
      * @brief The number of neurons in the approximation.
      */
@@ -71,8 +233,175 @@ typedef struct {
      * @brief The number of steps taken in the approximation (-1 the size of the x array).
      */
     int stepCount;
+
+    /**
+     * @brief The reason the approximation stopped.
+     */
+    StopReason stopReason;
+
+    /**
+     * @brief The number of times getODEs() was evaluated for a neuron.
+     */
+    long evalCount;
 } EqSolution;
 
+/**
+ * @brief A recorder structure which stores what is selected from each completed step, finds spikes, and watches for convergence.
+ */
+typedef struct {
+    /**
+     * @brief The record specification (NULL to store everything).
+     */
+    RecordSpec *record;
+
+    /**
+     * @brief The online detector used to find spikes.
+     */
+    SpikeDetector detector;
+
+    /**
+     * @brief The first step at or after the transient (-1 until it is reached).
+     */
+    int spikeStart;
+
+    /**
+     * @brief The x position in which the differential equation starts exhibiting its normal behavior.
+     */
+    float transient;
+
+    /**
+     * @brief The convergence monitor (only used when converging is set).
+     */
+    ConvergenceMonitor monitor;
+
+    /**
+     * @brief Whether the approximation may stop once it converges.
+     */
+    int converging;
+
+    /**
+     * @brief Whether memory could not be allocated while a step was stored or coupled (the approximation then stops).
+     */
+    int failed;
+} Recorder;
+
+/**
+ * @brief An integrator structure which holds an approximation in progress so it can be advanced a number of steps at a time.
+ */
+typedef struct {
+    /**
+     * @brief The numerical method used to take each step.
+     */
+    Method method;
+
+    /**
+     * @brief A pointer to function that returns the result(s) of ODEs with given inputs.
+     */
+    void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]);
+
+    /**
+     * @brief A pointer to function that returns the diagonal linear coefficient of each ODE (METHOD_ETD only).
+     */
+    void (*getLinear)(int neuronCount, float inputs[][neuronCount], float weights[], int myNeuron, float result[]);
+
+    /**
+     * @brief The input conditions.
+     */
+    EqConditions *cond;
+
+    /**
+     * @brief The graph read by the coupling (the input graph, or its plastic copy).
+     */
+    Graph *graph;
+
+    /**
+     * @brief The number of micro-steps per macro-step (METHOD_MULTIRATE only, otherwise 1).
+     */
+    int ratio;
+
+    /**
+     * @brief The voltage a neuron must reach to be integrated with micro-steps (METHOD_MULTIRATE only).
+     */
+    float activityThreshold;
+
+    /**
+     * @brief The solution being approximated.
+     */
+    EqSolution sol;
+
+    /**
+     * @brief The number of steps taken so far.
+     */
+    int curStep;
+
+    /**
+     * @brief The recorder storing each completed step.
+     */
+    Recorder recorder;
+
+    /**
+     * @brief The scratch memory used when cond->workspace is NULL.
+     */
+    Workspace temporary;
+
+    /**
+     * @brief The chemical synapses (only used when cond->synapses is set).
+     */
+    Synapses synapses;
+
+    /**
+     * @brief The plastic weights and traces (graph is NULL unless cond->plasticity is used). The coupling reads the 
+     * plastic copy of the graph instead of the input graph.
+     */
+    Plasticity plasticity;
+
+    /**
+     * @brief The value of each function for every neuron at the current step. Access using state[functionNum * neuronCount + neuronNum].
+     * For METHOD_MULTIRATE this is followed by the ratio micro-steps of the current macro-step.
+     */
+    float *state;
+
+    /**
+     * @brief The scratch memory of the methods (only the buffers used by the method are set).
+     */
+    float *inputs, *nextInputs, *predicted, *k[4], *recentMax, *linear, *expLh, *phi1, *phi2, *nonlinear, *slopes;
+
+    /**
+     * @brief The active and quiescent neurons of the current macro-step (METHOD_MULTIRATE only).
+     */
+    int *active, *quiet;
+
+    /**
+     * @brief The number of threads taking each step (1 when the integrator steps on the calling thread).
+     */
+    int threadCount;
+
+    /**
+     * @brief The neurons of each thread (only set when threadCount is above 1).
+     */
+    Partition partition;
+
+    /**
+     * @brief The worker threads taking each step (NULL when threadCount is 1).
+     */
+    struct WorkerPool *pool;
+
+    /**
+     * @brief The monitor publishing the progress (its ring is NULL unless requested).
+     */
+    Monitor monitor;
+
+    /**
+     * @brief The neighbours and coupling of the lattice (its coupling is NULL unless cond->stencil is used).
+     */
+    Stencil stencil;
+
+    /**
+     * @brief The keyframes taken every record->keyframeInterval steps (its run.interval is 0 unless requested).
+     */
+    Keyframes keyframes;
+} Integrator;
+
 /**
  * @brief Initializes and allocates memory for a conditions struture.
  * 
@@ -81,21 +410,79 @@ typedef struct {
  * @param step the size of each step.
  * @param transient the x position in which the differential equation starts exhibiting its normal behavior.
  * @param funcCount the number of functions to be approximated within getODEs().
- * @return EqConditions - the initialized conditions structure.
+ * @return EqConditions - the initialized conditions structure (NULL inits if memory could not be allocated).
  */
 EqConditions initEqConditions(float x0, float xEnd, float step, float transient, int funcCount);
 
 /**
- * @brief Initializes and allocates memory for a solution struture.
+ * @brief Initializes and allocates memory for a solution struture. Only what the record specification selects is allocated.
  * 
  * @param x0 the starting x position.
  * @param xEnd the final x position.
  * @param step the size of each step.
  * @param neuronCount The number of neurons in the approximation.
  * @param funcCount the number of functions to be approximated within getODEs().
- * @return EqSolution - the initialized solution structure.
+ * @param record what to store (NULL to store every function of every neuron at every step).
+ * @return EqSolution - the initialized solution structure (a NULL x array, with nothing left to free, if memory could
+ * not be allocated or a recorded neuron does not exist).
+ */
+EqSolution initEqSolution(float x0, float xEnd, float step, int neuronCount, int funcCount, RecordSpec *record);
+
+/**
+ * @brief Initializes an integrator structure, allocating the solution and taking the scratch memory of the method.
+ * 
+ * @param method the numerical method used to take each step.
+ * @param getODEs a pointer to function that returns the result(s) of ODEs with given inputs.
+ * @param getLinear a pointer to function that returns the diagonal linear coefficient of each ODE (METHOD_ETD only, otherwise NULL).
+ * @param cond the input conditions (must outlive the integrator).
+ * @param graph the input graph (must outlive the integrator).
+ * @param funcCount the number of functions to be approximated within getODEs().
+ * @param ratio the number of micro-steps per macro-step (METHOD_MULTIRATE only).
+ * @param activityThreshold the voltage a neuron must reach to be integrated with micro-steps (METHOD_MULTIRATE only).
+ * @param threadCount the number of threads taking each step. Above 1, the neurons are split into partitions and each 
+ * thread is pinned to a core and keeps its own copy of the adjacency rows of its partition (METHOD_RK4 with electrical 
+ * coupling only, otherwise the integrator steps on the calling thread).
+ * @return Integrator - the initialized integrator structure (a NULL sol.x, with nothing left to finish, if memory or its
+ * threads could not be allocated).
+ */
+Integrator initIntegrator(Method method, void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), void (*getLinear)(int neuronCount, float inputs[][neuronCount], float weights[], int myNeuron, float result[]), EqConditions *cond, Graph *graph, int funcCount, int ratio, float activityThreshold, int threadCount);
+
+/**
+ * @brief Advances an integrator by up to a number of steps. It stops early at the end of the approximation, once the 
+ * network has converged, or once memory could not be allocated (recorder.failed is then set).
+ * 
+ * @param integ the integrator.
+ * @param steps the most steps to take.
+ * @return int - the number of steps taken.
+ */
+int advanceIntegrator(Integrator *integ, int steps);
+
+/**
+ * @brief Resumes an integrator from a keyframe of an earlier approximation with the same conditions, as if it had
+ * taken the steps before it. The steps after it match the earlier approximation exactly.
+ * 
+ * @param integ the integrator (which must not have taken any steps).
+ * @param keyframes the keyframes of the earlier approximation.
+ * @param frame the number of the keyframe.
+ */
+void resumeIntegrator(Integrator *integ, const Keyframes *keyframes, int frame);
+
+/**
+ * @brief Checks if an integrator has reached the end of its approximation.
+ * 
+ * @param integ the integrator.
+ * @return int - 1 if no steps remain or memory could not be allocated, otherwise 0.
+ */
+int isIntegratorFinished(Integrator *integ);
+
+/**
+ * @brief Stops the worker threads of an integrator, frees its scratch memory, and ends its approximation at the steps 
+ * taken so far.
+ * 
+ * @param integ the integrator to be finished.
+ * @return EqSolution - the approximation (free with freeEqSolution()).
  */
-EqSolution initEqSolution(float x0, float xEnd, float step, int neuronCount, int funcCount);
+EqSolution finishIntegrator(Integrator *integ);
 
 // /**
 //  * @brief Runs Euler's first-order numerical method for approximating ODEs.
@@ -108,25 +495,81 @@ EqSolution initEqSolution(float x0, float xEnd, float step, int neuronCount, int
 
 /**
  * @brief Runs the fourth-order Runge-Kutta method for numerically approximating ordinary differential equations.
+ * When cond->synapses is set, the first function (voltage) of each neuron is coupled through event-driven chemical 
+ * synapses instead of the weights passed to getODEs().
  * 
  * @param getODEs a pointer to function that returns the result(s) of ODEs with given inputs.
  * @param cond the input conditions.
  * @param graph the input graph.
  * @param funcCount the number of functions to be approximated within getODEs().
- * @return EqSolution - the approximation with the giving inputs.
+ * @return EqSolution - the approximation with the giving inputs (a NULL x array if memory could not be allocated).
  */
-EqSolution runRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, float result[]), EqConditions *cond, Graph *graph, int funcCount);
+EqSolution runRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), EqConditions *cond, Graph *graph, int funcCount);
 
 /**
- * @brief Writes the ODE approximation for each step to a file. 
+ * @brief Runs a multirate fourth-order Runge-Kutta method. Neurons whose first function (voltage) reached activityThreshold 
+ * during the last macro-step take micro-steps of cond->step, while the quiescent neurons take a single macro-step of 
+ * ratio * cond->step. Active neurons see the quiescent neurons linearly interpolated across the macro-step, and the 
+ * quiescent neurons see the finished micro-steps of the active neurons. A macro-step is redone if a quiescent neuron reaches 
+ * activityThreshold during it, and the quiescent steps in between are linearly interpolated. The macro-step must stay within 
+ * the stability limit of RK4 for the quiescent state (about 0.17 for HR), so the savings come from small base steps.
+ * 
+ * @param getODEs a pointer to function that returns the result(s) of ODEs with given inputs.
+ * @param cond the input conditions.
+ * @param graph the input graph.
+ * @param funcCount the number of functions to be approximated within getODEs().
+ * @param ratio the number of micro-steps per macro-step.
+ * @param activityThreshold the voltage a neuron must reach to be integrated with micro-steps.
+ * @return EqSolution - the approximation with the giving inputs (a NULL x array if memory could not be allocated).
+ */
+EqSolution runMultirateRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), EqConditions *cond, Graph *graph, int funcCount, int ratio, float activityThreshold);
+
+/**
+ * @brief Runs the second-order exponential time differencing Runge-Kutta method (ETD2RK, Cox-Matthews). At every step 
+ * the diagonal linear part of each function is taken from getLinear() and integrated exactly, while the remaining 
+ * (nonlinear and off-diagonal) part is treated explicitly. Stiff decay, coupling, and cubic terms therefore no longer 
+ * limit the step size, and each step costs two evaluations of getODEs() instead of four.
+ * 
+ * @param getODEs a pointer to function that returns the result(s) of ODEs with given inputs.
+ * @param getLinear a pointer to function that returns the diagonal linear coefficient of each ODE with given inputs.
+ * @param cond the input conditions.
+ * @param graph the input graph.
+ * @param funcCount the number of functions to be approximated within getODEs().
+ * @return EqSolution - the approximation with the giving inputs (a NULL x array if memory could not be allocated).
+ */
+EqSolution runExponentialRungeKutta(void (*getODEs)(int neuronCount, float inputs[][neuronCount], float curX, float weights[], int myNeuron, const NeuronIds *ids, float result[]), void (*getLinear)(int neuronCount, float inputs[][neuronCount], float weights[], int myNeuron, float result[]), EqConditions *cond, Graph *graph, int funcCount);
+
+/**
+ * @brief Parses a list of neuron numbers and ranges (such as "0-49,100") into a record specification.
+ * 
+ * @param list the list of neurons (modified while parsing).
+ * @param record the record specification to store the sorted neuron numbers in.
+ * @return int - 1 if the list was parsed, otherwise 0 (memory could not be allocated).
+ */
+int parseRecordNeurons(char *list, RecordSpec *record);
+
+/**
+ * @brief Writes the ODE approximation for each step to a file. The x column is shifted to start from x[0].
  * 
  * @param filename the name of the file to write to.
  * @param x an array of steps.
  * @param approx an array of approximations.
  * @param size the size of the x and approx arrays.
  * @param transient the x value to begin printing from.
+ * @return int - 1 if the file was written, otherwise 0.
+ */
+int writeSolution(char *filename, float x[], float approx[], int size, float transient);
+
+/**
+ * @brief Hashes what the steps of an approximation depend on beyond its counts and settings: the weights (or lattice),
+ * the initial values and their spread, and the transient.
+ * 
+ * @param cond the input conditions.
+ * @param graph the input graph (ignored with a lattice).
+ * @param funcCount the number of functions to be approximated within getODEs().
+ * @return uint64_t - the hash.
  */
-void writeSolution(char *filename, float x[], float approx[], int size, float transient);
+uint64_t hashConditions(const EqConditions *cond, const Graph *graph, int funcCount);
 
 /**
  * @brief Frees the dynamic/heap memory allocated to a conditions structure.
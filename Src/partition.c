@@ -0,0 +1,284 @@
+/**
+ * @file partition.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the partition header file.
+ * @version 0.1
+ * @date 2022-10-10
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#define _GNU_SOURCE
+#include "partition.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+/**
+ * @brief A degree structure which orders the neurons by their number of neighbours.
+ */
+typedef struct {
+    /**
+     * @brief The number of neighbours of the neuron.
+     */
+    int degree;
+
+    /**
+     * @brief The number of the neuron.
+     */
+    int neuron;
+} Degree;
+
+/**
+ * @brief Compares two degrees for qsort(), least first and then by neuron number.
+ *
+ * @param a the first degree.
+ * @param b the second degree.
+ * @return int - negative, zero, or positive as a comes before, with, or after b.
+ */
+static int compareDegrees(const void *a, const void *b) {
+    const Degree *first = (const Degree *) a, *second = (const Degree *) b;
+    if (first->degree != second->degree) {
+        return first->degree - second->degree;
+    }
+    return first->neuron - second->neuron;
+}
+
+/**
+ * @brief Checks whether two different neurons are coupled in either direction.
+ *
+ * @param graph the graph.
+ * @param a the first neuron.
+ * @param b the second neuron.
+ * @return int - 1 if they are neighbours, otherwise 0.
+ */
+static int areNeighbours(Graph *graph, int a, int b) {
+    return a != b && (graph->adjMatrix[a][b] != 0.0 || graph->adjMatrix[b][a] != 0.0);
+}
+
+/**
+ * @brief Lists the neurons of a graph in Cuthill-McKee order.
+ *
+ * @param graph the graph.
+ * @return int* - the neuron at each position (free with free()), or NULL if memory could not be allocated.
+ */
+static int *orderNeurons(Graph *graph) {
+    int neuronCount = graph->vertexCount;
+    Degree *degrees = (Degree *) malloc(neuronCount * sizeof(Degree));
+    int *order = (int *) malloc(neuronCount * sizeof(int));
+    int *start = (int *) malloc((neuronCount + 1) * sizeof(int));
+    int *visited = (int *) calloc(neuronCount, sizeof(int));
+    if (degrees == NULL || order == NULL || start == NULL || visited == NULL) {
+        free(degrees);
+        free(order);
+        free(start);
+        free(visited);
+        return NULL;
+    }
+
+    // Count the neighbours of each neuron and sort the neurons by them.
+    start[0] = 0;
+    for (int row = 0; row < neuronCount; ++row) {
+        degrees[row] = (Degree) {
+            .degree = 0,
+            .neuron = row
+        };
+        for (int column = 0; column < neuronCount; ++column) {
+            degrees[row].degree += areNeighbours(graph, row, column);
+        }
+        start[row + 1] = start[row] + degrees[row].degree;
+    }
+    qsort(degrees, neuronCount, sizeof(Degree), compareDegrees);
+
+    // List the neighbours of each neuron by increasing degree.
+    int *neighbours;
+    if ((neighbours = (int *) malloc(((size_t) start[neuronCount] + 1) * sizeof(int))) == NULL) {
+        free(degrees);
+        free(order);
+        free(start);
+        free(visited);
+        return NULL;
+    }
+    for (int row = 0, filled = 0; row < neuronCount; ++row) {
+        for (int i = 0; i < neuronCount; ++i) {
+            if (areNeighbours(graph, row, degrees[i].neuron)) {
+                neighbours[filled++] = degrees[i].neuron;
+            }
+        }
+    }
+
+    // Visit each component breadth first from its unvisited neuron of least degree (order is the queue).
+    int listed = 0;
+    for (int i = 0; i < neuronCount; ++i) {
+        if (visited[degrees[i].neuron]) {
+            continue;
+        }
+        visited[degrees[i].neuron] = 1;
+        order[listed++] = degrees[i].neuron;
+        for (int next = listed - 1; next < listed; ++next) {
+            int neuron = order[next];
+            for (int n = start[neuron]; n < start[neuron + 1]; ++n) {
+                if (!visited[neighbours[n]]) {
+                    visited[neighbours[n]] = 1;
+                    order[listed++] = neighbours[n];
+                }
+            }
+        }
+    }
+
+    free(degrees);
+    free(start);
+    free(neighbours);
+    free(visited);
+    return order;
+}
+
+/**
+ * @brief Cuts the neurons, listed by their positions, into contiguous ranges and counts the edges between them.
+ *
+ * @param graph the graph.
+ * @param position the position of each neuron (NULL to list the neurons in the order of their numbers).
+ * @param partition the partition whose count is set and whose bounds and edge counts are stored.
+ * @return int - 1 if the neurons were cut, otherwise 0 (memory could not be allocated).
+ */
+static int cutPositions(Graph *graph, const int position[], Partition *partition) {
+    int neuronCount = graph->vertexCount;
+    partition->edges = 0;
+    partition->crossEdges = 0;
+
+    // Allocate heap memory for the edges spanning each cut and the partition at each position.
+    long *spanning = (long *) calloc(neuronCount + 1, sizeof(long));
+    int *owner = (int *) malloc(neuronCount * sizeof(int));
+    if (spanning == NULL || owner == NULL) {
+        free(spanning);
+        free(owner);
+        return 0;
+    }
+
+    // Count the edges spanning each cut (an edge between positions i < j spans the cuts i + 1 to j).
+    for (int row = 0; row < neuronCount; ++row) {
+        for (int column = 0; column < neuronCount; ++column) {
+            if (row != column && graph->adjMatrix[row][column] != 0.0) {
+                int a = position != NULL ? position[row] : row, b = position != NULL ? position[column] : column;
+                int low = a < b ? a : b, high = a < b ? b : a;
+                ++spanning[low + 1];
+                --spanning[high + 1];
+                ++partition->edges;
+            }
+        }
+    }
+    for (int cut = 1; cut <= neuronCount; ++cut) {
+        spanning[cut] += spanning[cut - 1];
+    }
+
+    // Place each cut near its even share where the fewest edges span it.
+    int slack = neuronCount / partition->count / PARTITION_SLACK;
+    partition->first[0] = 0;
+    partition->first[partition->count] = neuronCount;
+    for (int p = 1; p < partition->count; ++p) {
+        int even = (long) p * neuronCount / partition->count;
+        int best = even;
+        for (int cut = even - slack; cut <= even + slack; ++cut) {
+            if (cut > partition->first[p - 1] && cut < neuronCount && spanning[cut] < spanning[best]) {
+                best = cut;
+            }
+        }
+        partition->first[p] = best;
+    }
+
+    // Count the edges between partitions.
+    for (int p = 0; p < partition->count; ++p) {
+        for (int at = partition->first[p]; at < partition->first[p + 1]; ++at) {
+            owner[at] = p;
+        }
+    }
+    for (int row = 0; row < neuronCount; ++row) {
+        for (int column = 0; column < neuronCount; ++column) {
+            if (row != column && graph->adjMatrix[row][column] != 0.0 &&
+                owner[position != NULL ? position[row] : row] != owner[position != NULL ? position[column] : column]) {
+                ++partition->crossEdges;
+            }
+        }
+    }
+
+    free(spanning);
+    free(owner);
+    return 1;
+}
+
+Partition initPartition(Graph *graph, int count) {
+    int neuronCount = graph->vertexCount;
+    Partition partition = {
+        .count = count < neuronCount ? count : neuronCount,
+        .neurons = NULL
+    };
+
+    // Allocate heap memory for the partition bounds, the bounds of the other split, and the positions.
+    partition.first = (int *) malloc((partition.count + 1) * sizeof(int));
+    int *first = (int *) malloc((partition.count + 1) * sizeof(int));
+    int *position = (int *) malloc(neuronCount * sizeof(int));
+    int *order = NULL;
+
+    // Cut the neurons in the order of their numbers, then in Cuthill-McKee order.
+    Partition ordered = partition;
+    ordered.first = first;
+    if (partition.first == NULL || first == NULL || position == NULL || !cutPositions(graph, NULL, &partition) ||
+        (order = orderNeurons(graph)) == NULL) {
+        free(partition.first);
+        free(first);
+        free(position);
+        partition.first = NULL;
+        return partition;
+    }
+    for (int at = 0; at < neuronCount; ++at) {
+        position[order[at]] = at;
+    }
+    if (!cutPositions(graph, position, &ordered)) {
+        ordered.crossEdges = partition.crossEdges;
+    }
+
+    // Keep the split crossing fewer edges.
+    if (ordered.crossEdges < partition.crossEdges) {
+        free(partition.first);
+        partition = ordered;
+        partition.neurons = order;
+    }
+    else {
+        free(first);
+        free(order);
+    }
+    free(position);
+
+    return partition;
+}
+
+int pinThread(int worker) {
+    // Find the cores the process may run on.
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return 0;
+    }
+
+    // Pin the thread to the worker-th allowed core (wrapping around when there are more workers than cores).
+    int target = worker % CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+            cpu_set_t core;
+            CPU_ZERO(&core);
+            CPU_SET(cpu, &core);
+            return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &core) == 0;
+        }
+    }
+
+    return 0;
+}
+
+void freePartition(Partition *partition) {
+    // Free the bounds and neurons arrays.
+    free(partition->first);
+    free(partition->neurons);
+    partition->first = NULL;
+    partition->neurons = NULL;
+}
\ No newline at end of file
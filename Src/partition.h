@@ -0,0 +1,78 @@
+/**
+ * @file partition.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that splits the neurons of a graph between threads and places the threads on cores.
+ * @version 0.1
+ * @date 2022-10-10
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef PARTITION
+#define PARTITION
+
+#include "graph_manipulations.h"
+
+#define PARTITION_SLACK 10  // Each cut may move by up to 1/PARTITION_SLACK of a partition to cross fewer edges.
+
+/**
+ * @brief A partition structure which splits a listing of the neurons into contiguous ranges, one for each thread.
+ */
+typedef struct {
+    /**
+     * @brief The number of partitions.
+     */
+    int count;
+
+    /**
+     * @brief The first position of each partition, followed by the number of neurons. Partition p holds the neurons
+     * at positions first[p] to first[p + 1] - 1.
+     */
+    int *first;
+
+    /**
+     * @brief The neuron at each position (NULL when each neuron is at the position of its own number).
+     */
+    int *neurons;
+
+    /**
+     * @brief The number of edges (non-zero weights between different neurons).
+     */
+    long edges;
+
+    /**
+     * @brief The number of edges whose neurons are in different partitions.
+     */
+    long crossEdges;
+} Partition;
+
+/**
+ * @brief Splits the neurons of a graph into partitions of nearly equal size. The neurons are listed in Cuthill-McKee
+ * order (breadth first from a neuron of least degree in each component, visiting neighbours by increasing degree),
+ * which places neighbours near each other however they are numbered, and the listing is cut into contiguous ranges.
+ * Each cut is moved within its slack to where the fewest edges span it. If cutting the neurons in the order of their
+ * numbers crosses no more edges, that split is kept instead (and neurons is NULL).
+ *
+ * @param graph the graph.
+ * @param count the number of partitions (at most the number of neurons).
+ * @return Partition - the initialized partition structure (NULL bounds if memory could not be allocated).
+ */
+Partition initPartition(Graph *graph, int count);
+
+/**
+ * @brief Pins the calling thread to one of the cores the process may run on. Consecutive workers get consecutive
+ * cores, so neighbouring partitions share a socket when the cores of a socket are numbered together.
+ *
+ * @param worker the number of the worker.
+ * @return int - 1 if the thread was pinned, otherwise 0.
+ */
+int pinThread(int worker);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a partition structure.
+ *
+ * @param partition the partition to be freed.
+ */
+void freePartition(Partition *partition);
+
+#endif
\ No newline at end of file
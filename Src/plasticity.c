@@ -0,0 +1,269 @@
+/**
+ * @file plasticity.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the plasticity header file.
+ * @version 0.1
+ * @date 2022-10-12
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "plasticity.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#define INITIAL_SNAPSHOT_CAPACITY 16    // The number of snapshots that fit before the snapshot arrays first grow.
+#define SNAPSHOT_TOLERANCE 1e-4         // The fraction of the interval a snapshot may be taken early (for the rounding of x).
+
+/**
+ * @brief Stores the current weight of every edge as a snapshot, growing the snapshot arrays if needed.
+ *
+ * @param plasticity the plasticity.
+ * @param curX the x position of the snapshot.
+ * @return int - 1 if the snapshot was taken, otherwise 0 (memory could not be allocated).
+ */
+static int takeSnapshot(Plasticity *plasticity, float curX) {
+    // Double the capacity when full.
+    if (plasticity->snapshotCount == plasticity->snapshotCapacity) {
+        int capacity = 2 * plasticity->snapshotCapacity;
+        float *snapshots, *snapshotX;
+        if ((snapshots = (float *) realloc(plasticity->snapshots, (size_t) capacity * (plasticity->edgeCount ? plasticity->edgeCount : 1) * sizeof(float))) == NULL) {
+            return 0;
+        }
+        plasticity->snapshots = snapshots;
+        if ((snapshotX = (float *) realloc(plasticity->snapshotX, capacity * sizeof(float))) == NULL) {
+            return 0;
+        }
+        plasticity->snapshotX = snapshotX;
+        plasticity->snapshotCapacity = capacity;
+    }
+
+    // Copy the weights of the in-edges of each neuron.
+    float *weights = &plasticity->snapshots[(size_t) plasticity->snapshotCount * plasticity->edgeCount];
+    for (int post = 0; post < plasticity->graph->vertexCount; ++post) {
+        for (int edge = plasticity->inStart[post]; edge < plasticity->inStart[post + 1]; ++edge) {
+            weights[edge] = plasticity->graph->adjMatrix[post][plasticity->inSources[edge]];
+        }
+    }
+    plasticity->snapshotX[plasticity->snapshotCount++] = curX;
+    return 1;
+}
+
+/**
+ * @brief Keeps a weight between 0 and the largest weight.
+ *
+ * @param weight the weight.
+ * @param maxWeight the largest weight.
+ * @return float - the clamped weight.
+ */
+static float clampWeight(float weight, float maxWeight) {
+    return weight < 0.0 ? 0.0 : weight > maxWeight ? maxWeight : weight;
+}
+
+/**
+ * @brief Frees a plasticity structure whose plastic graph was allocated but whose other memory may not have been.
+ *
+ * @param plasticity the plasticity.
+ * @return Plasticity - the plasticity with a NULL graph, marking that memory could not be allocated.
+ */
+static Plasticity failPlasticity(Plasticity *plasticity) {
+    freePlasticity(plasticity);
+    plasticity->graph = NULL;
+    return *plasticity;
+}
+
+Plasticity initPlasticity(PlasticityParams *params, Graph *graph, float x0) {
+    int neuronCount = graph->vertexCount;
+    Plasticity plasticity = {
+        .params = *params,
+        .spikedCount = 0,
+        .detector = initSpikeDetector(neuronCount, params->threshold),
+        .edgeCount = 0,
+        .updateCount = 0,
+        .snapshotCount = 0,
+        .snapshotCapacity = INITIAL_SNAPSHOT_CAPACITY,
+        .nextSnapshot = x0
+    };
+
+    // Allocate heap memory for the plastic copy of the graph.
+    float **rows = (float **) malloc(neuronCount * sizeof(float *));
+    float *matrix = (float *) malloc((size_t) neuronCount * neuronCount * sizeof(float));
+    if ((plasticity.graph = (Graph *) malloc(sizeof(Graph))) == NULL || rows == NULL || matrix == NULL) {
+        free(plasticity.graph);
+        free(rows);
+        free(matrix);
+        freeSpikeDetector(&plasticity.detector);
+        plasticity.graph = NULL;
+        return plasticity;
+    }
+    plasticity.graph->adjMatrix = rows;
+    plasticity.graph->vertexCount = neuronCount;
+    for (int row = 0; row < neuronCount; ++row) {
+        plasticity.graph->adjMatrix[row] = matrix + (size_t) row * neuronCount;
+        memcpy(plasticity.graph->adjMatrix[row], graph->adjMatrix[row], neuronCount * sizeof(float));
+    }
+
+    // Allocate zeroed heap memory for the edge offsets and the traces.
+    plasticity.inStart = (int *) calloc(neuronCount + 1, sizeof(int));
+    plasticity.outStart = (int *) calloc(neuronCount + 1, sizeof(int));
+    plasticity.preTrace = (float *) calloc(neuronCount, sizeof(float));
+    plasticity.postTrace = (float *) calloc(neuronCount, sizeof(float));
+    plasticity.lastSpike = (float *) calloc(neuronCount, sizeof(float));
+    plasticity.spiked = (int *) calloc(neuronCount, sizeof(int));
+    if (plasticity.inStart == NULL || plasticity.outStart == NULL || plasticity.preTrace == NULL || plasticity.postTrace == NULL ||
+        plasticity.lastSpike == NULL || plasticity.spiked == NULL || plasticity.detector.prev == NULL) {
+        return failPlasticity(&plasticity);
+    }
+
+    // Count the in-edges (row) and out-edges (column) of each neuron.
+    for (int post = 0; post < neuronCount; ++post) {
+        for (int pre = 0; pre < neuronCount; ++pre) {
+            if (pre != post && graph->adjMatrix[post][pre] != 0.0) {
+                ++plasticity.inStart[post + 1];
+                ++plasticity.outStart[pre + 1];
+                ++plasticity.edgeCount;
+            }
+        }
+    }
+    for (int neuron = 0; neuron < neuronCount; ++neuron) {
+        plasticity.inStart[neuron + 1] += plasticity.inStart[neuron];
+        plasticity.outStart[neuron + 1] += plasticity.outStart[neuron];
+        plasticity.lastSpike[neuron] = x0;
+    }
+
+    // Allocate heap memory for the edges and the snapshots.
+    int edgeCount = plasticity.edgeCount ? plasticity.edgeCount : 1;
+    plasticity.inSources = (int *) malloc(edgeCount * sizeof(int));
+    plasticity.outTargets = (int *) malloc(edgeCount * sizeof(int));
+    plasticity.snapshots = (float *) malloc((size_t) plasticity.snapshotCapacity * edgeCount * sizeof(float));
+    plasticity.snapshotX = (float *) malloc(plasticity.snapshotCapacity * sizeof(float));
+    int *filled = (int *) malloc(neuronCount * sizeof(int));
+    if (plasticity.inSources == NULL || plasticity.outTargets == NULL || plasticity.snapshots == NULL || plasticity.snapshotX == NULL || filled == NULL) {
+        free(filled);
+        return failPlasticity(&plasticity);
+    }
+
+    // Fill in the in-edges of each postsynaptic neuron and the out-edges of each presynaptic neuron.
+    for (int pre = 0; pre < neuronCount; ++pre) {
+        filled[pre] = plasticity.outStart[pre];
+    }
+    for (int post = 0; post < neuronCount; ++post) {
+        int in = plasticity.inStart[post];
+        for (int pre = 0; pre < neuronCount; ++pre) {
+            if (pre != post && graph->adjMatrix[post][pre] != 0.0) {
+                plasticity.inSources[in++] = pre;
+                plasticity.outTargets[filled[pre]++] = post;
+            }
+        }
+    }
+    free(filled);
+
+    // Take the first snapshot at the start.
+    if (params->snapshotInterval > 0.0) {
+        takeSnapshot(&plasticity, x0);
+        plasticity.nextSnapshot = x0 + params->snapshotInterval;
+    }
+
+    return plasticity;
+}
+
+void detectPlasticSpike(Plasticity *plasticity, int neuron, float voltage) {
+    // Only neurons with edges need to be updated.
+    if (detectSpike(&plasticity->detector, neuron, voltage) &&
+        (plasticity->inStart[neuron] < plasticity->inStart[neuron + 1] || plasticity->outStart[neuron] < plasticity->outStart[neuron + 1])) {
+        plasticity->spiked[plasticity->spikedCount++] = neuron;
+    }
+}
+
+int applyPlasticity(Plasticity *plasticity, float spikeX, float curX) {
+    PlasticityParams *params = &plasticity->params;
+    float **weights = plasticity->graph->adjMatrix;
+
+    for (int s = 0; s < plasticity->spikedCount; ++s) {
+        int neuron = plasticity->spiked[s];
+
+        // Potentiate the in-edges by the decayed trace of each presynaptic neuron.
+        for (int edge = plasticity->inStart[neuron]; edge < plasticity->inStart[neuron + 1]; ++edge) {
+            int pre = plasticity->inSources[edge];
+            float trace = plasticity->preTrace[pre] * expf(-(spikeX - plasticity->lastSpike[pre]) / params->tauPlus);
+            weights[neuron][pre] = clampWeight(weights[neuron][pre] + params->potentiation * trace, params->maxWeight);
+        }
+
+        // Depress the out-edges by the decayed trace of each postsynaptic neuron.
+        for (int edge = plasticity->outStart[neuron]; edge < plasticity->outStart[neuron + 1]; ++edge) {
+            int post = plasticity->outTargets[edge];
+            float trace = plasticity->postTrace[post] * expf(-(spikeX - plasticity->lastSpike[post]) / params->tauMinus);
+            weights[post][neuron] = clampWeight(weights[post][neuron] - params->depression * trace, params->maxWeight);
+        }
+        plasticity->updateCount += plasticity->inStart[neuron + 1] - plasticity->inStart[neuron] + plasticity->outStart[neuron + 1] - plasticity->outStart[neuron];
+    }
+
+    // Add the spikes to the traces once every update has seen the old ones.
+    for (int s = 0; s < plasticity->spikedCount; ++s) {
+        int neuron = plasticity->spiked[s];
+        plasticity->preTrace[neuron] = plasticity->preTrace[neuron] * expf(-(spikeX - plasticity->lastSpike[neuron]) / params->tauPlus) + 1.0;
+        plasticity->postTrace[neuron] = plasticity->postTrace[neuron] * expf(-(spikeX - plasticity->lastSpike[neuron]) / params->tauMinus) + 1.0;
+        plasticity->lastSpike[neuron] = spikeX;
+    }
+    plasticity->spikedCount = 0;
+
+    // Take a snapshot once the interval has passed.
+    if (params->snapshotInterval > 0.0 && curX >= plasticity->nextSnapshot - SNAPSHOT_TOLERANCE * params->snapshotInterval) {
+        if (!takeSnapshot(plasticity, curX)) {
+            return 0;
+        }
+        while (plasticity->nextSnapshot <= curX + SNAPSHOT_TOLERANCE * params->snapshotInterval) {
+            plasticity->nextSnapshot += params->snapshotInterval;
+        }
+    }
+    return 1;
+}
+
+int writeWeightSnapshots(const Plasticity *plasticity, const char *filename) {
+    // Open output file for writing.
+    FILE *outfile;
+    if ((outfile = fopen(filename, "wb")) == NULL) {
+        return 0;
+    }
+
+    // Write the header and the edges.
+    int32_t counts[3] = {plasticity->graph->vertexCount, plasticity->edgeCount, plasticity->snapshotCount};
+    int written = fwrite(SNAPSHOT_MAGIC, 1, 4, outfile) == 4 && fwrite(counts, sizeof(int32_t), 3, outfile) == 3;
+    for (int post = 0; post < plasticity->graph->vertexCount && written; ++post) {
+        for (int edge = plasticity->inStart[post]; edge < plasticity->inStart[post + 1] && written; ++edge) {
+            int32_t pair[2] = {post, plasticity->inSources[edge]};
+            written = fwrite(pair, sizeof(int32_t), 2, outfile) == 2;
+        }
+    }
+
+    // Write each snapshot.
+    for (int snapshot = 0; snapshot < plasticity->snapshotCount && written; ++snapshot) {
+        written = fwrite(&plasticity->snapshotX[snapshot], sizeof(float), 1, outfile) == 1 &&
+                  fwrite(&plasticity->snapshots[(size_t) snapshot * plasticity->edgeCount], sizeof(float), plasticity->edgeCount, outfile) == (size_t) plasticity->edgeCount;
+    }
+
+    // Close ouput file.
+    return fclose(outfile) == 0 && written;
+}
+
+void freePlasticity(Plasticity *plasticity) {
+    // Free the plastic graph, edges, traces, detector, and snapshots.
+    free(plasticity->graph->adjMatrix[0]);
+    free(plasticity->graph->adjMatrix);
+    free(plasticity->graph);
+    free(plasticity->inStart);
+    free(plasticity->inSources);
+    free(plasticity->outStart);
+    free(plasticity->outTargets);
+    free(plasticity->preTrace);
+    free(plasticity->postTrace);
+    free(plasticity->lastSpike);
+    free(plasticity->spiked);
+    freeSpikeDetector(&plasticity->detector);
+    free(plasticity->snapshots);
+    free(plasticity->snapshotX);
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+/**
+ * @file plasticity.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that implements pair-based spike-timing-dependent plasticity (STDP) of the coupling
+ * weights, updating only the edges of the neurons that spiked.
+ * @version 0.1
+ * @date 2022-10-12
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef PLASTICITY
+#define PLASTICITY
+
+#include "graph_manipulations.h"
+#include "spike_calculations.h"
+
+#define SNAPSHOT_MAGIC "NSW1"   // The first bytes of a weight snapshot file.
+
+/**
+ * @brief A parameters structure which describes the plasticity rule.
+ */
+typedef struct {
+    /**
+     * @brief The weight added to an in-edge per unit of presynaptic trace when the postsynaptic neuron spikes.
+     */
+    float potentiation;
+
+    /**
+     * @brief The weight removed from an out-edge per unit of postsynaptic trace when the presynaptic neuron spikes.
+     */
+    float depression;
+
+    /**
+     * @brief The time constant the presynaptic traces decay with.
+     */
+    float tauPlus;
+
+    /**
+     * @brief The time constant the postsynaptic traces decay with.
+     */
+    float tauMinus;
+
+    /**
+     * @brief The largest weight an edge may reach (weights never go below 0).
+     */
+    float maxWeight;
+
+    /**
+     * @brief The minimum value a spike must reach.
+     */
+    float threshold;
+
+    /**
+     * @brief The x distance between weight snapshots (0 for none).
+     */
+    float snapshotInterval;
+} PlasticityParams;
+
+/**
+ * @brief A plasticity structure which owns the plastic copy of the weights and the trace of every neuron. Only the edges
+ * of the original graph are plastic, so the in- and out-edges of each neuron are kept as lists.
+ */
+typedef struct {
+    /**
+     * @brief The plasticity parameters.
+     */
+    PlasticityParams params;
+
+    /**
+     * @brief The plastic copy of the graph read by the coupling (adjMatrix[post][pre] is the weight of pre onto post).
+     */
+    Graph *graph;
+
+    /**
+     * @brief The offsets of each neuron's in-edges within inSources. Neuron n owns [inStart[n], inStart[n + 1]).
+     */
+    int *inStart;
+
+    /**
+     * @brief The presynaptic neuron of each in-edge (also the order of the edges in a snapshot).
+     */
+    int *inSources;
+
+    /**
+     * @brief The offsets of each neuron's out-edges within outTargets. Neuron n owns [outStart[n], outStart[n + 1]).
+     */
+    int *outStart;
+
+    /**
+     * @brief The postsynaptic neuron of each out-edge.
+     */
+    int *outTargets;
+
+    /**
+     * @brief The presynaptic and postsynaptic trace of each neuron at its last spike. Access using preTrace[neuronNum].
+     */
+    float *preTrace, *postTrace;
+
+    /**
+     * @brief The x position of the last spike of each neuron. Access using lastSpike[neuronNum].
+     */
+    float *lastSpike;
+
+    /**
+     * @brief The neurons that spiked during the current step.
+     */
+    int *spiked;
+
+    /**
+     * @brief The number of neurons in the spiked array.
+     */
+    int spikedCount;
+
+    /**
+     * @brief The online detector used to find spikes.
+     */
+    SpikeDetector detector;
+
+    /**
+     * @brief The number of edges.
+     */
+    int edgeCount;
+
+    /**
+     * @brief The number of edge weights updated so far.
+     */
+    long updateCount;
+
+    /**
+     * @brief The edge weights of each snapshot in the order of inSources. Access using snapshots[snapshotNum * edgeCount + edgeNum].
+     */
+    float *snapshots;
+
+    /**
+     * @brief The x position of each snapshot. Access using snapshotX[snapshotNum].
+     */
+    float *snapshotX;
+
+    /**
+     * @brief The number of snapshots taken and the number that fit before growing.
+     */
+    int snapshotCount, snapshotCapacity;
+
+    /**
+     * @brief The x position of the next snapshot.
+     */
+    float nextSnapshot;
+} Plasticity;
+
+/**
+ * @brief Initializes and allocates memory for a plasticity structure, copying the weights of a graph and taking the first
+ * snapshot.
+ *
+ * @param params the plasticity parameters.
+ * @param graph the graph whose edges become plastic (it is not modified).
+ * @param x0 the starting x position.
+ * @return Plasticity - the initialized plasticity structure (a NULL graph if memory could not be allocated).
+ */
+Plasticity initPlasticity(PlasticityParams *params, Graph *graph, float x0);
+
+/**
+ * @brief Feeds the newest voltage of a neuron to the spike detector and queues the neuron for an update if it spiked.
+ *
+ * @param plasticity the plasticity.
+ * @param neuron the number of the neuron.
+ * @param voltage the voltage of the neuron at the end of the step.
+ */
+void detectPlasticSpike(Plasticity *plasticity, int neuron, float voltage);
+
+/**
+ * @brief Updates the in- and out-edges of every neuron that spiked during the step, then adds their spikes to the traces.
+ * Every update of a step sees the traces from before the step, so the order of the neurons does not matter. A snapshot is
+ * taken once curX reaches the next snapshot.
+ *
+ * @param plasticity the plasticity.
+ * @param spikeX the x position of the spikes found during the step (the start of the step, where the peaks occurred).
+ * @param curX the x position at the end of the step.
+ * @return int - 1 if the edges were updated, otherwise 0 (memory for a snapshot could not be allocated).
+ */
+int applyPlasticity(Plasticity *plasticity, float spikeX, float curX);
+
+/**
+ * @brief Writes the weight snapshots to a binary file: SNAPSHOT_MAGIC, the neuron, edge, and snapshot counts (int32), the
+ * (post, pre) pair of every edge (int32), then the x position and edge weights of each snapshot (float32).
+ *
+ * @param plasticity the plasticity.
+ * @param filename the name of the file to write to.
+ * @return int - 1 if the file was written, otherwise 0.
+ */
+int writeWeightSnapshots(const Plasticity *plasticity, const char *filename);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a plasticity structure.
+ *
+ * @param plasticity the plasticity to be freed.
+ */
+void freePlasticity(Plasticity *plasticity);
+
+#endif
\ No newline at end of file
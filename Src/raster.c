@@ -0,0 +1,310 @@
+/**
+ * @file raster.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the raster header file.
+ * @version 0.1
+ * @date 2022-10-21
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "raster.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define VARINT_MAX_BYTES 5  // The most bytes a 32-bit varint takes.
+
+Raster initRaster(int neuronCount, float x0, float step, int flags) {
+    Raster raster = {
+        .header = {
+            .neuronCount = neuronCount,
+            .flags = flags,
+            .x0 = x0,
+            .step = step,
+            .lastStep = 0,
+            .spikeCount = 0
+        }
+    };
+
+    // Allocate zeroed heap memory for the spikes of every neuron.
+    raster.neurons = (RasterNeuron *) calloc(neuronCount, sizeof(RasterNeuron));
+
+    return raster;
+}
+
+/**
+ * @brief Appends an unsigned varint (7 bits per byte, lowest first, the high bit set on all but the last) to a neuron.
+ *
+ * @param neuron the neuron.
+ * @param value the value.
+ * @return int - 1 if the value was appended, otherwise 0 (memory could not be allocated).
+ */
+static int appendVarint(RasterNeuron *neuron, uint32_t value) {
+    if (neuron->bytes + VARINT_MAX_BYTES > neuron->byteCapacity) {
+        int byteCapacity = neuron->byteCapacity ? 2 * neuron->byteCapacity : 64;
+        unsigned char *deltas;
+        if ((deltas = (unsigned char *) realloc(neuron->deltas, byteCapacity)) == NULL) {
+            return 0;
+        }
+        neuron->deltas = deltas;
+        neuron->byteCapacity = byteCapacity;
+    }
+
+    do {
+        unsigned char byte = value & 0x7F;
+        value >>= 7;
+        neuron->deltas[neuron->bytes++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return 1;
+}
+
+int addRasterSpike(Raster *raster, int neuron, int step, float peak) {
+    RasterNeuron *spikes = &raster->neurons[neuron];
+
+    // Grow the checkpoints and peaks with the spikes.
+    if (spikes->count == spikes->capacity) {
+        int capacity = spikes->capacity ? 2 * spikes->capacity : 16;
+        size_t checkpointCount = (capacity + RASTER_CHECKPOINT - 1) / RASTER_CHECKPOINT;
+        int32_t *checkpoints;
+        float *peaks;
+        if ((checkpoints = (int32_t *) realloc(spikes->checkpoints, 2 * checkpointCount * sizeof(int32_t))) == NULL) {
+            return 0;
+        }
+        spikes->checkpoints = checkpoints;
+        if (raster->header.flags & RASTER_PEAKS) {
+            if ((peaks = (float *) realloc(spikes->peaks, capacity * sizeof(float))) == NULL) {
+                return 0;
+            }
+            spikes->peaks = peaks;
+        }
+        spikes->capacity = capacity;
+    }
+
+    // Mark every RASTER_CHECKPOINT-th spike so reading can start there.
+    if (spikes->count % RASTER_CHECKPOINT == 0) {
+        int checkpoint = spikes->count / RASTER_CHECKPOINT;
+        spikes->checkpoints[2 * checkpoint] = spikes->lastStep;
+        spikes->checkpoints[2 * checkpoint + 1] = spikes->bytes;
+    }
+
+    if (!appendVarint(spikes, (uint32_t) (step - spikes->lastStep))) {
+        return 0;
+    }
+    if (spikes->peaks != NULL) {
+        spikes->peaks[spikes->count] = peak;
+    }
+    spikes->lastStep = step;
+    ++spikes->count;
+
+    raster->header.lastStep = step > raster->header.lastStep ? step : raster->header.lastStep;
+    ++raster->header.spikeCount;
+    return 1;
+}
+
+int addRasterPoints(Raster *raster, int neuron, const Points *spikes, const float x[], int stepCount) {
+    // The spikes are in order, so each search starts after the step of the one before.
+    int low = 0;
+    for (int i = 0; i < spikes->size; ++i) {
+        int high = stepCount;
+        while (low < high) {
+            int middle = low + (high - low) / 2;
+            if (x[middle] < spikes->x[i]) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        if (!addRasterSpike(raster, neuron, low, spikes->y[i])) {
+            return 0;
+        }
+        ++low;
+    }
+    return 1;
+}
+
+/**
+ * @brief Counts the checkpoints of a neuron.
+ *
+ * @param count the number of spikes of the neuron.
+ * @return int - the number of checkpoints.
+ */
+static int countCheckpoints(int count) {
+    return (count + RASTER_CHECKPOINT - 1) / RASTER_CHECKPOINT;
+}
+
+int writeRaster(const Raster *raster, const char *filename) {
+    const RasterHeader *header = &raster->header;
+    RasterEntry *index;
+    if ((index = (RasterEntry *) malloc(header->neuronCount * sizeof(RasterEntry))) == NULL) {
+        return 0;
+    }
+
+    // Place the block of each neuron after the header and index.
+    int64_t offset = 4 + sizeof(RasterHeader) + (int64_t) header->neuronCount * sizeof(RasterEntry);
+    for (int neuron = 0; neuron < header->neuronCount; ++neuron) {
+        const RasterNeuron *spikes = &raster->neurons[neuron];
+        index[neuron] = (RasterEntry) {
+            .offset = offset,
+            .count = spikes->count,
+            .bytes = spikes->bytes
+        };
+        offset += 2 * sizeof(int32_t) * countCheckpoints(spikes->count) + spikes->bytes + (spikes->peaks != NULL ? spikes->count * sizeof(float) : 0);
+    }
+
+    // Open output file for writing.
+    FILE *outfile;
+    if ((outfile = fopen(filename, "wb")) == NULL) {
+        free(index);
+        return 0;
+    }
+
+    // Write the header, the index, and then the block of each neuron.
+    int written = fwrite(RASTER_MAGIC, 1, 4, outfile) == 4 && fwrite(header, sizeof(RasterHeader), 1, outfile) == 1 &&
+                  fwrite(index, sizeof(RasterEntry), header->neuronCount, outfile) == (size_t) header->neuronCount;
+    for (int neuron = 0; neuron < header->neuronCount && written; ++neuron) {
+        const RasterNeuron *spikes = &raster->neurons[neuron];
+        size_t checkpointValues = 2 * countCheckpoints(spikes->count);
+        written = fwrite(spikes->checkpoints, sizeof(int32_t), checkpointValues, outfile) == checkpointValues &&
+                  fwrite(spikes->deltas, 1, spikes->bytes, outfile) == (size_t) spikes->bytes &&
+                  (spikes->peaks == NULL || fwrite(spikes->peaks, sizeof(float), spikes->count, outfile) == (size_t) spikes->count);
+    }
+
+    // Close ouput file.
+    free(index);
+    return fclose(outfile) == 0 && written;
+}
+
+void freeRaster(Raster *raster) {
+    for (int neuron = 0; raster->neurons != NULL && neuron < raster->header.neuronCount; ++neuron) {
+        free(raster->neurons[neuron].deltas);
+        free(raster->neurons[neuron].checkpoints);
+        free(raster->neurons[neuron].peaks);
+    }
+    free(raster->neurons);
+}
+
+int openRaster(const char *filename, RasterFile *file) {
+    // Open input file for reading.
+    if ((file->file = fopen(filename, "rb")) == NULL) {
+        return 0;
+    }
+
+    // Read and check the header.
+    char magic[4];
+    RasterHeader *header = &file->header;
+    if (fread(magic, 1, 4, file->file) != 4 || memcmp(magic, RASTER_MAGIC, 4) != 0 || fread(header, sizeof(RasterHeader), 1, file->file) != 1 ||
+        header->neuronCount < 1 || header->lastStep < 0 || header->step <= 0.0) {
+        fclose(file->file);
+        return 0;
+    }
+
+    // Read the index, and step from x0 to the last spike as the solver did.
+    file->index = (RasterEntry *) malloc(header->neuronCount * sizeof(RasterEntry));
+    file->x = (float *) malloc(((size_t) header->lastStep + 1) * sizeof(float));
+    if (file->index == NULL || file->x == NULL ||
+        fread(file->index, sizeof(RasterEntry), header->neuronCount, file->file) != (size_t) header->neuronCount) {
+        closeRaster(file);
+        return 0;
+    }
+    file->x[0] = header->x0;
+    for (int step = 0; step < header->lastStep; ++step) {
+        file->x[step + 1] = file->x[step] + header->step;
+    }
+
+    return 1;
+}
+
+int findRasterStep(const RasterFile *file, float x) {
+    int low = 0, high = file->header.lastStep + 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (file->x[middle] < x) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int readRasterSpikes(const RasterFile *file, int neuron, int first, int last, Points *spikes) {
+    const RasterEntry *entry = &file->index[neuron];
+    if (entry->count == 0 || first > last) {
+        return 1;
+    }
+
+    // Read the checkpoints and start from the last one before the range.
+    int checkpointCount = countCheckpoints(entry->count);
+    int32_t *checkpoints;
+    if ((checkpoints = (int32_t *) malloc(2 * checkpointCount * sizeof(int32_t))) == NULL) {
+        return 0;
+    }
+    int64_t deltaStart = entry->offset + 2 * sizeof(int32_t) * checkpointCount;
+    if (fseek(file->file, entry->offset, SEEK_SET) != 0 ||
+        fread(checkpoints, sizeof(int32_t), 2 * checkpointCount, file->file) != (size_t) (2 * checkpointCount)) {
+        free(checkpoints);
+        return 0;
+    }
+    int low = 0, high = checkpointCount - 1;
+    while (low < high) {
+        int middle = low + (high - low + 1) / 2;
+        if (checkpoints[2 * middle] < first) {
+            low = middle;
+        }
+        else {
+            high = middle - 1;
+        }
+    }
+    int step = checkpoints[2 * low], byte = checkpoints[2 * low + 1];
+    free(checkpoints);
+    if (fseek(file->file, deltaStart + byte, SEEK_SET) != 0) {
+        return 0;
+    }
+
+    // Decode the steps until one is past the range.
+    int start = spikes->size, firstSpike = -1;
+    for (int spike = low * RASTER_CHECKPOINT; spike < entry->count; ++spike) {
+        uint32_t delta = 0;
+        int c, shift = 0;
+        do {
+            if ((c = getc(file->file)) == EOF || shift >= 7 * VARINT_MAX_BYTES) {
+                return 0;
+            }
+            delta |= (uint32_t) (c & 0x7F) << shift;
+            shift += 7;
+        } while (c & 0x80);
+        step += delta;
+        if (step > last) {
+            break;
+        }
+        if (step >= first) {
+            if (step > file->header.lastStep) {
+                return 0;
+            }
+            firstSpike = firstSpike < 0 ? spike : firstSpike;
+            if (!appendPoint(spikes, file->x[step], 0.0)) {
+                return 0;
+            }
+        }
+    }
+
+    // Read the peaks of the spikes in the range.
+    int found = spikes->size - start;
+    if (found > 0 && file->header.flags & RASTER_PEAKS) {
+        if (fseek(file->file, deltaStart + entry->bytes + (int64_t) firstSpike * sizeof(float), SEEK_SET) != 0 ||
+            fread(&spikes->y[start], sizeof(float), found, file->file) != (size_t) found) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void closeRaster(RasterFile *file) {
+    free(file->index);
+    free(file->x);
+    fclose(file->file);
+}
@@ -0,0 +1,230 @@
+/**
+ * @file raster.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that stores the spikes of every neuron in one compact file, as the step of each
+ * spike delta-encoded in varints, with an index for reading any neuron over any range of steps.
+ * @version 0.1
+ * @date 2022-10-21
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef RASTER
+#define RASTER
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spike_calculations.h"
+
+#define RASTER_MAGIC "NSR1"     // The first bytes of a raster file.
+#define RASTER_PEAKS 0x1        // The raster holds the peak of each spike.
+#define RASTER_CHECKPOINT 64    // The number of spikes between the checkpoints of a neuron.
+
+/**
+ * @brief A raster header structure which describes the run the spikes were found in. The x position of step k is x0
+ * with step added k times in float, exactly as the solver steps, so the spike times are restored bit for bit.
+ */
+typedef struct {
+    /**
+     * @brief The number of neurons.
+     */
+    int32_t neuronCount;
+
+    /**
+     * @brief The RASTER_* flags of the file.
+     */
+    int32_t flags;
+
+    /**
+     * @brief The x position of step 0 and the size of each step.
+     */
+    float x0, step;
+
+    /**
+     * @brief The last step of any spike (0 without spikes).
+     */
+    int32_t lastStep;
+
+    /**
+     * @brief The number of spikes of every neuron.
+     */
+    int64_t spikeCount;
+} RasterHeader;
+
+/**
+ * @brief A raster entry structure which locates the spikes of a neuron. The block of a neuron holds a checkpoint
+ * (int32 step before the spike and int32 byte of its delta) for every RASTER_CHECKPOINT-th spike, then the varint
+ * deltas between the steps of its spikes (the first from step 0), then the peak of each spike (float32) if kept.
+ */
+typedef struct {
+    /**
+     * @brief The byte of the file where the block of the neuron starts.
+     */
+    int64_t offset;
+
+    /**
+     * @brief The number of spikes of the neuron.
+     */
+    int32_t count;
+
+    /**
+     * @brief The number of bytes taken by its deltas.
+     */
+    int32_t bytes;
+} RasterEntry;
+
+/**
+ * @brief A raster neuron structure which holds the encoded spikes of one neuron while a raster is built.
+ */
+typedef struct {
+    /**
+     * @brief The varint deltas of the steps and the number of bytes used and available.
+     */
+    unsigned char *deltas;
+    int bytes, byteCapacity;
+
+    /**
+     * @brief The number of spikes, the number there is room for, and the step of the last one.
+     */
+    int count, capacity, lastStep;
+
+    /**
+     * @brief The checkpoints, in pairs of step and byte. Access using checkpoints[2 * checkpointNum + 0 or 1].
+     */
+    int32_t *checkpoints;
+
+    /**
+     * @brief The peak of each spike (NULL if no peaks are kept).
+     */
+    float *peaks;
+} RasterNeuron;
+
+/**
+ * @brief A raster structure which builds the raster of a run in memory.
+ */
+typedef struct {
+    /**
+     * @brief The header of the raster.
+     */
+    RasterHeader header;
+
+    /**
+     * @brief The spikes of each neuron. Access using neurons[neuronNum].
+     */
+    RasterNeuron *neurons;
+} Raster;
+
+/**
+ * @brief A raster file structure which reads the spikes of an open raster file.
+ */
+typedef struct {
+    /**
+     * @brief The header of the file.
+     */
+    RasterHeader header;
+
+    /**
+     * @brief The entry of each neuron. Access using index[neuronNum].
+     */
+    RasterEntry *index;
+
+    /**
+     * @brief The x position of each step up to the last spike. Access using x[stepNum].
+     */
+    float *x;
+
+    /**
+     * @brief The open file.
+     */
+    FILE *file;
+} RasterFile;
+
+/**
+ * @brief Initializes and allocates memory for a raster structure.
+ *
+ * @param neuronCount the number of neurons.
+ * @param x0 the x position of step 0.
+ * @param step the size of each step.
+ * @param flags the RASTER_* flags.
+ * @return Raster - the initialized raster structure (NULL neurons if memory could not be allocated).
+ */
+Raster initRaster(int neuronCount, float x0, float step, int flags);
+
+/**
+ * @brief Adds a spike to a neuron of a raster.
+ *
+ * @param raster the raster.
+ * @param neuron the number of the neuron.
+ * @param step the step of the spike (after the last spike added to the neuron).
+ * @param peak the peak of the spike (ignored if no peaks are kept).
+ * @return int - 1 if the spike was added, otherwise 0 (memory could not be allocated).
+ */
+int addRasterSpike(Raster *raster, int neuron, int step, float peak);
+
+/**
+ * @brief Adds the spikes a run found for a neuron, finding the step of each from the x position of every step.
+ *
+ * @param raster the raster.
+ * @param neuron the number of the neuron.
+ * @param spikes the spikes (x is the position of each and y its peak).
+ * @param x the x position of each step. Access using x[stepNum].
+ * @param stepCount the number of steps in x.
+ * @return int - 1 if the spikes were added, otherwise 0 (memory could not be allocated).
+ */
+int addRasterPoints(Raster *raster, int neuron, const Points *spikes, const float x[], int stepCount);
+
+/**
+ * @brief Writes a raster to a file.
+ *
+ * @param raster the raster.
+ * @param filename the name of the file.
+ * @return int - 1 if the file was written, otherwise 0.
+ */
+int writeRaster(const Raster *raster, const char *filename);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a raster structure.
+ *
+ * @param raster the raster to be freed.
+ */
+void freeRaster(Raster *raster);
+
+/**
+ * @brief Opens a raster file and reads its header and index.
+ *
+ * @param filename the name of the file.
+ * @param file where to store the open file.
+ * @return int - 1 if the file was opened, otherwise 0 (it is not a raster file or memory could not be allocated).
+ */
+int openRaster(const char *filename, RasterFile *file);
+
+/**
+ * @brief Finds the first step at or after an x position.
+ *
+ * @param file the raster file.
+ * @param x the x position.
+ * @return int - the step (lastStep + 1 if x is past the last spike).
+ */
+int findRasterStep(const RasterFile *file, float x);
+
+/**
+ * @brief Reads the spikes of a neuron within a range of steps, starting from the checkpoint before the range.
+ *
+ * @param file the raster file.
+ * @param neuron the number of the neuron.
+ * @param first the first step.
+ * @param last the last step.
+ * @param spikes the points to append the x position and peak (0 if no peaks are kept) of each spike to.
+ * @return int - 1 if the spikes were read, otherwise 0 (the file is damaged or memory could not be allocated).
+ */
+int readRasterSpikes(const RasterFile *file, int neuron, int first, int last, Points *spikes);
+
+/**
+ * @brief Closes a raster file and frees its index.
+ *
+ * @param file the raster file to be closed.
+ */
+void closeRaster(RasterFile *file);
+
+#endif
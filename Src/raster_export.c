@@ -0,0 +1,151 @@
+/**
+ * @file raster_export.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Driver for exporting the spikes of a raster file as text for gnuplot.
+ * @version 0.1
+ * @date 2022-10-21
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "raster_export.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_RASTER "Out/raster"         // The default raster file.
+#define DEFAULT_OUT_FILE "Out/raster.txt"   // The default text file.
+
+int main(int argc, char *argv[]) {
+    myArgs args = getArgs(argc, argv);
+
+    // Open the raster.
+    RasterFile raster;
+    if (!openRaster(args.filename, &raster)) {
+        fprintf(stderr, "%s could not be read as a raster file, exiting ...\n", args.filename);
+        exit(EXIT_FAILURE);
+    }
+    if (args.peaks && !(raster.header.flags & RASTER_PEAKS)) {
+        fprintf(stderr, "%s does not keep the peaks of its spikes, exiting ...\n", args.filename);
+        exit(EXIT_FAILURE);
+    }
+    int first = args.windowed ? findRasterStep(&raster, args.start) : 0;
+    int last = args.windowed ? findRasterStep(&raster, args.end) : raster.header.lastStep;
+    if (args.windowed && (last > raster.header.lastStep || raster.x[last] > args.end)) {
+        --last;
+    }
+
+    // Open output file for writing.
+    FILE *outfile = stdout;
+    if (strcmp(args.outFile, "-") != 0 && (outfile = fopen(args.outFile, "w")) == NULL) {
+        perror("Write Raster");
+        exit(EXIT_FAILURE);
+    }
+
+    // Write the x position and number (and peak) of each spike, a block per neuron.
+    Points spikes = {
+        .x = NULL,
+        .y = NULL,
+        .size = 0,
+        .capacity = 0
+    };
+    int count = args.record.neurons != NULL ? args.record.neuronCount : raster.header.neuronCount;
+    long spikeCount = 0;
+    for (int i = 0; i < count; ++i) {
+        int neuron = args.record.neurons != NULL ? args.record.neurons[i] : i;
+        if (neuron < 0 || neuron >= raster.header.neuronCount) {
+            continue;
+        }
+        spikes.size = 0;
+        if (!readRasterSpikes(&raster, neuron, first, last, &spikes)) {
+            fprintf(stderr, "%s could not be read at neuron %d, exiting ...\n", args.filename, neuron);
+            exit(EXIT_FAILURE);
+        }
+        for (int spike = 0; spike < spikes.size; ++spike) {
+            if (args.peaks) {
+                fprintf(outfile, "%f\t%d\t%f\n", spikes.x[spike], neuron, spikes.y[spike]);
+            }
+            else {
+                fprintf(outfile, "%f\t%d\n", spikes.x[spike], neuron);
+            }
+        }
+        spikeCount += spikes.size;
+    }
+
+    // Close ouput file.
+    if (outfile != stdout) {
+        fclose(outfile);
+        struct stat info;
+        stat(args.filename, &info);
+        printf("Exported %ld of %lld spikes of %d neurons (%lld bytes) to %s\n", spikeCount, (long long) raster.header.spikeCount,
+               raster.header.neuronCount, (long long) info.st_size, args.outFile);
+    }
+
+    freePoints(&spikes);
+    free(args.record.neurons);
+    closeRaster(&raster);
+    exit(EXIT_SUCCESS);
+}
+
+myArgs getArgs(int argc, char *argv[]) {
+    myArgs args = {
+        .filename = DEFAULT_RASTER,
+        .outFile = DEFAULT_OUT_FILE,
+        .record = {
+            .neurons = NULL,
+            .neuronCount = 0
+        },
+        .windowed = 0,
+        .peaks = 0
+    };
+
+    // Get the options.
+    int opt;
+    while ((opt = getopt(argc, argv, "n:x:o:p")) != -1) {
+        switch (opt) {
+            case 'n':
+                if (!parseRecordNeurons(optarg, &args.record)) {
+                    perror("malloc() failure");
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'x':
+                if (sscanf(optarg, "%f:%f", &args.start, &args.end) != 2 || args.end < args.start) {
+                    usage(argv[0]);
+                }
+                args.windowed = 1;
+                break;
+            case 'o':
+                args.outFile = optarg;
+                break;
+            case 'p':
+                args.peaks = 1;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    // Get the raster file.
+    if (argc - optind > 1) {
+        usage(argv[0]);
+    }
+    if (argc - optind == 1) {
+        args.filename = argv[optind];
+    }
+
+    return args;
+}
+
+void usage(const char *prog_name) {
+    fprintf(stderr, "\nUsage: %s [options] [raster file (default %s)]\n", prog_name, DEFAULT_RASTER);
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "\t-n [neurons]\t\tthe neuron numbers and ranges to export (such as 0-49,100; default every neuron)\n");
+    fprintf(stderr, "\t-x [start:end]\t\texport only the spikes within this window of x\n");
+    fprintf(stderr, "\t-o [file]\t\tthe file to write \"x neuron\" lines to (default %s, - for stdout)\n", DEFAULT_OUT_FILE);
+    fprintf(stderr, "\t-p\t\t\twrite the peak of each spike as a third column (if the raster kept them)\n\n");
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file raster_export.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that exports the spikes of a raster file as text for gnuplot.
+ * @version 0.1
+ * @date 2022-10-21
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef RASTER_EXPORT
+#define RASTER_EXPORT
+
+#include "raster.h"
+#include "numerical_methods.h"
+
+/**
+ * @brief A structure to capture all necessary command-line arguments.
+ */
+typedef struct {
+    /**
+     * @brief The raster file to export.
+     */
+    char *filename;
+
+    /**
+     * @brief The file to write the text to ("-" for stdout).
+     */
+    char *outFile;
+
+    /**
+     * @brief The neurons to export (neurons is NULL to export every neuron).
+     */
+    RecordSpec record;
+
+    /**
+     * @brief The window of x to export (windowed is 0 to export every spike).
+     */
+    float start, end;
+    int windowed;
+
+    /**
+     * @brief Whether to write the peak of each spike as a third column.
+     */
+    int peaks;
+} myArgs;
+
+/**
+ * @brief Exports a raster file.
+ *
+ * @param argc the command-line argument count.
+ * @param argv the command-line argument values.
+ * @return int - 0 if the raster was exported, otherwise 1.
+ */
+int main(int argc, char *argv[]);
+
+/**
+ * @brief Get the command-line arguments.
+ *
+ * @param argc the number of arguments.
+ * @param argv the array of arguments.
+ * @return myArgs - the command line arguments in their correct data types.
+ */
+myArgs getArgs(int, char *[]);
+
+/**
+ * @brief Prints a message to stderr explaining how to run the program.
+ *
+ * @param prog_name the name of the executable file.
+ */
+void usage(const char *);
+
+#endif
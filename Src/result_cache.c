@@ -0,0 +1,306 @@
+/**
+ * @file result_cache.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the result cache header file.
+ * @version 0.1
+ * @date 2022-10-20
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "result_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define FNV_PRIME 1099511628211ULL  // The FNV-1a multiplier.
+#define COPY_BYTES 65536            // The size of the buffer files are copied through.
+
+/**
+ * @brief An entry structure which describes a published entry while choosing which to evict.
+ */
+typedef struct {
+    /**
+     * @brief The name of the entry (its key in hex).
+     */
+    char name[CACHE_KEY_CHARS + 1];
+
+    /**
+     * @brief When the entry was last used.
+     */
+    struct timespec used;
+
+    /**
+     * @brief The number of bytes its files take.
+     */
+    long long bytes;
+} CacheEntry;
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Joins a directory and a name into a path.
+ *
+ * @param path where to store the path (PATH_MAX characters).
+ * @param directory the directory.
+ * @param name the name within the directory.
+ * @return int - 1 if the path fit, otherwise 0.
+ */
+static int joinPath(char path[], const char *directory, const char *name) {
+    return snprintf(path, PATH_MAX, "%s/%s", directory, name) < PATH_MAX;
+}
+
+/**
+ * @brief Copies a file.
+ *
+ * @param from the name of the file to be copied.
+ * @param to the name of the copy.
+ * @return int - 1 if the file was copied, otherwise 0.
+ */
+static int copyFile(const char *from, const char *to) {
+    FILE *infile, *outfile;
+    if ((infile = fopen(from, "rb")) == NULL) {
+        return 0;
+    }
+    if ((outfile = fopen(to, "wb")) == NULL) {
+        fclose(infile);
+        return 0;
+    }
+
+    char buffer[COPY_BYTES];
+    size_t count;
+    int copied = 1;
+    while (copied && (count = fread(buffer, 1, COPY_BYTES, infile)) > 0) {
+        copied = fwrite(buffer, 1, count, outfile) == count;
+    }
+    copied &= !ferror(infile);
+
+    fclose(infile);
+    return fclose(outfile) == 0 && copied;
+}
+
+/**
+ * @brief Checks whether a name is a published entry (its key in hex) rather than a private one.
+ *
+ * @param name the name.
+ * @return int - 1 if the name is a key, otherwise 0.
+ */
+static int isKeyName(const char *name) {
+    int length = 0;
+    while (length < CACHE_KEY_CHARS && ((name[length] >= '0' && name[length] <= '9') || (name[length] >= 'a' && name[length] <= 'f'))) {
+        ++length;
+    }
+    return length == CACHE_KEY_CHARS && name[length] == '\0';
+}
+
+int fetchCacheEntry(const char *cache, uint64_t key, const char *directory, CachedRun *run) {
+    char path[PATH_MAX], filename[PATH_MAX];
+    if (snprintf(path, PATH_MAX, "%s/%016llx", cache, (unsigned long long) key) >= PATH_MAX) {
+        return 0;
+    }
+
+    // Read and check the description of the run.
+    FILE *infile;
+    if (!joinPath(filename, path, CACHE_RUN_FILE) || (infile = fopen(filename, "rb")) == NULL) {
+        return 0;
+    }
+    char magic[4];
+    int read = fread(magic, 1, 4, infile) == 4 && memcmp(magic, CACHE_MAGIC, 4) == 0 && fread(run, sizeof(CachedRun), 1, infile) == 1 &&
+               run->key == key;
+    fclose(infile);
+
+    // Copy the files, then mark the entry as used (a failed copy is left for the caller to overwrite).
+    if (!read || !copyCacheEntry(path, directory)) {
+        return 0;
+    }
+    utimes(path, NULL);
+    return 1;
+}
+
+int openCacheEntry(const char *cache, uint64_t key, char path[], size_t size) {
+    if (mkdir(cache, 0755) != 0 && errno != EEXIST) {
+        return 0;
+    }
+    if ((size_t) snprintf(path, size, "%s/%016llx.XXXXXX", cache, (unsigned long long) key) >= size) {
+        return 0;
+    }
+    return mkdtemp(path) != NULL && chmod(path, 0755) == 0;
+}
+
+int copyCacheEntry(const char *path, const char *directory) {
+    DIR *entry;
+    if ((entry = opendir(path)) == NULL) {
+        return 0;
+    }
+
+    // Copy every file but the description of the run.
+    struct dirent *file;
+    int copied = 1;
+    while (copied && (file = readdir(entry)) != NULL) {
+        if (file->d_name[0] == '.' || strcmp(file->d_name, CACHE_RUN_FILE) == 0) {
+            continue;
+        }
+        char from[PATH_MAX], to[PATH_MAX];
+        copied = joinPath(from, path, file->d_name) && joinPath(to, directory, file->d_name) && copyFile(from, to);
+    }
+
+    closedir(entry);
+    return copied;
+}
+
+/**
+ * @brief Finds the size of an entry.
+ *
+ * @param path the path of the entry.
+ * @return long long - the number of bytes its files take (-1 if a file could not be measured).
+ */
+static long long getEntryBytes(const char *path) {
+    DIR *entry;
+    if ((entry = opendir(path)) == NULL) {
+        return -1;
+    }
+
+    struct dirent *file;
+    long long bytes = 0;
+    while (bytes >= 0 && (file = readdir(entry)) != NULL) {
+        char filename[PATH_MAX];
+        struct stat info;
+        if (file->d_name[0] == '.') {
+            continue;
+        }
+        bytes = joinPath(filename, path, file->d_name) && stat(filename, &info) == 0 ? bytes + info.st_size : -1;
+    }
+
+    closedir(entry);
+    return bytes;
+}
+
+/**
+ * @brief Compares two entries for qsort(), placing the least recently used first.
+ *
+ * @param a the first entry.
+ * @param b the second entry.
+ * @return int - negative, zero, or positive as a was used before, with, or after b.
+ */
+static int compareUse(const void *a, const void *b) {
+    const struct timespec *usedA = &((const CacheEntry *) a)->used, *usedB = &((const CacheEntry *) b)->used;
+    if (usedA->tv_sec != usedB->tv_sec) {
+        return (usedA->tv_sec > usedB->tv_sec) - (usedA->tv_sec < usedB->tv_sec);
+    }
+    return (usedA->tv_nsec > usedB->tv_nsec) - (usedA->tv_nsec < usedB->tv_nsec);
+}
+
+/**
+ * @brief Evicts the least recently used entries until the cache fits.
+ *
+ * @param cache the cache directory.
+ * @param maxBytes the most bytes the files of the cache may take.
+ */
+static void evictEntries(const char *cache, long long maxBytes) {
+    DIR *directory;
+    if ((directory = opendir(cache)) == NULL) {
+        return;
+    }
+
+    // Find the size and last use of each published entry (an entry that cannot be measured or stored leaves the cache as
+    // it is).
+    CacheEntry *entries = NULL;
+    int count = 0, capacity = 0, measured = 1;
+    long long total = 0;
+    struct dirent *file;
+    while (measured && (file = readdir(directory)) != NULL) {
+        char path[PATH_MAX];
+        struct stat info;
+        if (!isKeyName(file->d_name)) {
+            continue;
+        }
+        if (!joinPath(path, cache, file->d_name)) {
+            measured = 0;
+            continue;
+        }
+        if (stat(path, &info) != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            CacheEntry *grown;
+            if ((grown = (CacheEntry *) realloc(entries, (capacity ? 2 * capacity : 16) * sizeof(CacheEntry))) == NULL) {
+                measured = 0;
+                continue;
+            }
+            entries = grown;
+            capacity = capacity ? 2 * capacity : 16;
+        }
+        CacheEntry *entry = &entries[count++];
+        memcpy(entry->name, file->d_name, sizeof(entry->name));
+        entry->used = info.st_mtim;
+        measured = (entry->bytes = getEntryBytes(path)) >= 0;
+        total += entry->bytes;
+    }
+    closedir(directory);
+
+    // Remove the least recently used until the rest fit.
+    if (measured && count > 1) {
+        qsort(entries, count, sizeof(CacheEntry), compareUse);
+    }
+    for (int i = 0; measured && i < count && total > maxBytes; ++i) {
+        char path[PATH_MAX];
+        if (joinPath(path, cache, entries[i].name) && removeCacheEntry(path)) {
+            total -= entries[i].bytes;
+        }
+    }
+
+    free(entries);
+}
+
+int commitCacheEntry(const char *cache, const char *path, const CachedRun *run, long long maxBytes) {
+    // Write the description of the run.
+    char filename[PATH_MAX];
+    FILE *outfile;
+    if (!joinPath(filename, path, CACHE_RUN_FILE) || (outfile = fopen(filename, "wb")) == NULL) {
+        removeCacheEntry(path);
+        return 0;
+    }
+    int written = fwrite(CACHE_MAGIC, 1, 4, outfile) == 4 && fwrite(run, sizeof(CachedRun), 1, outfile) == 1;
+    written &= fclose(outfile) == 0;
+
+    // Publish the entry under its key (renaming is atomic, so readers never see a partial entry).
+    char published[PATH_MAX];
+    if (!written || snprintf(published, PATH_MAX, "%s/%016llx", cache, (unsigned long long) run->key) >= PATH_MAX || rename(path, published) != 0) {
+        removeCacheEntry(path);
+        return 0;
+    }
+
+    evictEntries(cache, maxBytes);
+    return 1;
+}
+
+int removeCacheEntry(const char *path) {
+    DIR *entry;
+    if ((entry = opendir(path)) == NULL) {
+        return 0;
+    }
+
+    // Remove each file, then the entry itself (which fails if any file was left).
+    struct dirent *file;
+    while ((file = readdir(entry)) != NULL) {
+        char filename[PATH_MAX];
+        if (file->d_name[0] != '.' && joinPath(filename, path, file->d_name)) {
+            unlink(filename);
+        }
+    }
+    closedir(entry);
+    return rmdir(path) == 0;
+}
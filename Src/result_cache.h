@@ -0,0 +1,111 @@
+/**
+ * @file result_cache.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that keeps the output files of finished runs in a directory, keyed by a hash of
+ * everything the run depends on, so a repeated run can copy them instead of running again.
+ * @version 0.1
+ * @date 2022-10-20
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef RESULT_CACHE
+#define RESULT_CACHE
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CACHE_MAGIC "NSC1"                      // The first bytes of the run file of an entry.
+#define CACHE_RUN_FILE "run"                    // The file of each entry describing its run.
+#define CACHE_HASH_START 14695981039346656037ULL   // The FNV-1a offset basis every key starts from.
+#define CACHE_KEY_CHARS 16                      // The number of hex digits naming an entry.
+
+/**
+ * @brief A cached run structure which describes the run whose files an entry holds.
+ */
+typedef struct {
+    /**
+     * @brief The key of the run.
+     */
+    uint64_t key;
+
+    /**
+     * @brief The number of neurons and of steps taken.
+     */
+    int32_t neuronCount, steps;
+
+    /**
+     * @brief The number of times the ODEs were evaluated for a neuron.
+     */
+    int64_t evalCount;
+
+    /**
+     * @brief Why the run stopped.
+     */
+    int32_t stopReason;
+} CachedRun;
+
+/**
+ * @brief Adds bytes to a 64-bit FNV-1a hash.
+ *
+ * @param hash the hash so far (CACHE_HASH_START for none).
+ * @param data the bytes.
+ * @param size the number of bytes.
+ * @return uint64_t - the hash including the bytes.
+ */
+uint64_t hashBytes(uint64_t hash, const void *data, size_t size);
+
+/**
+ * @brief Copies the output files of a cached run into a directory and marks the entry as the most recently used.
+ *
+ * @param cache the cache directory.
+ * @param key the key of the run.
+ * @param directory the directory to copy the files into.
+ * @param run where to store the description of the run.
+ * @return int - 1 if the run was found and copied, otherwise 0 (including when the entry was evicted while copying).
+ */
+int fetchCacheEntry(const char *cache, uint64_t key, const char *directory, CachedRun *run);
+
+/**
+ * @brief Creates a private entry in the cache (creating the cache if needed) for the output files of a run to be
+ * written into before it is committed.
+ *
+ * @param cache the cache directory.
+ * @param key the key of the run.
+ * @param path where to store the path of the entry.
+ * @param size the number of characters path can hold.
+ * @return int - 1 if the entry was created, otherwise 0.
+ */
+int openCacheEntry(const char *cache, uint64_t key, char path[], size_t size);
+
+/**
+ * @brief Copies the output files of an entry into a directory.
+ *
+ * @param path the path of the entry.
+ * @param directory the directory to copy the files into.
+ * @return int - 1 if every file was copied, otherwise 0.
+ */
+int copyCacheEntry(const char *path, const char *directory);
+
+/**
+ * @brief Describes the run of a private entry and publishes it under its key, then evicts the least recently used
+ * entries until the cache fits in maxBytes (which may evict the new entry if it alone is larger). If another run
+ * published the same key first, the private entry is removed instead.
+ *
+ * @param cache the cache directory.
+ * @param path the path of the private entry.
+ * @param run the description of the run.
+ * @param maxBytes the most bytes the files of the cache may take.
+ * @return int - 1 if the entry was published, otherwise 0 (and it is removed).
+ */
+int commitCacheEntry(const char *cache, const char *path, const CachedRun *run, long long maxBytes);
+
+/**
+ * @brief Removes an entry and its files.
+ *
+ * @param path the path of the entry.
+ * @return int - 1 if the entry was removed, otherwise 0.
+ */
+int removeCacheEntry(const char *path);
+
+#endif
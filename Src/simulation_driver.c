@@ -11,119 +11,638 @@
 #include "simulation_driver.h"
 #include "spike_calculations.h"
 #include "differential_equations.h"
-#include "numerical_methods.h"
-#include "graph_manipulations.h"
+#include "neurosync.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/time.h>
 #include <string.h>
+#include <unistd.h>
 
-#define FUNC_COUNT 3            // MAKE SURE TO CHANGE THIS BEFORE SWAPPING THE getODEs() FUNCTION.
 #define SPIKE_THRESHOLD 0.0
+#define DEFAULT_WINDOW 200.0    // The default convergence window (in x).
+#define DEFAULT_HOLD 200.0      // The default convergence hold duration (in x).
+#define DEFAULT_RATIO 4         // The default number of micro-steps per multirate macro-step.
+#define DEFAULT_ACTIVITY -1.0   // The default voltage a neuron must reach to take multirate micro-steps.
+#define DEFAULT_REVERSAL 2.0    // The default reversal potential of the chemical synapses.
+#define DEFAULT_DECAY 10.0      // The default decay time constant of the chemical synapses.
+#define DEFAULT_DELAY 1.0       // The default delay of the chemical synapses.
+#define DEFAULT_POTENTIATION 0.01  // The default weight added per unit of presynaptic trace by STDP.
+#define DEFAULT_DEPRESSION 0.012    // The default weight removed per unit of postsynaptic trace by STDP.
+#define DEFAULT_TAU 20.0        // The default time constant of the STDP traces.
+#define DEFAULT_MAX_WEIGHT 1.0  // The default largest weight STDP may reach.
+#define DEFAULT_FUNCS 0x1       // The default functions to store (x only).
+#define DEFAULT_MONITOR_INTERVAL 100    // The default number of steps between published progress samples.
+#define DEFAULT_MONITOR_CAPACITY 1024   // The number of progress samples kept for a viewer.
+#define DEFAULT_STRENGTH 0.2    // The default coupling strength between lattice neighbours.
+#define DEFAULT_CACHE_MB 1024   // The default most megabytes the result cache may take.
 
 int main(int argc, char *argv[]) {
     double start, elapsed;
     myArgs args;
-    EqSolution sol;
-    Points *spikes;
-    ISI *isis;
-    float *avgFreqs;
+    NsSimulation *sim;
+    NsStatus status;
 
     // Read command line parameters.
     args = getArgs(argc, argv);
+    if (args.convergence.checks) {
+        args.params.convergence = &args.convergence;
+    }
+    if (args.chemical) {
+        args.params.synapses = &args.synapses;
+    }
+    if (args.noise.strength > 0.0 || args.noise.spread > 0.0) {
+        args.params.noise = &args.noise;
+    }
+    if (args.plastic) {
+        args.params.plasticity = &args.plasticity;
+    }
+    if (args.monitored) {
+        args.params.monitor = &args.monitor;
+    }
+    args.params.record = &args.record;
+    if (args.latticed) {
+        args.params.stencil = &args.stencil;
+    }
 
-    // Allocate dynamic memory for spikes.
-    if ((spikes = (Points *) malloc(args.graph.vertexCount * sizeof(Points))) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+    // Run with a saved configuration, or tune one and save it.
+    if (args.tunedFile != NULL) {
+        int tunedCount;
+        if (!readTuning(args.tunedFile, &args.params, &tunedCount)) {
+            fprintf(stderr, "Could not read the configuration %s, exiting ...\n", args.tunedFile);
+            exit(EXIT_FAILURE);
+        }
+        if (tunedCount != args.neuronCount) {
+            fprintf(stderr, "Warning: %s was tuned for %d neurons, not %d\n", args.tunedFile, tunedCount, args.neuronCount);
+        }
     }
+    if (args.tuneFile != NULL) {
+        TuneCriteria criteria;
+        Tuning tuning;
+        defaultTuneCriteria(&criteria);
+        start = getTime();
+        if ((status = tuneSimulation(args.weights, args.neuronCount, &args.params, &criteria, &tuning)) != NS_OK) {
+            fprintf(stderr, "Autotuning failed (%s), exiting ...\n", nsStatusName(status));
+            exit(EXIT_FAILURE);
+        }
+        elapsed = getTime() - start;
 
-    // Allocate dynamic memory for ISIs.
-    if ((isis = (ISI *) malloc(args.graph.vertexCount * sizeof(ISI))) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+        printf("Autotuning against rk4 with a step of %g:\n", tuning.referenceStep);
+        for (int i = 0; i < tuning.trialCount; ++i) {
+            const TuneTrial *trial = &tuning.trials[i];
+            printf("\t%-10s step %-8g %2d threads %10f seconds  %s\n", methodName(trial->method), trial->step, trial->threads, trial->seconds,
+                   trial->accurate ? "accurate" : "inaccurate");
+        }
+        printf("\tchose %s with a step of %g on %d threads (%f seconds tuning)\n", methodName(tuning.method), tuning.step, tuning.threads, elapsed);
+        if (!writeTuning(args.tuneFile, &tuning, args.neuronCount)) {
+            perror("Could not write the configuration");
+            exit(EXIT_FAILURE);
+        }
+        args.params.method = tuning.method;
+        args.params.step = tuning.step;
+        args.params.threads = tuning.threads;
+        freeTuning(&tuning);
     }
 
-    // Allocate dynamic memory for average frequencies.
-    if ((avgFreqs = (float *) malloc(args.graph.vertexCount * sizeof(float))) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+    // Store the whole run unless a window was given.
+    if (!args.windowed) {
+        args.record.start = args.params.x0;
+        args.record.end = args.params.xEnd;
+    }
+
+    // Select evenly spaced neurons to store if requested.
+    if (args.sampleCount > 0) {
+        free(args.record.neurons);
+        args.record.neuronCount = args.sampleCount < args.neuronCount ? args.sampleCount : args.neuronCount;
+        if ((args.record.neurons = (int *) malloc(args.record.neuronCount * sizeof(int))) == NULL) {
+            perror("malloc() failure");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < args.record.neuronCount; ++i) {
+            args.record.neurons[i] = (long) i * args.neuronCount / args.record.neuronCount;
+        }
+    }
+
+    // Integrate a window of an earlier run again from its keyframes.
+    if (args.replaying) {
+        NsReplayStats stats;
+        start = getTime();
+        if ((status = nsReplay(args.weights, args.neuronCount, &args.params, "Out/keyframes", args.replayStart, args.replayEnd, "Out", &stats)) != NS_OK) {
+            fprintf(stderr, "Replay failed (%s), exiting ...\n", nsStatusName(status));
+            exit(EXIT_FAILURE);
+        }
+        elapsed = getTime() - start;
+
+        printf("Hindmarsh-Rose (HR) neuronal model:\n");
+        printf("\t%d neurons replayed from x = %f to %f\n", args.neuronCount, args.replayStart, args.replayEnd);
+        printf("\t%d steps from the keyframe at x = %f\n", stats.steps, stats.keyframeX);
+        printf("\t%f seconds elapsed\n", elapsed);
+
+        freeArgs(&args);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Run the connected components on the threads.
+    if (args.components) {
+        NsComponentStats stats;
+        int threads = args.params.threads;
+        args.params.threads = 1;
+        start = getTime();
+        if ((status = nsRunComponents(args.weights, args.neuronCount, &args.params, threads, "Out", args.outputs, &stats)) != NS_OK) {
+            fprintf(stderr, "Simulation failed (%s), exiting ...\n", nsStatusName(status));
+            exit(EXIT_FAILURE);
+        }
+        elapsed = getTime() - start;
+
+        printf("Hindmarsh-Rose (HR) neuronal model:\n");
+        printf("\t%d neurons and %d steps\n", args.neuronCount, stats.steps);
+        printf("\t%f seconds elapsed\n", elapsed);
+        printf("\t%ld ODE evaluations\n", stats.evalCount);
+        printf("\t%d components (%d simulated, largest %d neurons)\n", stats.components, stats.simulated, stats.largest);
+
+        freeArgs(&args);
+        exit(EXIT_SUCCESS);
+    }
+
+    // Run through the result cache, copying the results of an identical earlier run if there was one.
+    if (args.cacheDir != NULL) {
+        NsCacheStats stats;
+        start = getTime();
+        if ((status = nsRunCached(args.weights, args.neuronCount, &args.params, args.cacheDir, args.cacheBytes, "Out", args.outputs, &stats)) != NS_OK) {
+            fprintf(stderr, "Simulation failed (%s), exiting ...\n", nsStatusName(status));
+            exit(EXIT_FAILURE);
+        }
+        elapsed = getTime() - start;
+
+        printf("Hindmarsh-Rose (HR) neuronal model:\n");
+        printf("\t%d neurons and %d steps\n", args.neuronCount, stats.steps);
+        printf("\t%f seconds elapsed\n", elapsed);
+        printf("\t%ld ODE evaluations\n", stats.evalCount);
+        printf("\tresults %s %s (key %016llx)\n", stats.hit ? "copied from" : "stored in", args.cacheDir, (unsigned long long) stats.key);
+        if (args.params.convergence != NULL) {
+            printf("\tstopped after %d steps (%s)\n", stats.steps, stopReasonName(stats.stopReason));
+        }
+
+        freeArgs(&args);
+        exit(EXIT_SUCCESS);
     }
 
     // Run calculations.
     start = getTime();
-    sol = runRungeKutta(&getHR, &args.cond, &args.graph, FUNC_COUNT);
-    for (int neuron = 0; neuron < sol.neuronCount; ++neuron) {
-        spikes[neuron] = findSpikes(sol.x, sol.approx[neuron][0], sol.stepCount + 1, args.cond.transient, SPIKE_THRESHOLD);
-        isis[neuron] = calcISI(&spikes[neuron]);
-        avgFreqs[neuron] = calcAvgFrequency(spikes[neuron].size, args.cond.transient, args.cond.xEnd, 1000.0);
+    if ((status = nsCreate(args.weights, args.neuronCount, &args.params, &sim)) != NS_OK || (status = nsRun(sim)) != NS_OK) {
+        fprintf(stderr, "Simulation failed (%s), exiting ...\n", nsStatusName(status));
+        exit(EXIT_FAILURE);
     }
+    const EqSolution *sol = nsSolution(sim);
     elapsed = getTime() - start;
 
     // Print results.
     printf("Hindmarsh-Rose (HR) neuronal model:\n");
-    printf("\t%d neurons and %d steps\n", sol.neuronCount, sol.stepCount);
+    printf("\t%d neurons and %d steps\n", sol->neuronCount, sol->stepCount);
     printf("\t%f seconds elapsed\n", elapsed);
+    printf("\t%ld ODE evaluations\n", sol->evalCount);
+    const Plasticity *plasticity = nsPlasticity(sim);
+    if (plasticity != NULL) {
+        printf("\t%ld weight updates over %d edges (%d snapshots)\n", plasticity->updateCount, plasticity->edgeCount, plasticity->snapshotCount);
+    }
+    const Partition *partition = nsPartition(sim);
+    if (partition != NULL) {
+        printf("\t%d partitions with %ld of %ld edges between them\n", partition->count, partition->crossEdges, partition->edges);
+    }
+    if (sol->compressed != NULL) {
+        size_t bytes = 0, raw = 0;
+        for (int rec = 0; rec < sol->recordCount; ++rec) {
+            for (int func = 0; func < sol->funcCount; ++func) {
+                if (sol->compressed[rec][func].quantum > 0.0) {
+                    bytes += trajectoryBytes(&sol->compressed[rec][func]);
+                    raw += sol->sampleCount * sizeof(float);
+                }
+            }
+        }
+        printf("\tstored samples take %zu bytes (%.1f times fewer than floats)\n", bytes, bytes ? (double) raw / bytes : 0.0);
+    }
+    if (args.params.convergence != NULL) {
+        printf("\tstopped at x = %f (%s)\n", sol->x[sol->stepCount], stopReasonName(sol->stopReason));
+    }
 
     // Write calculations.
-    char filename[20];
-    for (int neuron = 0; neuron < sol.neuronCount; ++neuron) {
-        // Write the neuron approximation.
-        sprintf(filename, "Out/approx%d", neuron);
-        writeSolution(filename, sol.x, sol.approx[neuron][0], sol.stepCount + 1, args.cond.transient);
-
-        // Write the neuron spikes.
-        sprintf(filename, "Out/spikes%d", neuron);
-        writePoints(filename, &spikes[neuron]);
-
-        // Write the neuron inter-spike interval.
-        sprintf(filename, "Out/ISI%d", neuron);
-        writeISI(filename, &isis[neuron]);
+    if ((status = nsWriteResults(sim, "Out", args.outputs)) != NS_OK) {
+        fprintf(stderr, "Could not write the results (%s), exiting ...\n", nsStatusName(status));
+        exit(EXIT_FAILURE);
     }
 
-    // Write the average frequency of each neuron.
-    writeAvgFrequencies("Out/avg_freqs", avgFreqs, sol.neuronCount);
-
-    // Write the s values of each neuron.
-    writeSs("Out/s_values", sol.neuronCount);
-    
     // Free heap memory and exit.
+    nsDestroy(sim);
     freeArgs(&args);
-    freeEqSolution(&sol);
-    for (int neuron = 0; neuron < sol.neuronCount; ++neuron) {
-        freePoints(&spikes[neuron]);
-        freeISI(&isis[neuron]);
-    }
-    free(spikes);
-    free(isis);
-    free(avgFreqs);
     exit(EXIT_SUCCESS);
 }
 
 myArgs getArgs(int argc, char *argv[]) {
     myArgs args;
+    args.convergence = (ConvergenceCriteria) {
+        .checks = 0,
+        .window = DEFAULT_WINDOW,
+        .hold = DEFAULT_HOLD,
+        .spikeThreshold = SPIKE_THRESHOLD
+    };
+    nsDefaultParams(&args.params);
+    args.params.ratio = DEFAULT_RATIO;
+    args.params.activityThreshold = DEFAULT_ACTIVITY;
+    args.chemical = 0;
+    args.synapses = (SynapseParams) {
+        .reversal = DEFAULT_REVERSAL,
+        .decay = DEFAULT_DECAY,
+        .delay = DEFAULT_DELAY,
+        .threshold = SPIKE_THRESHOLD
+    };
+    args.noise = (NoiseParams) {
+        .seed = 0,
+        .strength = 0.0,
+        .spread = 0.0
+    };
+    args.plastic = 0;
+    args.plasticity = (PlasticityParams) {
+        .potentiation = DEFAULT_POTENTIATION,
+        .depression = DEFAULT_DEPRESSION,
+        .tauPlus = DEFAULT_TAU,
+        .tauMinus = DEFAULT_TAU,
+        .maxWeight = DEFAULT_MAX_WEIGHT,
+        .threshold = SPIKE_THRESHOLD,
+        .snapshotInterval = 0.0
+    };
+    args.record = (RecordSpec) {
+        .funcMask = -1,
+        .neurons = NULL,
+        .neuronCount = 0,
+        .stride = 1,
+        .spikes = 1,
+        .spikeThreshold = SPIKE_THRESHOLD,
+        .quantum = 0.0,
+        .keyframeInterval = 0
+    };
+    args.monitored = 0;
+    args.monitor = (MonitorParams) {
+        .name = NULL,
+        .interval = DEFAULT_MONITOR_INTERVAL,
+        .capacity = DEFAULT_MONITOR_CAPACITY
+    };
+    args.components = 0;
+    args.tuneFile = NULL;
+    args.tunedFile = NULL;
+    args.sampleCount = 0;
+    args.windowed = 0;
+    args.replaying = 0;
+    args.latticed = 0;
+    args.cacheDir = NULL;
+    args.cacheBytes = (long long) DEFAULT_CACHE_MB << 20;
+    args.outputs = NS_WRITE_ALL;
+    args.stencil = (StencilParams) {
+        .axes = 0,
+        .neighbours = 0,
+        .periodic = 0,
+        .strength = {DEFAULT_STRENGTH, DEFAULT_STRENGTH, DEFAULT_STRENGTH},
+        .diagonal = -1.0
+    };
+
+    // Get the options.
+    int opt;
+    while ((opt = getopt(argc, argv, "y:p:w:d:i:r:a:j:CA:P:c:e:t:l:g:u:s:L:W:M:f:n:N:x:k:q:K:R:S:T:Z:O")) != -1) {
+        switch (opt) {
+            case 'y':
+                args.convergence.checks |= CHECK_SYNCHRONY;
+                args.convergence.syncTolerance = strtod(optarg, NULL);
+                break;
+            case 'p':
+                args.convergence.checks |= CHECK_PERIODIC;
+                args.convergence.isiTolerance = strtod(optarg, NULL);
+                break;
+            case 'w':
+                args.convergence.window = strtod(optarg, NULL);
+                break;
+            case 'd':
+                args.convergence.hold = strtod(optarg, NULL);
+                break;
+            case 'i':
+                if (strcmp(optarg, "rk4") == 0) {
+                    args.params.method = METHOD_RK4;
+                }
+                else if (strcmp(optarg, "multirate") == 0) {
+                    args.params.method = METHOD_MULTIRATE;
+                }
+                else if (strcmp(optarg, "etd") == 0) {
+                    args.params.method = METHOD_ETD;
+                }
+                else {
+                    usage(argv[0]);
+                }
+                break;
+            case 'r':
+                if ((args.params.ratio = strtol(optarg, NULL, 10)) < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'a':
+                args.params.activityThreshold = strtod(optarg, NULL);
+                break;
+            case 'j':
+                if ((args.params.threads = strtol(optarg, NULL, 10)) < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'C':
+                args.components = 1;
+                break;
+            case 'A':
+                args.tuneFile = optarg;
+                break;
+            case 'P':
+                args.tunedFile = optarg;
+                break;
+            case 'c':
+                if (strcmp(optarg, "electrical") == 0) {
+                    args.chemical = 0;
+                }
+                else if (strcmp(optarg, "chemical") == 0) {
+                    args.chemical = 1;
+                }
+                else {
+                    usage(argv[0]);
+                }
+                break;
+            case 'e':
+                args.synapses.reversal = strtod(optarg, NULL);
+                break;
+            case 't':
+                if ((args.synapses.decay = strtod(optarg, NULL)) <= 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'l':
+                args.synapses.delay = strtod(optarg, NULL);
+                break;
+            case 'g':
+                if ((args.noise.strength = strtod(optarg, NULL)) < 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'u':
+                if ((args.noise.spread = strtod(optarg, NULL)) < 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 's':
+                args.noise.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'L':
+                // Override the leading STDP parameters from a list such as "0.01:0.012" (or "default" for none).
+                if (strcmp(optarg, "default") != 0 && sscanf(optarg, "%f:%f:%f:%f:%f", &args.plasticity.potentiation, &args.plasticity.depression,
+                           &args.plasticity.tauPlus, &args.plasticity.tauMinus, &args.plasticity.maxWeight) < 1) {
+                    usage(argv[0]);
+                }
+                args.plastic = 1;
+                break;
+            case 'W':
+                if ((args.plasticity.snapshotInterval = strtod(optarg, NULL)) <= 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'M':
+                // Split an interval off the name, such as "run1:500".
+                if (strchr(optarg, ':') != NULL) {
+                    *strchr(optarg, ':') = '\0';
+                    if ((args.monitor.interval = strtol(optarg + strlen(optarg) + 1, NULL, 10)) < 1) {
+                        usage(argv[0]);
+                    }
+                }
+                if (optarg[0] == '\0') {
+                    usage(argv[0]);
+                }
+                args.monitor.name = optarg;
+                args.monitored = 1;
+                break;
+            case 'f':
+                // Build the function mask from a list such as "0,2".
+                args.record.funcMask = 0;
+                for (char *func = strtok(optarg, ","); func != NULL; func = strtok(NULL, ",")) {
+                    int num = strtol(func, NULL, 10);
+                    if (num < 0 || num >= NS_FUNC_COUNT) {
+                        usage(argv[0]);
+                    }
+                    args.record.funcMask |= 1 << num;
+                }
+                break;
+            case 'n':
+                if (!parseRecordNeurons(optarg, &args.record)) {
+                    perror("malloc() failure");
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'N':
+                if ((args.sampleCount = strtol(optarg, NULL, 10)) < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'x':
+                if (sscanf(optarg, "%f:%f", &args.record.start, &args.record.end) != 2) {
+                    usage(argv[0]);
+                }
+                args.windowed = 1;
+                break;
+            case 'k':
+                if ((args.record.stride = strtol(optarg, NULL, 10)) < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'q':
+                if ((args.record.quantum = strtod(optarg, NULL)) <= 0.0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'K':
+                if ((args.record.keyframeInterval = strtol(optarg, NULL, 10)) < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'R':
+                if (sscanf(optarg, "%f:%f", &args.replayStart, &args.replayEnd) != 2 || !(args.replayEnd >= args.replayStart)) {
+                    usage(argv[0]);
+                }
+                args.replaying = 1;
+                break;
+            case 'S': {
+                // The shape, such as 100x100, then optionally the number of neighbours and "periodic".
+                char *end = optarg;
+                args.stencil.axes = 0;
+                do {
+                    args.stencil.shape[args.stencil.axes++] = strtol(end + (end != optarg), &end, 10);
+                } while (*end == 'x' && args.stencil.axes < 3);
+                args.stencil.neighbours = args.stencil.axes == 3 ? 6 : 4;
+                if (*end == ':' && end[1] >= '0' && end[1] <= '9') {
+                    args.stencil.neighbours = strtol(end + 1, &end, 10);
+                }
+                if (strcmp(end, ":periodic") == 0) {
+                    args.stencil.periodic = 1;
+                }
+                else if (*end != '\0') {
+                    usage(argv[0]);
+                }
+                args.latticed = 1;
+                break;
+            }
+            case 'T': {
+                // The strength along each axis (or one for every axis), then optionally the diagonal strength.
+                char *end = optarg;
+                int count = 0;
+                do {
+                    args.stencil.strength[count++] = strtod(end + (end != optarg), &end);
+                } while (*end == ',' && count < 3);
+                for (int axis = count; axis < 3; ++axis) {
+                    args.stencil.strength[axis] = args.stencil.strength[count - 1];
+                }
+                if (*end == ':') {
+                    args.stencil.diagonal = strtod(end + 1, &end);
+                }
+                if (*end != '\0') {
+                    usage(argv[0]);
+                }
+                break;
+            }
+            case 'O':
+                args.outputs = (NS_WRITE_ALL & ~(NS_WRITE_SPIKES | NS_WRITE_ISI)) | NS_WRITE_RASTER | NS_WRITE_PEAKS;
+                break;
+            case 'Z': {
+                // The directory, then optionally the most megabytes it may take.
+                char *size = strrchr(optarg, ':'), *end;
+                if (size != NULL) {
+                    double megabytes = strtod(size + 1, &end);
+                    if (*end != '\0' || !(megabytes >= 0.0)) {
+                        usage(argv[0]);
+                    }
+                    args.cacheBytes = megabytes * (1 << 20);
+                    *size = '\0';
+                }
+                args.cacheDir = optarg;
+                break;
+            }
+            default:
+                usage(argv[0]);
+        }
+    }
 
-    // Verify the number of arguments.
-    if (argc != 6) 
+    // Verify the number of arguments and that the coupling is supported by the method.
+    if (argc - optind != (args.latticed ? 4 : 5)) 
         usage(argv[0]);
+    if (args.latticed && getStencilCellCount(&args.stencil) < 1) {
+        fprintf(stderr, "The lattice needs 2 axes with 4 or 8 neighbours or 3 axes with 6 (and 3 cells per axis to be periodic), exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if (args.latticed && (args.chemical || args.plastic || args.components)) {
+        fprintf(stderr, "A lattice cannot be run with chemical coupling, STDP, or connected components, exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if (args.chemical && args.params.method != METHOD_RK4) {
+        fprintf(stderr, "Chemical coupling requires the rk4 method, exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if (args.plastic && (args.chemical || args.params.method == METHOD_MULTIRATE || (args.params.threads > 1 && !args.components))) {
+        fprintf(stderr, "STDP requires the rk4 or etd method with electrical coupling and one thread, exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if (args.components && (args.convergence.checks || args.plastic || args.monitored)) {
+        fprintf(stderr, "Connected components cannot be run with stop criteria, STDP, or a monitor, exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if (args.params.threads > 1 && !args.components && (args.chemical || args.params.method != METHOD_RK4)) {
+        fprintf(stderr, "Threads require the rk4 method with electrical coupling, exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((args.record.keyframeInterval || args.replaying) && (args.chemical || args.plastic || args.components)) {
+        fprintf(stderr, "Keyframes cannot be taken or replayed with chemical coupling, STDP, or connected components, exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if (args.cacheDir != NULL && (args.components || args.replaying)) {
+        fprintf(stderr, "The result cache cannot be used with connected components or a replay, exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+    if (args.replaying && args.tuneFile != NULL) {
+        fprintf(stderr, "A replay must use the configuration of its run (-P, not -A), exiting ...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Keyframes usually replace the stored functions, so store none unless some were given.
+    if (args.record.funcMask < 0) {
+        args.record.funcMask = args.record.keyframeInterval ? 0 : DEFAULT_FUNCS;
+    }
+    argv += optind - 1;
 
     // Get conditions.
-    args.cond = initEqConditions(strtod(argv[1], NULL), strtod(argv[2], NULL), strtod(argv[3], NULL), strtod(argv[4], NULL), FUNC_COUNT);
+    args.params.x0 = strtod(argv[1], NULL);
+    args.params.xEnd = strtod(argv[2], NULL);
+    args.params.step = strtod(argv[3], NULL);
+    args.params.transient = strtod(argv[4], NULL);
     
+    // Get the diagonal strength of the lattice (the mean of the row and column strengths unless given).
+    if (args.latticed) {
+        int rowAxis = args.stencil.axes - 2;
+        if (args.stencil.diagonal < 0.0) {
+            args.stencil.diagonal = (args.stencil.strength[rowAxis] + args.stencil.strength[rowAxis + 1]) / 2.0;
+        }
+        args.weights = NULL;
+        args.neuronCount = getStencilCellCount(&args.stencil);
+        return args;
+    }
+
     // Get graph.
-    args.graph = readGraph(argv[5]);
+    NsStatus status;
+    if ((status = nsReadGraph(argv[5], &args.weights, &args.neuronCount)) != NS_OK) {
+        fprintf(stderr, "Could not read %s (%s), exiting ...\n", argv[5], nsStatusName(status));
+        exit(EXIT_FAILURE);
+    }
     
     return args;
 } 
 
 void freeArgs(myArgs *args) {
-    freeEqConditions(&args->cond);
-    freeGraph(&args->graph);
+    free(args->record.neurons);
+    nsFreeWeights(args->weights);
 }
 
 void usage(const char *prog_name) {
-    fprintf(stderr, "\nUsage: %s [x0] [xEnd] [step] [transient] [graph file path]\n\n", prog_name);
+    fprintf(stderr, "\nUsage: %s [options] [x0] [xEnd] [step] [transient] [graph file path (not with -S)]\n", prog_name);
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "\t-y [tolerance]\tstop once the windowed synchronization error stays below tolerance\n");
+    fprintf(stderr, "\t-p [tolerance]\tstop once the inter-spike intervals repeat within a relative tolerance\n");
+    fprintf(stderr, "\t-w [window]\tthe sliding window the stop criteria are measured over (default %g)\n", DEFAULT_WINDOW);
+    fprintf(stderr, "\t-d [duration]\thow long a stop criterion must hold before stopping (default %g)\n", DEFAULT_HOLD);
+    fprintf(stderr, "\t-i [method]\tthe numerical method: rk4 (default), multirate, or etd\n");
+    fprintf(stderr, "\t-r [ratio]\tthe number of micro-steps per multirate macro-step (default %d)\n", DEFAULT_RATIO);
+    fprintf(stderr, "\t-a [voltage]\tthe voltage a neuron must reach to take multirate micro-steps (default %g)\n", DEFAULT_ACTIVITY);
+    fprintf(stderr, "\t-j [threads]\tthe number of pinned threads taking each step (rk4 with electrical coupling only, default 1)\n");
+    fprintf(stderr, "\t-C\t\trun the connected components separately, -j of them at once (no -y, -p, -L, or -M)\n");
+    fprintf(stderr, "\t-A [file]\tpick the step, method, and threads from short probe runs, save them to file, and run with them\n");
+    fprintf(stderr, "\t-P [file]\trun with the step, method, and threads saved by -A\n");
+    fprintf(stderr, "\t-c [coupling]\tthe coupling: electrical (default) or chemical (rk4 only)\n");
+    fprintf(stderr, "\t-e [voltage]\tthe reversal potential of the chemical synapses (default %g)\n", DEFAULT_REVERSAL);
+    fprintf(stderr, "\t-t [decay]\tthe decay time constant of the chemical synapses (default %g)\n", DEFAULT_DECAY);
+    fprintf(stderr, "\t-l [delay]\tthe delay of the chemical synapses (default %g)\n", DEFAULT_DELAY);
+    fprintf(stderr, "\t-g [strength]\tthe standard deviation of the noise added to x per unit of x (default 0)\n");
+    fprintf(stderr, "\t-u [spread]\tstart each function of each neuron uniformly within spread of 0 (default 0)\n");
+    fprintf(stderr, "\t-s [seed]\tthe seed of the noise and initial values (default 0)\n");
+    fprintf(stderr, "\t-L [a+:a-:tau+:tau-:max]\tenable STDP with these leading parameters or \"default\" (%g:%g:%g:%g:%g)\n", DEFAULT_POTENTIATION, DEFAULT_DEPRESSION, DEFAULT_TAU, DEFAULT_TAU, DEFAULT_MAX_WEIGHT);
+    fprintf(stderr, "\t-W [interval]\tthe x distance between STDP weight snapshots written to Out/weights (default none)\n");
+    fprintf(stderr, "\t-M [name:interval]\tpublish the progress every interval steps (default %d) for Bin/monitor to watch\n", DEFAULT_MONITOR_INTERVAL);
+    fprintf(stderr, "\t-f [functions]\tthe functions to store, such as 0,2 (default 0)\n");
+    fprintf(stderr, "\t-n [neurons]\tthe neurons to store, such as 0-49,100 (default all)\n");
+    fprintf(stderr, "\t-N [count]\tstore this many evenly spaced neurons instead\n");
+    fprintf(stderr, "\t-x [start:end]\tthe x window to store (default x0:xEnd)\n");
+    fprintf(stderr, "\t-k [stride]\tthe number of steps between stored samples (default 1)\n");
+    fprintf(stderr, "\t-q [quantum]\tstore the samples compressed, rounded to multiples of quantum (such as 0.0001)\n");
+    fprintf(stderr, "\t-K [interval]\tkeep the whole state every interval steps in Out/keyframes (stores no functions unless -f)\n");
+    fprintf(stderr, "\t-R [start:end]\tintegrate the x window again from Out/keyframes of a run with the same arguments\n");
+    fprintf(stderr, "\t-S [shape[:n][:periodic]]\tcouple the cells of a lattice, such as 100x100 or 10x10x10, through n neighbours (4 or 8, 6 in 3-D) instead of a graph\n");
+    fprintf(stderr, "\t-T [strengths[:diagonal]]\tthe lattice coupling strength, or one per axis such as 0.2,0.1 (default %g; diagonal default the mean)\n", DEFAULT_STRENGTH);
+    fprintf(stderr, "\t-Z [dir[:megabytes]]\tcopy the results of an identical earlier run from the cache dir, or run and add them (default %d MB, least recently used evicted)\n", DEFAULT_CACHE_MB);
+    fprintf(stderr, "\t-O\t\twrite the spikes of every neuron to Out/raster instead of the spikes<neuron> and ISI<neuron> files\n\n");
     exit(EXIT_FAILURE);
 }
 
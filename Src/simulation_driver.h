@@ -11,22 +11,132 @@
 #ifndef SIMULATION_DRIVER
 #define SIMULATION_DRIVER
 
-#include "numerical_methods.h"
-#include "graph_manipulations.h"
+#include "neurosync.h"
+#include "autotune.h"
 
 /**
  * @brief A structure to capture all necessary command-line arguments. 
  */
 typedef struct {
     /**
-     * @brief The conditions to be used to run the simulation.
+     * @brief The parameters to be used to run the simulation.
      */
-    EqConditions cond;
+    NsParams params;
 
     /**
-     * @brief The graph to be used to run the simulation.
+     * @brief The row-major adjacency matrix of the graph to be used to run the simulation.
      */
-    Graph graph;
+    float *weights;
+
+    /**
+     * @brief The number of neurons in the graph.
+     */
+    int neuronCount;
+
+    /**
+     * @brief The criteria for stopping the simulation early (checks is 0 when disabled).
+     */
+    ConvergenceCriteria convergence;
+
+    /**
+     * @brief Whether the neurons are coupled through chemical synapses instead of electrically.
+     */
+    int chemical;
+
+    /**
+     * @brief The parameters of the chemical synapses.
+     */
+    SynapseParams synapses;
+
+    /**
+     * @brief The noise added to x and the spread of the initial values (both 0 for a deterministic simulation).
+     */
+    NoiseParams noise;
+
+    /**
+     * @brief Whether the weights are plastic.
+     */
+    int plastic;
+
+    /**
+     * @brief The plasticity rule and weight snapshot interval.
+     */
+    PlasticityParams plasticity;
+
+    /**
+     * @brief Whether the progress is published to shared memory.
+     */
+    int monitored;
+
+    /**
+     * @brief The shared memory object and interval the progress is published with.
+     */
+    MonitorParams monitor;
+
+    /**
+     * @brief Whether the graph is run as its connected components (threads then counts the components run at once).
+     */
+    int components;
+
+    /**
+     * @brief The file to save an autotuned configuration to before running with it (NULL to not autotune).
+     */
+    const char *tuneFile;
+
+    /**
+     * @brief The file of a saved configuration to run with (NULL to use the given method, step, and threads).
+     */
+    const char *tunedFile;
+
+    /**
+     * @brief Whether a window of an earlier run is integrated again from its keyframes instead of running.
+     */
+    int replaying;
+
+    /**
+     * @brief The x window to integrate again.
+     */
+    float replayStart, replayEnd;
+
+    /**
+     * @brief What the simulation stores while running.
+     */
+    RecordSpec record;
+
+    /**
+     * @brief The result cache directory (NULL to always run).
+     */
+    const char *cacheDir;
+
+    /**
+     * @brief The most bytes the files of the result cache may take.
+     */
+    long long cacheBytes;
+
+    /**
+     * @brief The outputs to write (NS_WRITE_* flags).
+     */
+    int outputs;
+
+    /**
+     * @brief Whether the neurons are the cells of a lattice coupled through their neighbours instead of a graph file.
+     */
+    int latticed;
+
+    /**
+     * @brief The lattice and its coupling strengths.
+     */
+    StencilParams stencil;
+
+    /**
+     * @brief The number of evenly spaced neurons to store (0 to use the neurons of record).
+     */
+    int sampleCount;
+
+    /**
+     * @brief Whether the window in record was given (otherwise it spans the whole run).
+     */
+    int windowed;
 } myArgs;
 
 /**
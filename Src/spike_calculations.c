@@ -12,28 +12,78 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#define SCAN_BLOCK 16   // The number of points the threshold prefilter checks at once.
+
+/**
+ * @brief Checks if any point of a block reaches the threshold.
+ * 
+ * @param y the first SCAN_BLOCK points.
+ * @param threshold the threshold.
+ * @return int - 1 if any point is at or above the threshold, otherwise 0.
+ */
+static int reachesThreshold(const float y[], float threshold) {
+#ifdef __SSE__
+    // Compare four points per instruction and combine the masks.
+    __m128 limit = _mm_set1_ps(threshold);
+    __m128 low = _mm_or_ps(_mm_cmpge_ps(_mm_loadu_ps(y), limit), _mm_cmpge_ps(_mm_loadu_ps(y + 4), limit));
+    __m128 high = _mm_or_ps(_mm_cmpge_ps(_mm_loadu_ps(y + 8), limit), _mm_cmpge_ps(_mm_loadu_ps(y + 12), limit));
+    return _mm_movemask_ps(_mm_or_ps(low, high)) != 0;
+#else
+    int reaches = 0;
+    for (int i = 0; i < SCAN_BLOCK; ++i) {
+        reaches |= y[i] >= threshold;
+    }
+    return reaches;
+#endif
+}
 
 Points initPoints(int size) {
     Points points = {
-        .size = size
+        .size = size,
+        .capacity = size
     };
 
     // Calculate the number of bytes to be allocated for each array.
     int numBytes = size * sizeof(float);
     
-    // Allocate heap memory for the x array.
-    if ((points.x = (float *) malloc(numBytes)) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+    // Allocate heap memory for the x and y arrays.
+    points.x = (float *) malloc(numBytes);
+    points.y = (float *) malloc(numBytes);
+    if (points.x == NULL || points.y == NULL) {
+        free(points.x);
+        free(points.y);
+        points.x = points.y = NULL;
+        points.size = points.capacity = 0;
     }
 
-    // Allocate heap memory for the y array.
-    if ((points.y = (float *) malloc(numBytes)) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+    return points;
+}
+
+int appendPoint(Points *points, float x, float y) {
+    // Double the capacity when full (keeping the old arrays if either cannot grow).
+    if (points->size == points->capacity) {
+        int capacity = points->capacity ? 2 * points->capacity : 8;
+        float *newX, *newY;
+        if ((newX = (float *) realloc(points->x, capacity * sizeof(float))) == NULL) {
+            return 0;
+        }
+        points->x = newX;
+        if ((newY = (float *) realloc(points->y, capacity * sizeof(float))) == NULL) {
+            return 0;
+        }
+        points->y = newY;
+        points->capacity = capacity;
     }
 
-    return points;
+    points->x[points->size] = x;
+    points->y[points->size] = y;
+    ++points->size;
+    return 1;
 }
 
 ISI initISI(int size) {
@@ -46,65 +96,62 @@ ISI initISI(int size) {
 
     // Allocate heap memory for the intervals array.
     if ((isi.intervals = (float *) malloc(numBytes)) == NULL) {
-        perror("malloc() failure");
-        exit(EXIT_FAILURE);
+        isi.size = 0;
     }
 
     return isi;
 }
 
 Points findSpikes(float x[], float y[], int size, float transient, float threshold) {
-    Points spikes;
-    spikes.size = 0;
-
-    // Ensure there are at least 3 points.
-    if (size >= 3) {
-        spikes = initPoints(size / 3); // There can be at most one spike for every three points.
-        int spikeCount = 0;
-
-        // Find the index of the transient value to start from.
-        int start = 0;
-        for (int i = 0; i < size && !start; ++i) {
-            if (x[i] >= transient) {
-                start = i;
-            }        
+    // Find the index of the transient value to start from.
+    int start = 0;
+    for (int i = 0; i < size && !start; ++i) {
+        if (x[i] >= transient) {
+            start = i;
+        }        
+    }
+
+    // Look for peaks that appear above the specifed threshold.
+    return scanSpikes(x, y, size, start, threshold, SPIKE_PEAK);
+}
+
+int calcTransientIndex(float x0, float step, float transient) {
+    int index = ceil((transient - x0) / step - 1e-3);
+    return index > 0 ? index : 0;
+}
+
+Points scanSpikes(float x[], float y[], int size, int start, float threshold, SpikeRule rule) {
+    Points spikes = {
+        .x = NULL,
+        .y = NULL,
+        .size = 0,
+        .capacity = 0
+    };
+
+    // The peak rule compares each point to its neighbours, so its first and last points cannot be spikes.
+    int first = rule == SPIKE_PEAK ? start + 1 : start;
+    int last = rule == SPIKE_PEAK ? size - 2 : size - 1;
+
+    int found = 0;
+    for (int i = first; i <= last; ) {
+        // Skip a block that stays below the threshold (it ends any excursion).
+        int blockEnd = i + SCAN_BLOCK - 1 <= last ? i + SCAN_BLOCK - 1 : last;
+        if (blockEnd - i + 1 == SCAN_BLOCK && !reachesThreshold(&y[i], threshold)) {
+            found = 0;
+            i += SCAN_BLOCK;
+            continue;
         }
 
-        // // Look for the spike tips (the first point cannot be a spike).
-        // for (int i = 0, j = start; j < size - 2; ++i, ++j) {   
-        //     if (y[j] <= y[j+1] && y[j+1] >= y[j+2]) {
-        //         spikes.x[spikeCount] = x[i+1];
-        //         spikes.y[spikeCount] = y[j+1];
-        //         ++spikeCount;
-        //     }
-        // }
-
-        // // Look for the first point above a specifed threshold.
-        // int found = 0;
-        // for (int i = 0, j = start; j < size; ++i, ++j) {
-        //     if (y[j] >= threshold) {
-        //         if (!found) {
-        //             spikes.x[spikeCount] = x[i];
-        //             spikes.y[spikeCount] = y[j];
-        //             ++spikeCount;
-        //             found = 1;
-        //         }
-        //     }
-        //     else {
-        //         found = 0;
-        //     }
-        // }
-
-        // Look for peaks that appear above the specifed threshold
-        int found = 0;
-        for (int i = 0, j = start; j < size - 2; ++i, ++j) {
-            // Check if the middle point is above the threshold.
-            if (y[j+1] >= threshold) {
-                // Check if this point is a peak.
-                if (!found && y[j] <= y[j+1] && y[j+1] >= y[j+2]) {
-                    spikes.x[spikeCount] = x[i+1];
-                    spikes.y[spikeCount] = y[j+1];
-                    ++spikeCount;
+        // Apply the rule to each point of the block.
+        for (; i <= blockEnd; ++i) {
+            if (y[i] >= threshold) {
+                if (!found && (rule != SPIKE_PEAK || (y[i-1] <= y[i] && y[i] >= y[i+1]))) {
+                    if (!appendPoint(&spikes, x[i - start], y[i])) {
+                        freePoints(&spikes);
+                        spikes.x = spikes.y = NULL;
+                        spikes.size = -1;
+                        return spikes;
+                    }
                     found = 1;
                 }
             }
@@ -112,9 +159,6 @@ Points findSpikes(float x[], float y[], int size, float transient, float thresho
                 found = 0;
             }
         }
-
-        // Update the spike count.
-        spikes.size = spikeCount;
     }
 
     return spikes;
@@ -125,12 +169,17 @@ float calcAvgFrequency(int spikeCount, int transient, int xEnd, float scale) {
 }
 
 ISI calcISI(Points *spikes) {
-    ISI isi;
-    isi.size = 0;
+    ISI isi = {
+        .intervals = NULL,
+        .size = 0
+    };
 
     // Ensure there are at least 2 spikes.
     if (spikes->size >= 2) {
-        isi = initISI(spikes->size - 1);
+        if ((isi = initISI(spikes->size - 1)).intervals == NULL) {
+            isi.size = -1;
+            return isi;
+        }
 
         // Find the difference between each spike's x value.
         for (int i = 0; i < spikes->size - 1; ++i) {
@@ -141,12 +190,11 @@ ISI calcISI(Points *spikes) {
     return isi;
 }
 
-void writePoints(char filename[], Points *points) {
+int writePoints(char filename[], Points *points) {
     // Open output file for writing.
     FILE *outfile;
     if ((outfile = fopen(filename, "w")) == NULL) {
-        perror("Write Points");
-        exit(EXIT_FAILURE);
+        return 0;
     }
     
     // Begin writing (x - y).
@@ -155,15 +203,14 @@ void writePoints(char filename[], Points *points) {
     }
 
     // Close ouput file.
-    fclose(outfile);
+    return fclose(outfile) == 0;
 }
 
-void writeISI(char filename[], ISI *isi) {
+int writeISI(char filename[], ISI *isi) {
     // Open output file for writing.
     FILE *outfile;
     if ((outfile = fopen(filename, "w")) == NULL) {
-        perror("Write Inter-Spike Intervals");
-        exit(EXIT_FAILURE);
+        return 0;
     }
 
     // Begin writing (inter-spike intervals).
@@ -172,15 +219,14 @@ void writeISI(char filename[], ISI *isi) {
     }  
 
     // Close ouput file.
-    fclose(outfile);
+    return fclose(outfile) == 0;
 }
 
-void writeAvgFrequencies(char filename[], float avgFreqs[], int size) {
+int writeAvgFrequencies(char filename[], float avgFreqs[], int size) {
     // Open output file for writing.
     FILE *outfile;
     if ((outfile = fopen(filename, "w")) == NULL) {
-        perror("Write Average Frequencies");
-        exit(EXIT_FAILURE);
+        return 0;
     }
 
     // Begin writing (neuron ID - avg freq).
@@ -189,7 +235,52 @@ void writeAvgFrequencies(char filename[], float avgFreqs[], int size) {
     }  
 
     // Close ouput file.
-    fclose(outfile);
+    return fclose(outfile) == 0;
+}
+
+SpikeDetector initSpikeDetector(int neuronCount, float threshold) {
+    SpikeDetector detector = {
+        .threshold = threshold,
+        .neuronCount = neuronCount
+    };
+
+    // Allocate heap memory for the value history and zeroed heap memory for the flags of each neuron.
+    detector.prev = (float *) malloc(neuronCount * sizeof(float));
+    detector.cur = (float *) malloc(neuronCount * sizeof(float));
+    detector.found = (char *) calloc(neuronCount, sizeof(char));
+    detector.seen = (char *) calloc(neuronCount, sizeof(char));
+    if (detector.prev == NULL || detector.cur == NULL || detector.found == NULL || detector.seen == NULL) {
+        freeSpikeDetector(&detector);
+        detector.prev = detector.cur = NULL;
+        detector.found = detector.seen = NULL;
+    }
+
+    return detector;
+}
+
+int detectSpike(SpikeDetector *detector, int neuron, float next) {
+    int spiked = 0;
+
+    // The peak rule needs a value on either side of the middle point.
+    if (detector->seen[neuron] < 2) {
+        ++detector->seen[neuron];
+    }
+    else if (detector->cur[neuron] >= detector->threshold) {
+        // Check if the middle point is a peak (same rule as findSpikes).
+        if (!detector->found[neuron] && detector->prev[neuron] <= detector->cur[neuron] && detector->cur[neuron] >= next) {
+            detector->found[neuron] = 1;
+            spiked = 1;
+        }
+    }
+    else {
+        detector->found[neuron] = 0;
+    }
+
+    // Shift the history.
+    detector->prev[neuron] = detector->cur[neuron];
+    detector->cur[neuron] = next;
+
+    return spiked;
 }
 
 void freePoints(Points *points) {
@@ -201,4 +292,12 @@ void freePoints(Points *points) {
 void freeISI(ISI *isi) {
     // Free the intervals array.
     free(isi->intervals);
+}
+
+void freeSpikeDetector(SpikeDetector *detector) {
+    // Free the history and flag arrays.
+    free(detector->prev);
+    free(detector->cur);
+    free(detector->found);
+    free(detector->seen);
 }
\ No newline at end of file
@@ -11,6 +11,14 @@
 #ifndef SPIKE_CALCULATIONS
 #define SPIKE_CALCULATIONS
 
+/**
+ * @brief The rules for deciding which points are spikes.
+ */
+typedef enum {
+    SPIKE_PEAK,     // The first peak of each excursion above the threshold.
+    SPIKE_CROSSING  // The first point of each excursion above the threshold.
+} SpikeRule;
+
 /**
  * @brief A points structure of x and y arrays.
  */
@@ -29,6 +37,11 @@ typedef struct {
      * @brief The size of the x and y arrays.
      */
     int size;
+
+    /**
+     * @brief The number of points the x and y arrays can hold.
+     */
+    int capacity;
 } Points;
 
 /**
@@ -46,20 +59,65 @@ typedef struct {
     int size;
 } ISI;
 
+/**
+ * @brief An online spike detector which applies the findSpikes() peak rule one step at a time.
+ */
+typedef struct {
+    /**
+     * @brief The second most recent value of each neuron. Access using prev[neuronNum].
+     */
+    float *prev;
+
+    /**
+     * @brief The most recent value of each neuron. Access using cur[neuronNum].
+     */
+    float *cur;
+
+    /**
+     * @brief Whether each neuron has already spiked since it last fell below the threshold.
+     */
+    char *found;
+
+    /**
+     * @brief The number of values seen by each neuron (saturates at 2).
+     */
+    char *seen;
+
+    /**
+     * @brief The minimum value a spike must reach.
+     */
+    float threshold;
+
+    /**
+     * @brief The number of neurons being observed.
+     */
+    int neuronCount;
+} SpikeDetector;
+
 
 /**
  * @brief Initializes and allocates memory for a points struture.
  * 
  * @param size the size of the x and y arrays.
- * @return Points - the initialized points struture.
+ * @return Points - the initialized points struture (NULL arrays if memory could not be allocated).
  */
 Points initPoints(int size);
 
+/**
+ * @brief Appends a point to a points structure, growing its arrays if needed.
+ * 
+ * @param points the points structure.
+ * @param x the x value of the point.
+ * @param y the y value of the point.
+ * @return int - 1 if the point was appended, otherwise 0 (memory could not be allocated and the points are unchanged).
+ */
+int appendPoint(Points *points, float x, float y);
+
 /**
  * @brief Initializes and allocates memory for an ISI struture.
  * 
  * @param size the size of the intervals arrays.
- * @return ISI - the initialized ISI struture.
+ * @return ISI - the initialized ISI struture (NULL intervals if memory could not be allocated).
  */
 ISI initISI(int size);
 
@@ -71,10 +129,37 @@ ISI initISI(int size);
  * @param size the size of the x and y arrays (must be at least 3).
  * @param transient the x position in which the differential equation starts exhibiting its normal behavior.
  * @param threshold the minimum value a spike must reach.
- * @return Points - the points struture of the found spikes. Ensure that the size of the returned Points struct is greater than 0.
+ * @return Points - the points struture of the found spikes. Ensure that the size of the returned Points struct is greater than 0
+ * (it is -1 if memory could not be allocated).
  */
 Points findSpikes(float x[], float y[], int size, float transient, float threshold);
 
+/**
+ * @brief Calculates the index of the first evenly spaced point at or after the transient (with some tolerance for the
+ * rounding of x), replacing a search through the x values.
+ * 
+ * @param x0 the x value of the first point.
+ * @param step the spacing of the points.
+ * @param transient the x position in which the differential equation starts exhibiting its normal behavior.
+ * @return int - the index of the first point at or after the transient (0 if the transient comes first).
+ */
+int calcTransientIndex(float x0, float step, float transient);
+
+/**
+ * @brief Finds the spikes within the given set of points from a starting index. Blocks of points below the threshold 
+ * are skipped with SIMD comparisons before the rule is applied point by point.
+ * 
+ * @param x an array of x coordinates.
+ * @param y an array of y coordinates.
+ * @param size the size of the x and y arrays.
+ * @param start the index of the first point to consider (the x of each spike is shifted back by it, matching findSpikes()).
+ * @param threshold the minimum value a spike must reach.
+ * @param rule the rule for deciding which points are spikes.
+ * @return Points - the points struture of the found spikes (size 0 and NULL arrays if none were found, size -1 if
+ * memory could not be allocated).
+ */
+Points scanSpikes(float x[], float y[], int size, int start, float threshold, SpikeRule rule);
+
 /**
  * @brief Calculates the average frequency.
  * 
@@ -90,7 +175,8 @@ float calcAvgFrequency(int spikeCount, int transient, int xEnd, float scale);
  * @brief Calculates the inter-spike intervals within the given set of spikes.
  * 
  * @param spikes the Points struture where the spikes are stored.
- * @return ISI - the ISI struture of the calculated intervals. Ensure that the size of the returned ISI struct is greater than 0.
+ * @return ISI - the ISI struture of the calculated intervals. Ensure that the size of the returned ISI struct is greater than 0
+ * (it is -1 if memory could not be allocated).
  */
 ISI calcISI(Points *spikes);
 
@@ -99,16 +185,18 @@ ISI calcISI(Points *spikes);
  * 
  * @param filename the name of the file to write to.
  * @param points the Points struture to be written.
+ * @return int - 1 if the file was written, otherwise 0.
  */
-void writePoints(char filename[], Points *points);
+int writePoints(char filename[], Points *points);
 
 /**
  * @brief Writes an array of inter-spike intervals to a file.
  * 
  * @param filename the name of the file to write to.
  * @param isi the ISI struture to be written.
+ * @return int - 1 if the file was written, otherwise 0.
  */
-void writeISI(char filename[], ISI *isi);
+int writeISI(char filename[], ISI *isi);
 
 /**
  * @brief Writes an array of average frequencies to a file.
@@ -116,8 +204,28 @@ void writeISI(char filename[], ISI *isi);
  * @param filename the name of the file to write to.
  * @param avgFreqs the array of frequencies to be written.
  * @param size the number of frequencies.
+ * @return int - 1 if the file was written, otherwise 0.
+ */
+int writeAvgFrequencies(char filename[], float avgFreqs[], int size);
+
+/**
+ * @brief Initializes and allocates memory for a spike detector structure.
+ * 
+ * @param neuronCount the number of neurons to observe.
+ * @param threshold the minimum value a spike must reach.
+ * @return SpikeDetector - the initialized spike detector structure (NULL arrays if memory could not be allocated).
+ */
+SpikeDetector initSpikeDetector(int neuronCount, float threshold);
+
+/**
+ * @brief Feeds the next value of a neuron to the detector.
+ * 
+ * @param detector the spike detector.
+ * @param neuron the number of the neuron.
+ * @param next the newest value of the neuron.
+ * @return int - 1 if the previous value was a spike peak, otherwise 0.
  */
-void writeAvgFrequencies(char filename[], float avgFreqs[], int size);
+int detectSpike(SpikeDetector *detector, int neuron, float next);
 
 /**
  * @brief Frees the heap memory allocated to a Points struture.
@@ -133,4 +241,11 @@ void freePoints(Points *points);
  */
 void freeISI(ISI *isi);
 
+/**
+ * @brief Frees the heap memory allocated to a spike detector structure.
+ * 
+ * @param detector the spike detector to be freed.
+ */
+void freeSpikeDetector(SpikeDetector *detector);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,225 @@
+/**
+ * @file stencil.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the stencil header file.
+ * @version 0.1
+ * @date 2022-10-19
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "stencil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Adds a neighbour to a stencil.
+ *
+ * @param stencil the stencil.
+ * @param layer the layer offset of the neighbour.
+ * @param row the row offset of the neighbour.
+ * @param column the column offset of the neighbour.
+ * @param weight the weight of the neighbour.
+ */
+static void addNeighbour(Stencil *stencil, int layer, int row, int column, float weight) {
+    stencil->layerOffsets[stencil->count] = layer;
+    stencil->rowOffsets[stencil->count] = row;
+    stencil->columnOffsets[stencil->count] = column;
+    stencil->weights[stencil->count++] = weight;
+}
+
+/**
+ * @brief Finds the position of a neighbour along an axis, wrapping around when the lattice is periodic.
+ *
+ * @param position the position of the neuron.
+ * @param offset the offset of the neighbour.
+ * @param size the number of cells along the axis.
+ * @param periodic whether the lattice wraps around.
+ * @return int - the position of the neighbour (-1 if it is outside the lattice).
+ */
+static int findNeighbour(int position, int offset, int size, int periodic) {
+    position += offset;
+    if (position < 0 || position >= size) {
+        return periodic ? (position + size) % size : -1;
+    }
+    return position;
+}
+
+long getStencilCellCount(const StencilParams *params) {
+    if ((params->axes != 2 && params->axes != 3) || (params->axes == 2 && params->neighbours != 4 && params->neighbours != 8) ||
+        (params->axes == 3 && params->neighbours != 6)) {
+        return 0;
+    }
+
+    long count = 1;
+    for (int axis = 0; axis < params->axes; ++axis) {
+        if (params->shape[axis] < (params->periodic ? 3 : 1)) {
+            return 0;
+        }
+        count *= params->shape[axis];
+    }
+    return count;
+}
+
+Stencil initStencil(const StencilParams *params) {
+    int threeD = params->axes == 3;
+    Stencil stencil = {
+        .layers = threeD ? params->shape[0] : 1,
+        .rows = params->shape[threeD],
+        .columns = params->shape[threeD + 1],
+        .periodic = params->periodic,
+        .count = 0
+    };
+
+    // List the neighbours in ascending order of their numbers.
+    float layerWeight = threeD ? params->strength[0] : 0.0, rowWeight = params->strength[threeD], columnWeight = params->strength[threeD + 1];
+    if (threeD) {
+        addNeighbour(&stencil, -1, 0, 0, layerWeight);
+    }
+    if (params->neighbours == 8) {
+        addNeighbour(&stencil, 0, -1, -1, params->diagonal);
+    }
+    addNeighbour(&stencil, 0, -1, 0, rowWeight);
+    if (params->neighbours == 8) {
+        addNeighbour(&stencil, 0, -1, 1, params->diagonal);
+    }
+    addNeighbour(&stencil, 0, 0, -1, columnWeight);
+    addNeighbour(&stencil, 0, 0, 1, columnWeight);
+    if (params->neighbours == 8) {
+        addNeighbour(&stencil, 0, 1, -1, params->diagonal);
+    }
+    addNeighbour(&stencil, 0, 1, 0, rowWeight);
+    if (params->neighbours == 8) {
+        addNeighbour(&stencil, 0, 1, 1, params->diagonal);
+    }
+    if (threeD) {
+        addNeighbour(&stencil, 1, 0, 0, layerWeight);
+    }
+
+    // Allocate heap memory for the coupling of each neuron.
+    stencil.coupling = (float *) malloc((size_t) stencil.layers * stencil.rows * stencil.columns * sizeof(float));
+
+    return stencil;
+}
+
+void sweepStencil(Stencil *stencil, const float x[], int first, int last) {
+    int rows = stencil->rows, columns = stencil->columns;
+    for (int start = first; start < last; ) {
+        // Take the part of a row within the range (columns firstColumn to lastColumn - 1).
+        int layer = start / (rows * columns), row = start / columns % rows, firstColumn = start % columns;
+        int lastColumn = last - start < columns - firstColumn ? firstColumn + last - start : columns;
+        const float *mine = &x[start - firstColumn];
+        float *coupling = &stencil->coupling[start - firstColumn];
+        for (int column = firstColumn; column < lastColumn; ++column) {
+            coupling[column] = 0.0;
+        }
+
+        // Add each neighbour across the columns, whose neighbours sit at a fixed offset within the neighbouring row.
+        for (int n = 0; n < stencil->count; ++n) {
+            int neighbourLayer = findNeighbour(layer, stencil->layerOffsets[n], stencil->layers, stencil->periodic);
+            int neighbourRow = findNeighbour(row, stencil->rowOffsets[n], rows, stencil->periodic);
+            if (neighbourLayer < 0 || neighbourRow < 0) {
+                continue;
+            }
+            const float *theirs = &x[((size_t) neighbourLayer * rows + neighbourRow) * columns];
+            float weight = stencil->weights[n];
+            int offset = stencil->columnOffsets[n];
+
+            // The columns whose neighbour is within the row, then the edge columns whose neighbour wraps around.
+            int low = firstColumn > -offset ? firstColumn : -offset, high = lastColumn < columns - offset ? lastColumn : columns - offset;
+            for (int column = low; column < high; ++column) {
+                coupling[column] += weight * (mine[column] - theirs[column + offset]);
+            }
+            for (int column = firstColumn; stencil->periodic && column < low && column < lastColumn; ++column) {
+                coupling[column] += weight * (mine[column] - theirs[column + offset + columns]);
+            }
+            for (int column = high > firstColumn ? high : firstColumn; stencil->periodic && column < lastColumn; ++column) {
+                coupling[column] += weight * (mine[column] - theirs[column + offset - columns]);
+            }
+        }
+
+        start += lastColumn - firstColumn;
+    }
+}
+
+float calcStencilCoupling(const Stencil *stencil, const float x[], int neuron) {
+    int rows = stencil->rows, columns = stencil->columns;
+    int layer = neuron / (rows * columns), row = neuron / columns % rows, column = neuron % columns;
+    float coupling = 0.0;
+
+    for (int n = 0; n < stencil->count; ++n) {
+        int neighbourLayer = findNeighbour(layer, stencil->layerOffsets[n], stencil->layers, stencil->periodic);
+        int neighbourRow = findNeighbour(row, stencil->rowOffsets[n], rows, stencil->periodic);
+        int neighbourColumn = findNeighbour(column, stencil->columnOffsets[n], columns, stencil->periodic);
+        if (neighbourLayer >= 0 && neighbourRow >= 0 && neighbourColumn >= 0) {
+            coupling += stencil->weights[n] * (x[neuron] - x[((size_t) neighbourLayer * rows + neighbourRow) * columns + neighbourColumn]);
+        }
+    }
+
+    return coupling;
+}
+
+float getStencilDegree(const Stencil *stencil, int neuron) {
+    int rows = stencil->rows, columns = stencil->columns;
+    int layer = neuron / (rows * columns), row = neuron / columns % rows, column = neuron % columns;
+    float degree = 0.0;
+
+    for (int n = 0; n < stencil->count; ++n) {
+        if (findNeighbour(layer, stencil->layerOffsets[n], stencil->layers, stencil->periodic) >= 0 &&
+            findNeighbour(row, stencil->rowOffsets[n], rows, stencil->periodic) >= 0 &&
+            findNeighbour(column, stencil->columnOffsets[n], columns, stencil->periodic) >= 0) {
+            degree += stencil->weights[n];
+        }
+    }
+
+    return degree;
+}
+
+Partition initStencilPartition(const Stencil *stencil, int count) {
+    int neuronCount = stencil->layers * stencil->rows * stencil->columns, rowCount = stencil->layers * stencil->rows;
+    Partition partition = {
+        .count = count < neuronCount ? count : neuronCount,
+        .neurons = NULL,
+        .edges = 0,
+        .crossEdges = 0
+    };
+
+    // Allocate heap memory for the partition bounds.
+    if ((partition.first = (int *) malloc((partition.count + 1) * sizeof(int))) == NULL) {
+        return partition;
+    }
+
+    // Cut between whole rows if every partition can get one (the neighbours of a row then sit in at most two others).
+    for (int p = 0; p <= partition.count; ++p) {
+        partition.first[p] = partition.count <= rowCount ? (int) ((long) p * rowCount / partition.count) * stencil->columns :
+                             (int) ((long) p * neuronCount / partition.count);
+    }
+
+    // Count the edges, and those between partitions.
+    int rows = stencil->rows, columns = stencil->columns;
+    for (int p = 0; p < partition.count; ++p) {
+        for (int neuron = partition.first[p]; neuron < partition.first[p + 1]; ++neuron) {
+            int layer = neuron / (rows * columns), row = neuron / columns % rows, column = neuron % columns;
+            for (int n = 0; n < stencil->count; ++n) {
+                int neighbourLayer = findNeighbour(layer, stencil->layerOffsets[n], stencil->layers, stencil->periodic);
+                int neighbourRow = findNeighbour(row, stencil->rowOffsets[n], rows, stencil->periodic);
+                int neighbourColumn = findNeighbour(column, stencil->columnOffsets[n], columns, stencil->periodic);
+                if (neighbourLayer < 0 || neighbourRow < 0 || neighbourColumn < 0 || stencil->weights[n] == 0.0) {
+                    continue;
+                }
+                int neighbour = (neighbourLayer * rows + neighbourRow) * columns + neighbourColumn;
+                ++partition.edges;
+                if (neighbour < partition.first[p] || neighbour >= partition.first[p + 1]) {
+                    ++partition.crossEdges;
+                }
+            }
+        }
+    }
+
+    return partition;
+}
+
+void freeStencil(Stencil *stencil) {
+    free(stencil->coupling);
+}
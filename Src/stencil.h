@@ -0,0 +1,156 @@
+/**
+ * @file stencil.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that couples the neurons of a regular lattice through their neighbours, found from
+ * their numbers instead of an adjacency matrix.
+ * @version 0.1
+ * @date 2022-10-19
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef STENCIL
+#define STENCIL
+
+#include "partition.h"
+
+#define STENCIL_MAX_NEIGHBOURS 8    // The most neighbours of a cell.
+
+/**
+ * @brief A stencil parameters structure which describes a lattice and the strength of its coupling. The neurons are
+ * numbered row-major (the last axis changes fastest), as graph_builder_grid.py numbers a grid.
+ */
+typedef struct {
+    /**
+     * @brief The number of axes (2 or 3).
+     */
+    int axes;
+
+    /**
+     * @brief The number of cells along each axis, slowest first (rows and columns, or layers, rows, and columns).
+     */
+    int shape[3];
+
+    /**
+     * @brief The number of neighbours of each cell: 4 (edges) or 8 (edges and corners) for 2 axes, 6 (faces) for 3 axes.
+     */
+    int neighbours;
+
+    /**
+     * @brief Whether the lattice wraps around at its edges (each axis then needs at least 3 cells).
+     */
+    int periodic;
+
+    /**
+     * @brief The coupling strength between neighbours along each axis, in the order of shape.
+     */
+    float strength[3];
+
+    /**
+     * @brief The coupling strength between diagonal neighbours (8 neighbours only).
+     */
+    float diagonal;
+} StencilParams;
+
+/**
+ * @brief A stencil structure which holds the offsets and weights of the neighbours of a cell and the coupling of each neuron.
+ */
+typedef struct {
+    /**
+     * @brief The number of layers, rows, and columns (1 layer for 2 axes).
+     */
+    int layers, rows, columns;
+
+    /**
+     * @brief Whether the lattice wraps around at its edges.
+     */
+    int periodic;
+
+    /**
+     * @brief The number of neighbours of a cell.
+     */
+    int count;
+
+    /**
+     * @brief The layer, row, and column offset of each neighbour, in ascending order of their numbers (before wrapping around).
+     */
+    int layerOffsets[STENCIL_MAX_NEIGHBOURS], rowOffsets[STENCIL_MAX_NEIGHBOURS], columnOffsets[STENCIL_MAX_NEIGHBOURS];
+
+    /**
+     * @brief The weight of each neighbour.
+     */
+    float weights[STENCIL_MAX_NEIGHBOURS];
+
+    /**
+     * @brief The coupling of each neuron from the last sweep. Access using coupling[neuronNum].
+     */
+    float *coupling;
+} Stencil;
+
+/**
+ * @brief Gets the number of cells of a lattice.
+ *
+ * @param params the lattice.
+ * @return long - the number of cells (0 if the lattice is invalid).
+ */
+long getStencilCellCount(const StencilParams *params);
+
+/**
+ * @brief Initializes and allocates memory for a stencil structure.
+ *
+ * @param params the lattice (which must be valid).
+ * @return Stencil - the initialized stencil structure (NULL coupling if memory could not be allocated).
+ */
+Stencil initStencil(const StencilParams *params);
+
+/**
+ * @brief Calculates the coupling of a range of neurons, sum(weight * (x_mine - x_neighbour)), into stencil->coupling. Each
+ * row of the lattice is swept a neighbour at a time over its contiguous columns. Without wrap-around, the neighbours of
+ * each neuron are summed in ascending order of their numbers, exactly as calcSyncFactor() sums the same lattice stored as
+ * a matrix (the wrapped neighbours of a periodic lattice are summed in stencil order instead).
+ *
+ * @param stencil the stencil.
+ * @param x the voltage of every neuron. Access using x[neuronNum].
+ * @param first the first neuron.
+ * @param last one past the last neuron.
+ */
+void sweepStencil(Stencil *stencil, const float x[], int first, int last);
+
+/**
+ * @brief Calculates the coupling of one neuron (the same value sweepStencil() calculates).
+ *
+ * @param stencil the stencil.
+ * @param x the voltage of every neuron. Access using x[neuronNum].
+ * @param neuron the number of the neuron.
+ * @return float - the coupling of the neuron.
+ */
+float calcStencilCoupling(const Stencil *stencil, const float x[], int neuron);
+
+/**
+ * @brief Gets the sum of the weights of the neighbours of a neuron (the self part of its coupling).
+ *
+ * @param stencil the stencil.
+ * @param neuron the number of the neuron.
+ * @return float - the sum of the weights.
+ */
+float getStencilDegree(const Stencil *stencil, int neuron);
+
+/**
+ * @brief Splits the neurons of a lattice into contiguous ranges of nearly equal size, cutting between whole rows when
+ * there are at least as many rows as partitions.
+ *
+ * @param stencil the stencil.
+ * @param count the number of partitions (at most the number of neurons).
+ * @return Partition - the initialized partition structure (free with freePartition(); NULL bounds if memory could not
+ * be allocated).
+ */
+Partition initStencilPartition(const Stencil *stencil, int count);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a stencil structure.
+ *
+ * @param stencil the stencil to be freed.
+ */
+void freeStencil(Stencil *stencil);
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @file synapses.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the synapses header file.
+ * @version 0.1
+ * @date 2022-09-20
+ * 
+ * @copyright Copyright (c) 2022
+ */
+
+#include "synapses.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#define INITIAL_QUEUE_CAPACITY 64   // The number of events the queue can hold before it first grows.
+
+/**
+ * @brief Adds an event to the queue, growing it if needed.
+ * 
+ * @param queue the event queue.
+ * @param event the event to add.
+ * @return int - 1 if the event was added, otherwise 0 (memory could not be allocated).
+ */
+static int pushEvent(EventQueue *queue, SynapticEvent event) {
+    // Double the capacity when full.
+    if (queue->size == queue->capacity) {
+        SynapticEvent *events;
+        if ((events = (SynapticEvent *) realloc(queue->events, 2 * queue->capacity * sizeof(SynapticEvent))) == NULL) {
+            return 0;
+        }
+        queue->events = events;
+        queue->capacity *= 2;
+    }
+
+    // Sift the new event up to its place.
+    int child = queue->size++;
+    while (child > 0 && queue->events[(child - 1) / 2].time > event.time) {
+        queue->events[child] = queue->events[(child - 1) / 2];
+        child = (child - 1) / 2;
+    }
+    queue->events[child] = event;
+    return 1;
+}
+
+/**
+ * @brief Removes the earliest event from the queue.
+ * 
+ * @param queue the event queue (must not be empty).
+ * @return SynapticEvent - the earliest event.
+ */
+static SynapticEvent popEvent(EventQueue *queue) {
+    SynapticEvent first = queue->events[0];
+    SynapticEvent last = queue->events[--queue->size];
+
+    // Sift the last event down from the root.
+    int parent = 0;
+    for (int child = 1; child < queue->size; parent = child, child = 2 * child + 1) {
+        if (child + 1 < queue->size && queue->events[child + 1].time < queue->events[child].time) {
+            ++child;
+        }
+        if (last.time <= queue->events[child].time) {
+            break;
+        }
+        queue->events[parent] = queue->events[child];
+    }
+    queue->events[parent] = last;
+
+    return first;
+}
+
+/**
+ * @brief Frees a partially initialized synapses structure.
+ * 
+ * @param synapses the synapses.
+ * @return Synapses - the synapses with NULL conductances, marking that memory could not be allocated.
+ */
+static Synapses failSynapses(Synapses *synapses) {
+    freeSynapses(synapses);
+    synapses->conductance = synapses->weights = NULL;
+    synapses->outStart = synapses->targets = NULL;
+    synapses->queue.events = NULL;
+    synapses->detector.prev = synapses->detector.cur = NULL;
+    synapses->detector.found = synapses->detector.seen = NULL;
+    return *synapses;
+}
+
+Synapses initSynapses(SynapseParams *params, Graph *graph) {
+    int neuronCount = graph->vertexCount;
+    Synapses synapses = {
+        .params = *params,
+        .queue = {
+            .size = 0,
+            .capacity = INITIAL_QUEUE_CAPACITY
+        },
+        .detector = initSpikeDetector(neuronCount, params->threshold),
+        .neuronCount = neuronCount
+    };
+
+    // Allocate heap memory for the conductances, out-edge offsets, and event queue.
+    synapses.conductance = (float *) calloc(neuronCount, sizeof(float));
+    synapses.outStart = (int *) calloc(neuronCount + 1, sizeof(int));
+    synapses.queue.events = (SynapticEvent *) malloc(synapses.queue.capacity * sizeof(SynapticEvent));
+    synapses.targets = NULL;
+    synapses.weights = NULL;
+    if (synapses.conductance == NULL || synapses.outStart == NULL || synapses.queue.events == NULL || synapses.detector.prev == NULL) {
+        return failSynapses(&synapses);
+    }
+
+    // Count the out-edges of each presynaptic neuron (column of the adjacency matrix).
+    for (int post = 0; post < neuronCount; ++post) {
+        for (int pre = 0; pre < neuronCount; ++pre) {
+            if (pre != post && graph->adjMatrix[post][pre] != 0.0) {
+                ++synapses.outStart[pre + 1];
+            }
+        }
+    }
+    for (int pre = 0; pre < neuronCount; ++pre) {
+        synapses.outStart[pre + 1] += synapses.outStart[pre];
+    }
+
+    // Allocate heap memory for the out-edges.
+    int edgeCount = synapses.outStart[neuronCount];
+    synapses.targets = (int *) malloc((edgeCount ? edgeCount : 1) * sizeof(int));
+    synapses.weights = (float *) malloc((edgeCount ? edgeCount : 1) * sizeof(float));
+    int *filled = (int *) malloc(neuronCount * sizeof(int));
+    if (synapses.targets == NULL || synapses.weights == NULL || filled == NULL) {
+        free(filled);
+        return failSynapses(&synapses);
+    }
+
+    // Fill in the out-edges of each presynaptic neuron.
+    for (int pre = 0; pre < neuronCount; ++pre) {
+        filled[pre] = synapses.outStart[pre];
+    }
+    for (int post = 0; post < neuronCount; ++post) {
+        for (int pre = 0; pre < neuronCount; ++pre) {
+            if (pre != post && graph->adjMatrix[post][pre] != 0.0) {
+                synapses.targets[filled[pre]] = post;
+                synapses.weights[filled[pre]] = graph->adjMatrix[post][pre];
+                ++filled[pre];
+            }
+        }
+    }
+    free(filled);
+
+    return synapses;
+}
+
+void deliverSpikes(Synapses *synapses, float curX) {
+    while (synapses->queue.size > 0 && synapses->queue.events[0].time <= curX) {
+        SynapticEvent event = popEvent(&synapses->queue);
+
+        // Increment the conductance of every target by the weight of its edge.
+        for (int edge = synapses->outStart[event.source]; edge < synapses->outStart[event.source + 1]; ++edge) {
+            synapses->conductance[synapses->targets[edge]] += synapses->weights[edge];
+        }
+    }
+}
+
+float calcSynapticCurrent(Synapses *synapses, int neuron, float voltage, float elapsed) {
+    float conductance = synapses->conductance[neuron];
+    if (conductance == 0.0) {
+        return 0.0;
+    }
+
+    return conductance * expf(-elapsed / synapses->params.decay) * (synapses->params.reversal - voltage);
+}
+
+int detectSynapticSpike(Synapses *synapses, int neuron, float voltage, float prevX) {
+    // Only neurons with out-edges need to be queued.
+    if (detectSpike(&synapses->detector, neuron, voltage) && synapses->outStart[neuron] < synapses->outStart[neuron + 1]) {
+        SynapticEvent event = {
+            .time = prevX + synapses->params.delay,
+            .source = neuron
+        };
+        return pushEvent(&synapses->queue, event);
+    }
+    return 1;
+}
+
+void decayConductances(Synapses *synapses, float step) {
+    float factor = expf(-step / synapses->params.decay);
+    for (int neuron = 0; neuron < synapses->neuronCount; ++neuron) {
+        synapses->conductance[neuron] *= factor;
+    }
+}
+
+void freeSynapses(Synapses *synapses) {
+    // Free the conductances, out-edges, queue, and detector.
+    free(synapses->conductance);
+    free(synapses->outStart);
+    free(synapses->targets);
+    free(synapses->weights);
+    free(synapses->queue.events);
+    freeSpikeDetector(&synapses->detector);
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+/**
+ * @file synapses.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that implements event-driven chemical synapses.
+ * @version 0.1
+ * @date 2022-09-20
+ * 
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef SYNAPSES
+#define SYNAPSES
+
+#include "graph_manipulations.h"
+#include "spike_calculations.h"
+
+/**
+ * @brief A parameters structure which describes the chemical synapses.
+ */
+typedef struct {
+    /**
+     * @brief The reversal potential of the synapses.
+     */
+    float reversal;
+
+    /**
+     * @brief The time constant the synaptic conductances decay with.
+     */
+    float decay;
+
+    /**
+     * @brief The time between a presynaptic spike and the conductance increment of its targets.
+     */
+    float delay;
+
+    /**
+     * @brief The minimum value a presynaptic spike must reach.
+     */
+    float threshold;
+} SynapseParams;
+
+/**
+ * @brief A pending spike delivery.
+ */
+typedef struct {
+    /**
+     * @brief The x position the spike arrives at its targets.
+     */
+    float time;
+
+    /**
+     * @brief The number of the presynaptic neuron.
+     */
+    int source;
+} SynapticEvent;
+
+/**
+ * @brief A time-ordered queue (binary min-heap) of synaptic events.
+ */
+typedef struct {
+    /**
+     * @brief The heap of events. The earliest event is events[0].
+     */
+    SynapticEvent *events;
+
+    /**
+     * @brief The number of events in the queue.
+     */
+    int size;
+
+    /**
+     * @brief The number of events the queue can hold before growing.
+     */
+    int capacity;
+} EventQueue;
+
+/**
+ * @brief A synapses structure which stores the state of every chemical synapse.
+ */
+typedef struct {
+    /**
+     * @brief The synapse parameters.
+     */
+    SynapseParams params;
+
+    /**
+     * @brief The synaptic conductance of each neuron at the start of the current step. Access using conductance[neuronNum].
+     */
+    float *conductance;
+
+    /**
+     * @brief The offsets of each neuron's out-edges within targets and weights. Neuron n owns [outStart[n], outStart[n + 1]).
+     */
+    int *outStart;
+
+    /**
+     * @brief The postsynaptic neuron of each out-edge.
+     */
+    int *targets;
+
+    /**
+     * @brief The weight of each out-edge.
+     */
+    float *weights;
+
+    /**
+     * @brief The pending spike deliveries.
+     */
+    EventQueue queue;
+
+    /**
+     * @brief The online detector used to find presynaptic spikes.
+     */
+    SpikeDetector detector;
+
+    /**
+     * @brief The number of neurons in the graph.
+     */
+    int neuronCount;
+} Synapses;
+
+/**
+ * @brief Initializes and allocates memory for a synapses structure from the edges of a graph.
+ * 
+ * @param params the synapse parameters.
+ * @param graph the graph whose edges become synapses (adjMatrix[post][pre] is the weight of pre onto post).
+ * @return Synapses - the initialized synapses structure (NULL conductances if memory could not be allocated).
+ */
+Synapses initSynapses(SynapseParams *params, Graph *graph);
+
+/**
+ * @brief Delivers every queued spike that has arrived by the given x position to its targets.
+ * 
+ * @param synapses the synapses.
+ * @param curX the current x position.
+ */
+void deliverSpikes(Synapses *synapses, float curX);
+
+/**
+ * @brief Calculates the synaptic current into a neuron.
+ * 
+ * @param synapses the synapses.
+ * @param neuron the number of the postsynaptic neuron.
+ * @param voltage the voltage of the postsynaptic neuron.
+ * @param elapsed the time since the start of the current step.
+ * @return float - the synaptic current (conductance * (reversal - voltage)).
+ */
+float calcSynapticCurrent(Synapses *synapses, int neuron, float voltage, float elapsed);
+
+/**
+ * @brief Feeds the newest voltage of a presynaptic neuron to the spike detector and queues any spike it finds.
+ * 
+ * @param synapses the synapses.
+ * @param neuron the number of the presynaptic neuron.
+ * @param voltage the voltage of the neuron at the end of the step.
+ * @param prevX the x position at the start of the step (where any detected peak occurred).
+ * @return int - 1 if any spike was queued or none was found, otherwise 0 (memory could not be allocated).
+ */
+int detectSynapticSpike(Synapses *synapses, int neuron, float voltage, float prevX);
+
+/**
+ * @brief Exponentially decays the conductance of every neuron over a step.
+ * 
+ * @param synapses the synapses.
+ * @param step the size of the step.
+ */
+void decayConductances(Synapses *synapses, float step);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a synapses structure.
+ * 
+ * @param synapses the synapses to be freed.
+ */
+void freeSynapses(Synapses *synapses);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,267 @@
+/**
+ * @file trajectory.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the trajectory header file.
+ * @version 0.1
+ * @date 2022-10-18
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#include "trajectory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define QUANTA_LIMIT 268435455      // The largest magnitude of a sample in quanta (so every residual fits 32 bits zigzagged).
+
+/**
+ * @brief Rounds a value to the nearest number of quanta, saturating values that do not fit.
+ *
+ * @param value the value.
+ * @param quantum the distance between representable values.
+ * @return int32_t - the value in quanta.
+ */
+static int32_t quantize(float value, float quantum) {
+    double quanta = value / (double) quantum;
+    if (!(quanta > -QUANTA_LIMIT)) {
+        return isnan(quanta) ? QUANTA_LIMIT : -QUANTA_LIMIT;
+    }
+    return quanta < QUANTA_LIMIT ? (int32_t) lrint(quanta) : QUANTA_LIMIT;
+}
+
+/**
+ * @brief Packs the samples of the last block, which has filled, as a new block.
+ *
+ * @param trajectory the trajectory.
+ * @return int - 1 if the block was packed, otherwise 0 (memory could not be allocated).
+ */
+static int packBlock(CompressedTrajectory *trajectory) {
+    // Zigzag the residuals so small negative ones also take few bits, and find the widest.
+    const int32_t *pending = trajectory->pending;
+    uint32_t zigzag[TRAJECTORY_BLOCK - 1], largest = 0;
+    for (int i = 1; i < TRAJECTORY_BLOCK; ++i) {
+        int64_t residual = (int64_t) pending[i] - (i > 1 ? 2 * (int64_t) pending[i - 1] - pending[i - 2] : pending[0]);
+        zigzag[i - 1] = (uint32_t) (residual < 0 ? -2 * residual - 1 : 2 * residual);
+        largest |= zigzag[i - 1];
+    }
+    int width = 0;
+    while (width < 32 && largest >> width) {
+        ++width;
+    }
+
+    // Grow the arrays if needed.
+    size_t bytes = ((TRAJECTORY_BLOCK - 1) * width + 7) / 8;
+    if (trajectory->blockCount == trajectory->blockCapacity) {
+        int blockCapacity = trajectory->blockCapacity ? 2 * trajectory->blockCapacity : 8;
+        TrajectoryBlock *blocks;
+        if ((blocks = (TrajectoryBlock *) realloc(trajectory->blocks, blockCapacity * sizeof(TrajectoryBlock))) == NULL) {
+            return 0;
+        }
+        trajectory->blocks = blocks;
+        trajectory->blockCapacity = blockCapacity;
+    }
+    if (trajectory->dataSize + bytes > trajectory->dataCapacity) {
+        size_t dataCapacity = trajectory->dataCapacity;
+        while (trajectory->dataSize + bytes > dataCapacity) {
+            dataCapacity = dataCapacity ? 2 * dataCapacity : 256;
+        }
+        uint8_t *data;
+        if ((data = (uint8_t *) realloc(trajectory->data, dataCapacity)) == NULL) {
+            return 0;
+        }
+        trajectory->data = data;
+        trajectory->dataCapacity = dataCapacity;
+    }
+
+    // Pack the residuals least significant bit first.
+    trajectory->blocks[trajectory->blockCount++] = (TrajectoryBlock) {
+        .first = trajectory->pending[0],
+        .offset = trajectory->dataSize,
+        .width = width
+    };
+    uint8_t *out = trajectory->data + trajectory->dataSize;
+    uint64_t bits = 0;
+    int bitCount = 0;
+    for (int i = 0; i < TRAJECTORY_BLOCK - 1; ++i) {
+        bits |= (uint64_t) zigzag[i] << bitCount;
+        for (bitCount += width; bitCount >= 8; bitCount -= 8, bits >>= 8) {
+            *out++ = (uint8_t) bits;
+        }
+    }
+    if (bitCount > 0) {
+        *out = (uint8_t) bits;
+    }
+    trajectory->dataSize += bytes;
+    return 1;
+}
+
+/**
+ * @brief Decodes the samples of a full block.
+ *
+ * @param trajectory the trajectory.
+ * @param block the number of the block.
+ * @param samples where to store the TRAJECTORY_BLOCK samples.
+ */
+static void unpackBlock(const CompressedTrajectory *trajectory, int block, float samples[]) {
+    const TrajectoryBlock *info = &trajectory->blocks[block];
+    const uint8_t *in = trajectory->data + info->offset;
+    uint64_t mask = info->width < 32 ? ((uint64_t) 1 << info->width) - 1 : 0xFFFFFFFF, bits = 0;
+    int bitCount = 0;
+    int64_t value = info->first, slope = 0;
+    samples[0] = value * (double) trajectory->quantum;
+    for (int i = 1; i < TRAJECTORY_BLOCK; ++i) {
+        while (bitCount < info->width) {
+            bits |= (uint64_t) *in++ << bitCount;
+            bitCount += 8;
+        }
+        uint32_t zigzag = bits & mask;
+        bits >>= info->width;
+        bitCount -= info->width;
+        slope += zigzag & 1 ? -(int64_t) (zigzag >> 1) - 1 : (int64_t) (zigzag >> 1);
+        value += slope;
+        samples[i] = value * (double) trajectory->quantum;
+    }
+}
+
+CompressedTrajectory initTrajectory(float quantum, int capacity) {
+    CompressedTrajectory trajectory = {
+        .quantum = quantum,
+        .size = 0,
+        .blocks = NULL,
+        .blockCount = 0,
+        .blockCapacity = capacity / TRAJECTORY_BLOCK,
+        .data = NULL,
+        .dataSize = 0,
+        .dataCapacity = 0
+    };
+
+    // Allocate heap memory for the block of each expected sample and the samples of the last block.
+    trajectory.blocks = (TrajectoryBlock *) malloc((trajectory.blockCapacity ? trajectory.blockCapacity : 1) * sizeof(TrajectoryBlock));
+    trajectory.pending = (int32_t *) malloc(TRAJECTORY_BLOCK * sizeof(int32_t));
+    if (trajectory.blocks == NULL || trajectory.pending == NULL) {
+        free(trajectory.blocks);
+        free(trajectory.pending);
+        trajectory.blocks = NULL;
+        trajectory.pending = NULL;
+        return trajectory;
+    }
+    trajectory.blockCapacity = trajectory.blockCapacity ? trajectory.blockCapacity : 1;
+
+    return trajectory;
+}
+
+int appendSample(CompressedTrajectory *trajectory, float value) {
+    trajectory->pending[trajectory->size % TRAJECTORY_BLOCK] = quantize(value, trajectory->quantum);
+    if ((trajectory->size + 1) % TRAJECTORY_BLOCK == 0 && !packBlock(trajectory)) {
+        return 0;
+    }
+    ++trajectory->size;
+    return 1;
+}
+
+void decodeTrajectory(const CompressedTrajectory *trajectory, int first, int count, float samples[]) {
+    float block[TRAJECTORY_BLOCK];
+    for (int i = first; i < first + count; ) {
+        int blockNum = i / TRAJECTORY_BLOCK, offset = i % TRAJECTORY_BLOCK;
+        int taken = TRAJECTORY_BLOCK - offset < first + count - i ? TRAJECTORY_BLOCK - offset : first + count - i;
+
+        // Decode a full block, or copy from the samples of the last block.
+        if (blockNum < trajectory->blockCount) {
+            unpackBlock(trajectory, blockNum, block);
+            for (int j = 0; j < taken; ++j) {
+                samples[i - first + j] = block[offset + j];
+            }
+        }
+        else {
+            for (int j = 0; j < taken; ++j) {
+                samples[i - first + j] = trajectory->pending[offset + j] * (double) trajectory->quantum;
+            }
+        }
+        i += taken;
+    }
+}
+
+size_t trajectoryBytes(const CompressedTrajectory *trajectory) {
+    return trajectory->dataSize + trajectory->blockCount * sizeof(TrajectoryBlock) + TRAJECTORY_BLOCK * sizeof(int32_t);
+}
+
+Points findTrajectorySpikes(float x[], const CompressedTrajectory *trajectory, float transient, float threshold) {
+    Points spikes = {
+        .x = NULL,
+        .y = NULL,
+        .size = 0,
+        .capacity = 0
+    };
+
+    // Find the index of the transient value to start from.
+    int start = 0;
+    for (int i = 0; i < trajectory->size && !start; ++i) {
+        if (x[i] >= transient) {
+            start = i;
+        }
+    }
+
+    // Feed the samples to a detector a block at a time (a spike is the middle of the last three samples).
+    SpikeDetector detector = initSpikeDetector(1, threshold);
+    if (detector.prev == NULL) {
+        spikes.size = -1;
+        return spikes;
+    }
+    float block[TRAJECTORY_BLOCK];
+    for (int i = start, count; i < trajectory->size; i += count) {
+        count = TRAJECTORY_BLOCK - i % TRAJECTORY_BLOCK;
+        count = trajectory->size - i < count ? trajectory->size - i : count;
+        decodeTrajectory(trajectory, i, count, block);
+        for (int j = 0; j < count; ++j) {
+            if (detectSpike(&detector, 0, block[j]) && !appendPoint(&spikes, x[i + j - 1 - start], detector.prev[0])) {
+                freeSpikeDetector(&detector);
+                freePoints(&spikes);
+                spikes.x = spikes.y = NULL;
+                spikes.size = -1;
+                return spikes;
+            }
+        }
+    }
+    freeSpikeDetector(&detector);
+
+    return spikes;
+}
+
+int writeTrajectory(char *filename, float x[], const CompressedTrajectory *trajectory, float transient) {
+    // Find the point to start printing from.
+    int start = trajectory->size;
+    for (int i = 0; i < trajectory->size && start == trajectory->size; ++i) {
+        if (x[i] >= transient) {
+            start = i;
+        }
+    }
+
+    // Open output file for writing.
+    FILE *outfile;
+    if ((outfile = fopen(filename, "w")) == NULL) {
+        return 0;
+    }
+
+    // Begin writing a block at a time (the first may be partial, so the rest line up with the stored blocks).
+    float block[TRAJECTORY_BLOCK];
+    for (int i = 0, j = start; j < trajectory->size; ) {
+        int count = TRAJECTORY_BLOCK - j % TRAJECTORY_BLOCK;
+        count = trajectory->size - j < count ? trajectory->size - j : count;
+        decodeTrajectory(trajectory, j, count, block);
+        for (int k = 0; k < count; ++k, ++i, ++j) {
+            fprintf(outfile, "%f\t%f\n", x[i], block[k]);
+        }
+    }
+
+    // Close ouput file.
+    return fclose(outfile) == 0;
+}
+
+void freeTrajectory(CompressedTrajectory *trajectory) {
+    // Free the block, data, and last block arrays.
+    free(trajectory->blocks);
+    free(trajectory->data);
+    free(trajectory->pending);
+}
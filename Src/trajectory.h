@@ -0,0 +1,143 @@
+/**
+ * @file trajectory.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that stores the samples of a function compressed in blocks of fixed-point residuals,
+ * decoding them a block at a time for the writers and the spike finder.
+ * @version 0.1
+ * @date 2022-10-18
+ *
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef TRAJECTORY
+#define TRAJECTORY
+
+#include "spike_calculations.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TRAJECTORY_BLOCK 64     // The number of samples in each block.
+
+/**
+ * @brief A block structure which locates the packed residuals of one block of samples.
+ */
+typedef struct {
+    /**
+     * @brief The first sample of the block in quanta.
+     */
+    int32_t first;
+
+    /**
+     * @brief The byte offset of the packed residuals within the data array.
+     */
+    uint32_t offset;
+
+    /**
+     * @brief The number of bits of each zigzag encoded residual (0 when the samples of the block change at a constant rate).
+     */
+    uint8_t width;
+} TrajectoryBlock;
+
+/**
+ * @brief A trajectory structure which holds the samples of one function, rounded to multiples of a quantum. Each full
+ * block keeps its first sample, then packs how far each following sample lies from the line through the previous two
+ * (the first difference for the second sample) at the width of the largest, so a smooth function takes a few bits per
+ * sample. The samples of the last block stay unpacked until it fills.
+ */
+typedef struct {
+    /**
+     * @brief The distance between representable values (the largest error of a sample is half of it).
+     */
+    float quantum;
+
+    /**
+     * @brief The number of samples appended.
+     */
+    int size;
+
+    /**
+     * @brief The full blocks.
+     */
+    TrajectoryBlock *blocks;
+    int blockCount, blockCapacity;
+
+    /**
+     * @brief The packed residuals of the full blocks.
+     */
+    uint8_t *data;
+    size_t dataSize, dataCapacity;
+
+    /**
+     * @brief The samples of the last block in quanta (size % TRAJECTORY_BLOCK of them).
+     */
+    int32_t *pending;
+} CompressedTrajectory;
+
+/**
+ * @brief Initializes and allocates memory for a trajectory structure.
+ *
+ * @param quantum the distance between representable values.
+ * @param capacity the number of samples expected (the trajectory grows past it if needed).
+ * @return CompressedTrajectory - the initialized trajectory structure (NULL arrays if memory could not be allocated).
+ */
+CompressedTrajectory initTrajectory(float quantum, int capacity);
+
+/**
+ * @brief Appends a sample, packing the last block once it fills. Values beyond 2^28 quanta (and NaN) saturate.
+ *
+ * @param trajectory the trajectory.
+ * @param value the sample.
+ * @return int - 1 if the sample was appended, otherwise 0 (memory could not be allocated).
+ */
+int appendSample(CompressedTrajectory *trajectory, float value);
+
+/**
+ * @brief Decodes consecutive samples.
+ *
+ * @param trajectory the trajectory.
+ * @param first the number of the first sample.
+ * @param count the number of samples.
+ * @param samples where to store the samples.
+ */
+void decodeTrajectory(const CompressedTrajectory *trajectory, int first, int count, float samples[]);
+
+/**
+ * @brief Gets the memory taken by the samples of a trajectory.
+ *
+ * @param trajectory the trajectory.
+ * @return size_t - the number of bytes.
+ */
+size_t trajectoryBytes(const CompressedTrajectory *trajectory);
+
+/**
+ * @brief Finds the spikes of a trajectory after the transient, decoding it a block at a time (same rule and x shift
+ * as findSpikes()).
+ *
+ * @param x the x value of each sample.
+ * @param trajectory the trajectory.
+ * @param transient the x position to start from.
+ * @param threshold the minimum value a spike must reach.
+ * @return Points - the spikes found (size -1 if memory could not be allocated).
+ */
+Points findTrajectorySpikes(float x[], const CompressedTrajectory *trajectory, float transient, float threshold);
+
+/**
+ * @brief Writes a trajectory to a file after the transient, decoding it a block at a time (same format as writeSolution()).
+ *
+ * @param filename the name of the file to write to.
+ * @param x the x value of each sample.
+ * @param trajectory the trajectory.
+ * @param transient the x position to start printing from.
+ * @return int - 1 if the file was written, otherwise 0.
+ */
+int writeTrajectory(char *filename, float x[], const CompressedTrajectory *trajectory, float transient);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a trajectory structure.
+ *
+ * @param trajectory the trajectory to be freed.
+ */
+void freeTrajectory(CompressedTrajectory *trajectory);
+
+#endif
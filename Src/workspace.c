@@ -0,0 +1,66 @@
+/**
+ * @file workspace.c
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief This file implements the workspace header file.
+ * @version 0.1
+ * @date 2022-09-27
+ * 
+ * @copyright Copyright (c) 2022
+ */
+
+#include "workspace.h"
+
+#include <stdlib.h>
+
+Workspace initWorkspace() {
+    Workspace workspace = {
+        .memory = NULL,
+        .capacity = 0,
+        .used = 0
+    };
+
+    return workspace;
+}
+
+size_t alignWorkspaceBytes(size_t bytes) {
+    return (bytes + WORKSPACE_ALIGNMENT - 1) / WORKSPACE_ALIGNMENT * WORKSPACE_ALIGNMENT;
+}
+
+int reserveWorkspace(Workspace *workspace, size_t bytes) {
+    bytes = alignWorkspaceBytes(bytes);
+
+    // Only grow the memory (the old contents are not kept).
+    if (bytes > workspace->capacity) {
+        free(workspace->memory);
+        if ((workspace->memory = (char *) aligned_alloc(WORKSPACE_ALIGNMENT, bytes)) == NULL) {
+            workspace->capacity = 0;
+            workspace->used = 0;
+            return 0;
+        }
+        workspace->capacity = bytes;
+    }
+
+    workspace->used = 0;
+    return 1;
+}
+
+void *takeWorkspace(Workspace *workspace, size_t bytes) {
+    bytes = alignWorkspaceBytes(bytes);
+
+    // Verify the block was reserved.
+    if (workspace->used + bytes > workspace->capacity) {
+        return NULL;
+    }
+
+    void *block = workspace->memory + workspace->used;
+    workspace->used += bytes;
+    return block;
+}
+
+void freeWorkspace(Workspace *workspace) {
+    // Free the memory and forget its size.
+    free(workspace->memory);
+    workspace->memory = NULL;
+    workspace->capacity = 0;
+    workspace->used = 0;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ * @file workspace.h
+ * @author Alex Smith (alsmi14@ilstu.edu)
+ * @brief Header file for a program that manages reusable scratch memory for the numerical methods.
+ * @version 0.1
+ * @date 2022-09-27
+ * 
+ * @copyright Copyright (c) 2022
+ */
+
+#ifndef WORKSPACE
+#define WORKSPACE
+
+#include <stddef.h>
+
+#define WORKSPACE_ALIGNMENT 64  // The alignment (in bytes) of every block taken from a workspace.
+
+/**
+ * @brief A workspace structure which hands out aligned blocks of one heap allocation. The allocation only grows, 
+ * so a workspace reused across runs of the same size never allocates again.
+ */
+typedef struct {
+    /**
+     * @brief The aligned heap memory.
+     */
+    char *memory;
+
+    /**
+     * @brief The size of the memory in bytes.
+     */
+    size_t capacity;
+
+    /**
+     * @brief The number of bytes handed out since the last reserve.
+     */
+    size_t used;
+} Workspace;
+
+/**
+ * @brief Initializes an empty workspace structure (no memory is allocated until reserved).
+ * 
+ * @return Workspace - the initialized workspace structure.
+ */
+Workspace initWorkspace();
+
+/**
+ * @brief Rounds a block size up to the workspace alignment.
+ * 
+ * @param bytes the size of the block.
+ * @return size_t - the number of workspace bytes the block occupies.
+ */
+size_t alignWorkspaceBytes(size_t bytes);
+
+/**
+ * @brief Ensures the workspace holds at least the given number of bytes and releases every block taken from it.
+ * 
+ * @param workspace the workspace.
+ * @param bytes the total size of the blocks that will be taken (each rounded by alignWorkspaceBytes()).
+ * @return int - 1 if the memory is reserved, otherwise 0 (it could not be allocated and the workspace is empty).
+ */
+int reserveWorkspace(Workspace *workspace, size_t bytes);
+
+/**
+ * @brief Takes an aligned block from the reserved workspace memory.
+ * 
+ * @param workspace the workspace.
+ * @param bytes the size of the block.
+ * @return void* - the aligned block (NULL if it was not reserved).
+ */
+void *takeWorkspace(Workspace *workspace, size_t bytes);
+
+/**
+ * @brief Frees the dynamic/heap memory allocated to a workspace structure.
+ * 
+ * @param workspace the workspace to be freed.
+ */
+void freeWorkspace(Workspace *workspace);
+
+#endif
\ No newline at end of file